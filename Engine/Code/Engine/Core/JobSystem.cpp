@@ -2,20 +2,448 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Time.hpp"
 #include <string>
 #include <iostream>
+#include <chrono>
+#include <new>
+#include "Game/EngineBuildPreferences.hpp"
+#if defined( _WIN32 )
 #include <Windows.h>
+#else
+#include <stdint.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+//The Win32 fiber calls the job system uses, built on ucontext
+#define WINAPI
+struct PosixFiber
+{
+	ucontext_t m_context;
+	void* m_stackMemory = nullptr;//starts with a guard page, null for a converted thread
+	size_t m_stackMemorySize = 0;
+	void (*m_startFunction)(void*) = nullptr;
+	void* m_parameter = nullptr;
+};
+
+//Fiber running on the calling thread, set by SwitchToFiber before it switches
+static thread_local PosixFiber* t_currentPosixFiber = nullptr;
+
+//makecontext only passes int arguments, so the fiber pointer comes in two halves
+static void PosixFiberStart(unsigned int fiberLow, unsigned int fiberHigh)
+{
+	PosixFiber* fiber = (PosixFiber*)(uintptr_t)(((uint64_t)fiberHigh << 32) | (uint64_t)fiberLow);
+	fiber->m_startFunction(fiber->m_parameter);
+}
+
+static void* ConvertThreadToFiber(void*)
+{
+	//its context is filled in by the first switch away from it
+	t_currentPosixFiber = new PosixFiber();
+	return t_currentPosixFiber;
+}
+
+static int ConvertFiberToThread()
+{
+	delete t_currentPosixFiber;
+	t_currentPosixFiber = nullptr;
+	return 1;
+}
+
+static void* CreateFiber(size_t stackSize, void (*startFunction)(void*), void* parameter)
+{
+	size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	size_t stackMemorySize = pageSize + (stackSize + pageSize - 1) / pageSize * pageSize;
+	void* stackMemory = mmap(nullptr, stackMemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (stackMemory == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	//an overflow faults on the guard page instead of running into whatever is mapped below
+	mprotect(stackMemory, pageSize, PROT_NONE);
+
+	PosixFiber* fiber = new PosixFiber();
+	fiber->m_stackMemory = stackMemory;
+	fiber->m_stackMemorySize = stackMemorySize;
+	fiber->m_startFunction = startFunction;
+	fiber->m_parameter = parameter;
+	getcontext(&fiber->m_context);
+	fiber->m_context.uc_stack.ss_sp = (char*)stackMemory + pageSize;
+	fiber->m_context.uc_stack.ss_size = stackMemorySize - pageSize;
+	fiber->m_context.uc_link = nullptr;//fiber functions never return
+	uint64_t fiberBits = (uint64_t)(uintptr_t)fiber;
+	makecontext(&fiber->m_context, (void (*)())&PosixFiberStart, 2, (unsigned int)(fiberBits & 0xffffffffu), (unsigned int)(fiberBits >> 32));
+	return fiber;
+}
+
+static void DeleteFiber(void* fiberHandle)
+{
+	PosixFiber* fiber = (PosixFiber*)fiberHandle;
+	munmap(fiber->m_stackMemory, fiber->m_stackMemorySize);
+	delete fiber;
+}
+
+static void SwitchToFiber(void* fiberHandle)
+{
+	PosixFiber* fromFiber = t_currentPosixFiber;
+	t_currentPosixFiber = (PosixFiber*)fiberHandle;
+	swapcontext(&fromFiber->m_context, &t_currentPosixFiber->m_context);
+	//may return on another thread, so nothing thread local is touched past this point
+}
+#endif
+
+//Worker the calling thread belongs to, null on threads outside of any job system
+static thread_local JobSystemWorkerThread* t_currentWorker = nullptr;
+//Steal victim picker for threads that help out without being a worker, e.g. the main thread in ParallelFor
+static thread_local unsigned int t_helperRandomState = 0x9e3779b9u;
+//Lane of the job the calling thread is executing, NUM_JOB_PRIORITIES while not inside a job
+static thread_local int t_currentJobLane = NUM_JOB_PRIORITIES;
+
+//Posts left before the calling thread times the wait of another job in each lane, see JobLaneStats
+static thread_local int t_postsUntilWaitSample[NUM_JOB_PRIORITIES] = {};
+
+//Id of the job the calling thread is executing, only used to close trace spans around a fiber wait
+static thread_local int t_currentJobID = 0;
+
+static std::atomic<int> s_nextJobID(1);
+//Ids are taken from s_nextJobID in ranges, so constructing a job does not touch a counter every thread shares
+static constexpr int JOB_IDS_PER_RANGE = 256;
+static thread_local int t_nextJobID = 0;
+static thread_local int t_jobIDRangeEnd = 0;
+
+static bool IsHandleCurrent(JobHandle const& handle)
+{
+	return handle.m_slot != nullptr && handle.m_slot->m_generation.load(std::memory_order_acquire) == handle.m_generation;
+}
+
+static void LockDependents(JobSlot* slot)
+{
+	while (slot->m_dependentsLock.test_and_set(std::memory_order_acquire))
+	{
+		std::this_thread::yield();
+	}
+}
+
+static void UnlockDependents(JobSlot* slot)
+{
+	slot->m_dependentsLock.clear(std::memory_order_release);
+}
+
+#if !defined( ENGINE_DISABLE_JOB_TRACE )
+enum eJobTraceEventType : unsigned char
+{
+	JOB_TRACE_BEGIN,
+	JOB_TRACE_END,
+	JOB_TRACE_STEAL,
+	JOB_TRACE_PARK,
+	JOB_TRACE_WAKE,
+};
+
+struct JobTraceEvent
+{
+	double m_timeSeconds = 0.0;
+	int m_jobID = 0;
+	int m_detail = 0;//lane for begin, victim worker for steal
+	eJobTraceEventType m_type = JOB_TRACE_BEGIN;
+};
+
+//Seqlock slot, DumpTrace copies it while the owner may be overwriting it. m_sequence is the number of the
+//event held plus one, 0 while a write is in progress, so a reader that sees it change drops the copy.
+struct JobTraceSlot
+{
+	std::atomic<unsigned int> m_sequence{ 0 };
+	std::atomic<double> m_timeSeconds{ 0.0 };
+	std::atomic<int> m_jobID{ 0 };
+	std::atomic<int> m_detail{ 0 };
+	std::atomic<eJobTraceEventType> m_type{ JOB_TRACE_BEGIN };
+};
+
+//Written only by its own thread. Never freed, so a dump after the workers have stopped still sees their events.
+struct JobTraceBuffer
+{
+	static constexpr unsigned int CAPACITY = 16384;//must be power of two
+	JobTraceSlot m_slots[CAPACITY];
+	std::atomic<unsigned int> m_numRecorded{ 0 };
+	int m_traceThreadID = 0;
+	std::string m_threadName;
+};
+
+static std::mutex s_traceBuffersMutex;
+static std::vector<JobTraceBuffer*> s_traceBuffers;
+static thread_local JobTraceBuffer* t_traceBuffer = nullptr;
+
+static JobTraceBuffer* GetThreadTraceBuffer()
+{
+	if (t_traceBuffer == nullptr)
+	{
+		t_traceBuffer = new JobTraceBuffer();
+		s_traceBuffersMutex.lock();
+		t_traceBuffer->m_traceThreadID = (int)s_traceBuffers.size();
+		t_traceBuffer->m_threadName = "Thread " + std::to_string(t_traceBuffer->m_traceThreadID);
+		s_traceBuffers.push_back(t_traceBuffer);
+		s_traceBuffersMutex.unlock();
+	}
+	return t_traceBuffer;
+}
+
+static void RecordTraceEvent(eJobTraceEventType type, int jobID, int detail)
+{
+	JobTraceBuffer* buffer = GetThreadTraceBuffer();
+	unsigned int index = buffer->m_numRecorded.load(std::memory_order_relaxed);
+	JobTraceSlot& slot = buffer->m_slots[index & (JobTraceBuffer::CAPACITY - 1)];
+	slot.m_sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.m_timeSeconds.store(GetCurrentTimeSeconds(), std::memory_order_relaxed);
+	slot.m_jobID.store(jobID, std::memory_order_relaxed);
+	slot.m_detail.store(detail, std::memory_order_relaxed);
+	slot.m_type.store(type, std::memory_order_relaxed);
+	slot.m_sequence.store(index + 1, std::memory_order_release);
+	buffer->m_numRecorded.store(index + 1, std::memory_order_release);
+}
+
+//False if the slot no longer holds event number index, the owner has wrapped around onto it
+static bool ReadTraceEvent(JobTraceBuffer const* buffer, unsigned int index, JobTraceEvent& outEvent)
+{
+	JobTraceSlot const& slot = buffer->m_slots[index & (JobTraceBuffer::CAPACITY - 1)];
+	if (slot.m_sequence.load(std::memory_order_acquire) != index + 1)
+	{
+		return false;
+	}
+	outEvent.m_timeSeconds = slot.m_timeSeconds.load(std::memory_order_relaxed);
+	outEvent.m_jobID = slot.m_jobID.load(std::memory_order_relaxed);
+	outEvent.m_detail = slot.m_detail.load(std::memory_order_relaxed);
+	outEvent.m_type = slot.m_type.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.m_sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+#define JOB_TRACE(system, type, jobID, detail) do { if ((system)->m_isTracing.load(std::memory_order_relaxed)) { RecordTraceEvent(type, jobID, detail); } } while (0)
+#else
+#define JOB_TRACE(system, type, jobID, detail) do {} while (0)
+#endif
+
+//In front of every allocation. Slab blocks point at their own slot, heap allocations at the slot of a block
+//they hold on to until they are freed, so a slot stays readable through any handle.
+struct alignas(16) JobBlockHeader
+{
+	JobSlot m_slot;
+	JobSlot* m_jobSlot = nullptr;
+};
+static constexpr size_t JOB_HEADER_SIZE = sizeof(JobBlockHeader);
+static_assert(JobAllocator::BLOCK_SIZE > JOB_HEADER_SIZE, "JobAllocator::BLOCK_SIZE has no room left for a job");
+
+static JobBlockHeader* GetBlockHeader(void* block)
+{
+	return reinterpret_cast<JobBlockHeader*>(static_cast<char*>(block) - JOB_HEADER_SIZE);
+}
+
+//Blocks handed out by JobAllocator, the link overlaps the job that used to live there
+struct JobFreeBlock
+{
+	JobFreeBlock* m_next = nullptr;
+};
+
+struct JobBlockBatch
+{
+	JobFreeBlock* m_head = nullptr;
+	int m_count = 0;
+};
+
+struct JobFreeList
+{
+	JobFreeBlock* m_head = nullptr;
+	int m_count = 0;
+	~JobFreeList();
+};
+
+static std::mutex s_sharedJobBlocksMutex;
+static std::vector<JobBlockBatch> s_sharedJobBlocks;
+static thread_local JobFreeList t_jobFreeList;
+
+JobFreeList::~JobFreeList()
+{
+	//thread is exiting, hand what is left to the other threads
+	if (m_head != nullptr)
+	{
+		JobBlockBatch batch;
+		batch.m_head = m_head;
+		batch.m_count = m_count;
+		s_sharedJobBlocksMutex.lock();
+		s_sharedJobBlocks.push_back(batch);
+		s_sharedJobBlocksMutex.unlock();
+		m_head = nullptr;
+		m_count = 0;
+	}
+}
+
+void* JobAllocator::Allocate(size_t size)
+{
+	JobFreeList& freeList = t_jobFreeList;
+	if (freeList.m_head == nullptr)
+	{
+		s_sharedJobBlocksMutex.lock();
+		if (!s_sharedJobBlocks.empty())
+		{
+			freeList.m_head = s_sharedJobBlocks.back().m_head;
+			freeList.m_count = s_sharedJobBlocks.back().m_count;
+			s_sharedJobBlocks.pop_back();
+		}
+		s_sharedJobBlocksMutex.unlock();
+	}
+	if (freeList.m_head == nullptr)
+	{
+		//slabs live for the rest of the process, their blocks just move between free lists
+		char* slab = static_cast<char*>(::operator new(BLOCK_SIZE * BLOCKS_PER_BATCH));
+		for (int blockIndex = 0; blockIndex < BLOCKS_PER_BATCH; ++blockIndex)
+		{
+			JobBlockHeader* header = new(slab + blockIndex * BLOCK_SIZE) JobBlockHeader();
+			header->m_jobSlot = &header->m_slot;
+			JobFreeBlock* block = reinterpret_cast<JobFreeBlock*>(slab + blockIndex * BLOCK_SIZE + JOB_HEADER_SIZE);
+			block->m_next = freeList.m_head;
+			freeList.m_head = block;
+		}
+		freeList.m_count = BLOCKS_PER_BATCH;
+	}
+	JobFreeBlock* block = freeList.m_head;
+	freeList.m_head = block->m_next;
+	--freeList.m_count;
+	if (size > BLOCK_SIZE - JOB_HEADER_SIZE)
+	{
+		//the block only lends its slot to the job, which goes to the heap
+		JobBlockHeader* heapHeader = new(::operator new(JOB_HEADER_SIZE + size)) JobBlockHeader();
+		heapHeader->m_jobSlot = GetBlockHeader(block)->m_jobSlot;
+		return reinterpret_cast<char*>(heapHeader) + JOB_HEADER_SIZE;
+	}
+	return block;
+}
+
+void JobAllocator::Free(void* block, size_t size)
+{
+	JobSlot* slot = GetSlot(block);
+	//handles to the job read as invalid from here on
+	slot->m_generation.store(slot->m_generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	if (size > BLOCK_SIZE - JOB_HEADER_SIZE)
+	{
+		::operator delete(GetBlockHeader(block));
+		block = reinterpret_cast<char*>(slot) + JOB_HEADER_SIZE;//the slot is the start of the lending block
+	}
+	JobFreeList& freeList = t_jobFreeList;
+	JobFreeBlock* freeBlock = static_cast<JobFreeBlock*>(block);
+	freeBlock->m_next = freeList.m_head;
+	freeList.m_head = freeBlock;
+	++freeList.m_count;
+
+	//the main thread frees what workers allocate, so pass surplus batches back instead of hoarding them
+	if (freeList.m_count >= BLOCKS_PER_BATCH * 2)
+	{
+		JobBlockBatch batch;
+		batch.m_head = freeList.m_head;
+		batch.m_count = BLOCKS_PER_BATCH;
+		JobFreeBlock* lastBlock = freeList.m_head;
+		for (int blockIndex = 1; blockIndex < BLOCKS_PER_BATCH; ++blockIndex)
+		{
+			lastBlock = lastBlock->m_next;
+		}
+		freeList.m_head = lastBlock->m_next;
+		freeList.m_count -= BLOCKS_PER_BATCH;
+		lastBlock->m_next = nullptr;
+
+		s_sharedJobBlocksMutex.lock();
+		s_sharedJobBlocks.push_back(batch);
+		s_sharedJobBlocksMutex.unlock();
+	}
+}
+
+JobSlot* JobAllocator::GetSlot(void* block)
+{
+	return GetBlockHeader(block)->m_jobSlot;
+}
+
 Job::Job()
 {
-	static int s_nextJobID = 1;
-	m_jobID = s_nextJobID++;
+	if (t_nextJobID == t_jobIDRangeEnd)
+	{
+		t_nextJobID = s_nextJobID.fetch_add(JOB_IDS_PER_RANGE, std::memory_order_relaxed);
+		t_jobIDRangeEnd = t_nextJobID + JOB_IDS_PER_RANGE;
+	}
+	m_jobID = t_nextJobID++;
 }
 
+void Job::AddPrerequisite(JobHandle const& prerequisite)
+{
+	//a stale handle means the prerequisite was claimed, so it already executed
+	if (!IsHandleCurrent(prerequisite))
+	{
+		return;
+	}
+	JobSlot* slot = prerequisite.m_slot;
+	LockDependents(slot);
+	//it cannot get past ReleaseDependents while the lock is held, so a job that has not executed yet stays alive.
+	//Checked again under the lock, it may have been claimed and its slot reused since the first check.
+	if (!slot->m_hasExecuted.load(std::memory_order_acquire) && IsHandleCurrent(prerequisite))
+	{
+		m_numPendingPrerequisites.fetch_add(1);
+		prerequisite.m_job->m_dependents.push_back(this);
+	}
+	UnlockDependents(slot);
+}
+
+bool JobCounter::IsZero() const
+{
+	if (m_value.load() > 0)
+	{
+		return false;
+	}
+	//the last Decrement releases the lock after its store, so a caller that got past this can free the counter
+	Lock();
+	bool isZero = m_value.load() <= 0;
+	Unlock();
+	return isZero;
+}
+
+JobFiber* JobCounter::Decrement()
+{
+	JobFiber* fibersToResume = nullptr;
+	Lock();
+	if (m_value.fetch_sub(1) == 1)
+	{
+		fibersToResume = m_waitingFibers;
+		m_waitingFibers = nullptr;
+	}
+	Unlock();
+	return fibersToResume;
+}
+
+bool JobCounter::AddWaitingFiber(JobFiber* fiber) const
+{
+	Lock();
+	bool isWaiting = m_value.load() > 0;
+	if (isWaiting)
+	{
+		fiber->m_nextInList = m_waitingFibers;
+		m_waitingFibers = fiber;
+	}
+	Unlock();
+	return isWaiting;
+}
+
+void JobCounter::Lock() const
+{
+	while (m_lock.test_and_set(std::memory_order_acquire))
+	{
+		std::this_thread::yield();
+	}
+}
+
+void JobCounter::Unlock() const
+{
+	m_lock.clear(std::memory_order_release);
+}
 
 void ExampleJob::Execute()
 {
 	g_theConsole->PrintString(Rgba8::WHITE, "Job " + std::to_string(m_jobID) + " start execution.");
-	Sleep(5000);
+	std::this_thread::sleep_for(std::chrono::seconds(5));
 }
 
 void ExampleJob::OnCompleteCallBack()
@@ -23,57 +451,233 @@ void ExampleJob::OnCompleteCallBack()
 	g_theConsole->PrintString(Rgba8::WHITE, "Job " + std::to_string(m_jobID) + " completed.");
 }
 
+JobWorkStealingQueue::JobWorkStealingQueue()
+	: m_top(0)
+	, m_bottom(0)
+{
+	for (int i = 0; i < CAPACITY; ++i)
+	{
+		m_jobs[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+bool JobWorkStealingQueue::Push(Job* job)
+{
+	long long bottom = m_bottom.load(std::memory_order_relaxed);
+	long long top = m_top.load(std::memory_order_acquire);
+	if (bottom - top >= CAPACITY)
+	{
+		return false;
+	}
+	m_jobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+Job* JobWorkStealingQueue::Pop()
+{
+	long long bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long top = m_top.load(std::memory_order_relaxed);
+	if (top > bottom)
+	{
+		//queue was already empty
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	Job* job = m_jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		//last job, race against thieves for it
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* JobWorkStealingQueue::Steal()
+{
+	long long top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long bottom = m_bottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
+	Job* job = m_jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		//lost to the owner or another thief
+		return nullptr;
+	}
+	return job;
+}
+
+bool JobWorkStealingQueue::IsEmpty() const
+{
+	long long top = m_top.load(std::memory_order_acquire);
+	long long bottom = m_bottom.load(std::memory_order_acquire);
+	return top >= bottom;
+}
+
+static void WINAPI JobFiberMain(void* parameter)
+{
+	JobSystemWorkerThread::FiberMain((JobFiber*)parameter);
+}
+
 void JobSystemWorkerThread::WorkerThreadMain()
 {
+	t_currentWorker = this;
 	g_theConsole->PrintString(Rgba8::WHITE, "Thread " + std::to_string(m_threadID) + " start.");
+#if !defined( ENGINE_DISABLE_JOB_TRACE )
+	GetThreadTraceBuffer()->m_threadName = "Worker " + std::to_string(m_threadID);
+#endif
+	if (m_system->m_useFibers)
+	{
+		m_schedulerFiber = ConvertThreadToFiber(nullptr);
+	}
 	while (!m_system->m_isQuitting)
 	{
-		m_system->m_jobsQueuedMutex.lock();
-		if (!m_system->m_jobsQueued.empty())
+		if (m_schedulerFiber != nullptr)
 		{
-			Job* jobAtFrontOfQueue = m_system->m_jobsQueued.front();
-			m_system->m_jobsQueued.pop_front();
-			m_system->m_jobsQueuedMutex.unlock();
-			StartJob(jobAtFrontOfQueue);
-			jobAtFrontOfQueue->Execute(); // might take a while
-
-			Job* jobCompleted = m_system->PopJobFromRunningByIndex(jobAtFrontOfQueue->m_jobID);
-
-			m_system->m_jobsCompleteMutex.lock();//job completed
-			m_system->m_jobsCompleted.push_back(jobCompleted);
-			m_system->m_jobsCompleteMutex.unlock();
+			//finish started jobs before starting new ones, each suspended job holds a fiber
+			JobFiber* readyFiber = m_system->PopReadyFiber();
+			if (readyFiber != nullptr)
+			{
+				RunFiber(readyFiber);
+				continue;
+			}
+		}
+		Job* job = m_system->FindJobToRun(this);
+		if (job == nullptr)
+		{
+			//posts often come in bursts, a short spin saves the wake-up of parking between two of them.
+			//Only half the workers spin at once, the rest would just take time away from the threads posting.
+			int maxSpinningWorkers = std::max(1, m_system->m_numStealableWorkers.load() / 2);
+			if (m_system->m_numSpinningWorkers.fetch_add(1) < maxSpinningWorkers)
+			{
+				for (int spinIndex = 0; job == nullptr && spinIndex < JobSystem::IDLE_SPINS_BEFORE_PARKING && !m_system->m_isQuitting; ++spinIndex)
+				{
+					std::this_thread::yield();
+					job = m_system->FindJobToRun(this);
+				}
+			}
+			m_system->m_numSpinningWorkers.fetch_sub(1);
+			if (job == nullptr)
+			{
+				m_system->ParkWorker();
+				continue;
+			}
+			//posters skipped the wake-up while we were spinning, pass it on if there is more than we took
+			if (m_system->HasPendingWork())
+			{
+				m_system->WakeWorker();
+			}
+		}
+		JobFiber* fiber = (m_schedulerFiber != nullptr) ? m_system->AcquireFiber() : nullptr;
+		if (fiber != nullptr)
+		{
+			fiber->m_job = job;
+			RunFiber(fiber);
 		}
 		else
 		{
-			m_system->m_jobsQueuedMutex.unlock();
-			std::this_thread::sleep_for(std::chrono::microseconds(50));
+			m_system->ExecuteJob(job);
 		}
 	}
+	if (m_schedulerFiber != nullptr)
+	{
+		ConvertFiberToThread();
+		m_schedulerFiber = nullptr;
+	}
+	t_currentWorker = nullptr;
 	g_theConsole->PrintString(Rgba8::WHITE, "Thread " + std::to_string(m_threadID) + " exiting.");
 }
 
-void JobSystemWorkerThread::StartJob(Job* job)
+void JobSystemWorkerThread::RunFiber(JobFiber* fiber)
+{
+	m_runningFiber = fiber;
+	SwitchToFiber(fiber->m_fiberHandle);
+	//back on this thread's scheduler fiber, the job either finished or is waiting on a counter
+	m_runningFiber = nullptr;
+	JobCounter const* waitCounter = fiber->m_waitCounter;
+	if (waitCounter == nullptr)
+	{
+		m_system->ReleaseFiber(fiber);
+		return;
+	}
+	//only published now that nothing runs on its stack, so whoever resumes it cannot race this thread
+	fiber->m_waitCounter = nullptr;
+	if (!waitCounter->AddWaitingFiber(fiber))
+	{
+		m_system->PushReadyFiber(fiber);
+	}
+}
+
+void JobSystemWorkerThread::FiberMain(JobFiber* fiber)
+{
+	for (;;)
+	{
+		fiber->m_system->ExecuteJob(fiber->m_job);
+		fiber->m_job = nullptr;
+		//the job may have been resumed on another worker, so look the scheduler up again
+		SwitchToFiber(t_currentWorker->m_schedulerFiber);
+	}
+}
+
+unsigned int JobSystemWorkerThread::GetNextRandom()
 {
-	m_system->m_jobsRunningMutex.lock();
-	m_system->m_jobsRunning.push_back(job);
-	m_system->m_jobsRunningMutex.unlock();
+	//xorshift32, only used to pick steal victims
+	m_randomState ^= m_randomState << 13;
+	m_randomState ^= m_randomState >> 17;
+	m_randomState ^= m_randomState << 5;
+	return m_randomState;
 }
 
-void JobSystemWorkerThread::FinishJob(Job* job)
+JobSystem::JobSystem()
 {
-	m_system->m_jobsCompleteMutex.lock();
-	m_system->m_jobsCompleted.push_back(job);
-	m_system->m_jobsCompleteMutex.unlock();
+	for (int lane = 0; lane < NUM_JOB_PRIORITIES; ++lane)
+	{
+		m_injectedJobs[lane] = new InjectedJobQueue();
+	}
 }
 
 JobSystem::~JobSystem()
 {
 	ShutDown();
+	for (int lane = 0; lane < NUM_JOB_PRIORITIES; ++lane)
+	{
+		delete m_injectedJobs[lane];
+		m_injectedJobs[lane] = nullptr;
+	}
+}
+
+void JobSystem::EnableFibers(size_t fiberStackSizeBytes)
+{
+	if (!m_workerThreads.empty())
+	{
+		return;
+	}
+	m_useFibers = true;
+	m_fiberStackSize = fiberStackSizeBytes;
 }
 
 void JobSystem::CreateWorkerThread(int threadID)
 {
-	m_workerThreads.push_back(new JobSystemWorkerThread(threadID, this));
+	int workerIndex = m_numStealableWorkers.load();
+	if (workerIndex >= MAX_WORKER_THREADS)
+	{
+		return;
+	}
+	JobSystemWorkerThread* worker = new JobSystemWorkerThread(threadID, this);
+	m_workerThreads.push_back(worker);
+	m_stealableWorkers[workerIndex].store(worker);
+	m_numStealableWorkers.store(workerIndex + 1);
 }
 
 void JobSystem::CreateWorkerThreads(int numThread)
@@ -91,54 +695,198 @@ void JobSystem::StopWorkerThreads()
 		m_workerThreads[i]->m_threadObject->join();
 	}
 
+	m_numStealableWorkers.store(0);
 	for (int i = 0; i < m_workerThreads.size(); ++i)
 	{
+		//keep unclaimed jobs around for the next ClaimAndDeleteAllCompletedJobs
+		Job* completedJob = m_workerThreads[i]->m_completedJobs.exchange(nullptr);
+		while (completedJob != nullptr)
+		{
+			Job* nextJob = completedJob->m_nextInList;
+			PushCompletedJob(completedJob);
+			completedJob = nextJob;
+		}
+		m_stealableWorkers[i].store(nullptr);
 		delete m_workerThreads[i];
 	}
+	m_workerThreads.clear();
 }
 
-void JobSystem::PostJob(Job* job)
+JobHandle JobSystem::PostJob(Job* job)
 {
+	JobHandle handle;
 	if (m_isQuitting)
+	{
+		return handle;
+	}
+	//the slot sits in front of the most derived object, which is where the allocation starts
+	job->m_slot = JobAllocator::GetSlot(dynamic_cast<void*>(job));
+	job->m_slot->m_hasExecuted.store(false, std::memory_order_release);
+	job->m_slot->m_status.store(JOB_STATUS_WAITING, std::memory_order_release);
+	if (job->m_priority < 0 || job->m_priority >= NUM_JOB_PRIORITIES)
+	{
+		job->m_priority = JOB_PRIORITY_NORMAL;
+	}
+	handle.m_job = job;
+	handle.m_slot = job->m_slot;
+	handle.m_priority = job->m_priority;
+	handle.m_generation = job->m_slot->m_generation.load(std::memory_order_relaxed);
+	//drop the post reference, the last prerequisite to finish enqueues it otherwise.
+	//A count of 1 is only the post itself, nothing else can change it anymore, so the atomic decrement is skipped.
+	if (job->m_numPendingPrerequisites.load() == 1 || job->m_numPendingPrerequisites.fetch_sub(1) == 1)
+	{
+		EnqueueJob(job);
+	}
+	return handle;
+}
+
+JobHandle JobSystem::PostJob(Job* job, JobCounter* counter)
+{
+	if (m_isQuitting)
+	{
+		return JobHandle();
+	}
+	if (counter != nullptr)
+	{
+		counter->Increment();
+		job->m_counter = counter;
+		int lane = (job->m_priority >= 0 && job->m_priority < NUM_JOB_PRIORITIES) ? job->m_priority : JOB_PRIORITY_NORMAL;
+		int leastUrgentLane = counter->m_leastUrgentLane.load(std::memory_order_relaxed);
+		while (lane > leastUrgentLane && !counter->m_leastUrgentLane.compare_exchange_weak(leastUrgentLane, lane, std::memory_order_relaxed))
+		{
+		}
+	}
+	return PostJob(job);
+}
+
+void JobSystem::EnqueueJob(Job* job)
+{
+	int lane = job->m_priority;
+	if (t_postsUntilWaitSample[lane] == 0)
+	{
+		t_postsUntilWaitSample[lane] = WAIT_SAMPLE_INTERVAL - 1;
+		job->m_queuedTimeSeconds = GetCurrentTimeSeconds();
+	}
+	else
+	{
+		--t_postsUntilWaitSample[lane];
+		job->m_queuedTimeSeconds = -1.0;
+	}
+	job->m_slot->m_status.store(JOB_STATUS_QUEUED, std::memory_order_release);
+	m_laneCounters[lane].m_queueDepth.fetch_add(1);
+	JobSystemWorkerThread* worker = t_currentWorker;
+	if (worker == nullptr || worker->m_system != this || !worker->m_localJobs[lane].Push(job))
+	{
+		PushInjectedJob(job, lane);
+	}
+	WakeWorker();
+}
+
+void JobSystem::PushInjectedJob(Job* job, int lane)
+{
+	if (m_injectedJobs[lane]->try_push(job))
 	{
 		return;
 	}
-	m_jobsQueuedMutex.lock();
-	m_jobsQueued.push_back(job);
-	m_jobsQueuedMutex.unlock();
+	//a full ring only happens when far more is posted than the workers keep up with, jobs behind it may start first
+	job->m_nextInList = nullptr;
+	m_overflowJobsMutex.lock();
+	if (m_overflowJobsTail[lane] == nullptr)
+	{
+		m_overflowJobsHead[lane] = job;
+	}
+	else
+	{
+		m_overflowJobsTail[lane]->m_nextInList = job;
+	}
+	m_overflowJobsTail[lane] = job;
+	m_numOverflowJobs[lane].fetch_add(1);
+	m_overflowJobsMutex.unlock();
+}
+
+void JobSystem::CallBackAndDeleteCompletedJobs(Job* newestJob)
+{
+	//lists are built newest first, flip them so callbacks run in completion order
+	Job* oldestJob = nullptr;
+	while (newestJob != nullptr)
+	{
+		Job* nextJob = newestJob->m_nextInList;
+		newestJob->m_nextInList = oldestJob;
+		oldestJob = newestJob;
+		newestJob = nextJob;
+	}
+	while (oldestJob != nullptr)
+	{
+		Job* nextJob = oldestJob->m_nextInList;
+		oldestJob->OnCompleteCallBack();
+		delete oldestJob;
+		oldestJob = nextJob;
+	}
 }
 
 void JobSystem::ClaimAndDeleteAllCompletedJobs()
 {
-	std::deque<Job*> claimedJobs;
+	for (int i = 0; i < m_workerThreads.size(); ++i)
+	{
+		CallBackAndDeleteCompletedJobs(m_workerThreads[i]->m_completedJobs.exchange(nullptr));
+	}
+	CallBackAndDeleteCompletedJobs(m_jobsCompleted.exchange(nullptr));
+}
 
-	m_jobsCompleteMutex.lock();
-	m_jobsCompleted.swap(claimedJobs);
-	m_jobsCompleteMutex.unlock();
+eJobStatus JobSystem::GetStatus(JobHandle const& handle) const
+{
+	if (!IsHandleCurrent(handle))
+	{
+		return JOB_STATUS_INVALID;
+	}
+	eJobStatus status = handle.m_slot->m_status.load(std::memory_order_acquire);
+	//claimed in the meantime, the status may already be the one of a newer job in the slot
+	if (!IsHandleCurrent(handle))
+	{
+		return JOB_STATUS_INVALID;
+	}
+	return status;
+}
 
-	for (auto iter = claimedJobs.begin(); iter != claimedJobs.end(); ++iter)
+void JobSystem::WaitFor(JobHandle const& handle)
+{
+	while (GetStatus(handle) != JOB_STATUS_COMPLETED && GetStatus(handle) != JOB_STATUS_INVALID)
 	{
-		Job* job = *iter;
-		job->OnCompleteCallBack();
-		delete job;
+		if (!HelpWhileWaiting(handle.m_priority))
+		{
+			std::this_thread::yield();
+		}
 	}
 }
 
-Job* JobSystem::PopJobFromRunningByIndex(int id)
+void JobSystem::WaitFor(JobCounter const& counter)
 {
-	m_jobsRunningMutex.lock();
-	for (auto iter = m_jobsRunning.begin(); iter != m_jobsRunning.end(); ++iter)
+	if (counter.IsZero())
+	{
+		return;
+	}
+	JobSystemWorkerThread* worker = t_currentWorker;
+	if (worker != nullptr && worker->m_system == this && worker->m_runningFiber != nullptr)
+	{
+		JobFiber* fiber = worker->m_runningFiber;
+		int lane = t_currentJobLane;
+		int jobID = t_currentJobID;
+		JOB_TRACE(this, JOB_TRACE_END, jobID, lane);
+		fiber->m_waitCounter = &counter;
+		SwitchToFiber(worker->m_schedulerFiber);
+		//resumed by a worker that saw the counter reach zero, possibly not the one we left
+		t_currentJobLane = lane;
+		t_currentJobID = jobID;
+		JOB_TRACE(this, JOB_TRACE_BEGIN, jobID, lane);
+		return;
+	}
+	while (!counter.IsZero())
 	{
-		Job* job = *iter;
-		if (job->m_jobID == id)
+		if (!HelpWhileWaiting(counter.m_leastUrgentLane.load(std::memory_order_relaxed)))
 		{
-			m_jobsRunning.erase(iter);
-			m_jobsRunningMutex.unlock();
-			return job;
+			std::this_thread::yield();
 		}
 	}
-	m_jobsRunningMutex.unlock();
-	return nullptr;
 }
 
 void JobSystem::ShutDown()
@@ -148,5 +896,532 @@ void JobSystem::ShutDown()
 		return;
 	}
 	m_isQuitting = true;
+	m_idleMutex.lock();
+	m_idleCondition.notify_all();
+	m_idleMutex.unlock();
 	StopWorkerThreads();
-}
\ No newline at end of file
+	DeleteFibers();
+}
+
+Job* JobSystem::PopInjectedJob(int lane)
+{
+	Job* job = nullptr;
+	if (m_injectedJobs[lane]->try_pop(job))
+	{
+		return job;
+	}
+	if (m_numOverflowJobs[lane].load() == 0)
+	{
+		return nullptr;
+	}
+	m_overflowJobsMutex.lock();
+	job = m_overflowJobsHead[lane];
+	if (job != nullptr)
+	{
+		m_overflowJobsHead[lane] = job->m_nextInList;
+		if (m_overflowJobsHead[lane] == nullptr)
+		{
+			m_overflowJobsTail[lane] = nullptr;
+		}
+		m_numOverflowJobs[lane].fetch_sub(1);
+	}
+	m_overflowJobsMutex.unlock();
+	return job;
+}
+
+bool JobSystem::TryExecuteOneJob()
+{
+	JobSystemWorkerThread* worker = t_currentWorker;
+	if (worker != nullptr && worker->m_system != this)
+	{
+		worker = nullptr;
+	}
+	Job* job = FindJobToRun(worker);
+	if (job == nullptr)
+	{
+		return false;
+	}
+	ExecuteJob(job);
+	return true;
+}
+
+bool JobSystem::YieldToHigherPriorityJobs()
+{
+	int currentLane = t_currentJobLane;
+	if (currentLane == 0 || currentLane >= NUM_JOB_PRIORITIES)
+	{
+		return false;
+	}
+	JobSystemWorkerThread* worker = t_currentWorker;
+	if (worker != nullptr && worker->m_system != this)
+	{
+		worker = nullptr;
+	}
+	bool didRunJob = false;
+	Job* job = FindJobToRun(worker, currentLane);
+	while (job != nullptr)
+	{
+		ExecuteJob(job);
+		didRunJob = true;
+		job = FindJobToRun(worker, currentLane);
+	}
+	return didRunJob;
+}
+
+JobLaneStats JobSystem::GetLaneStats(eJobPriority priority) const
+{
+	JobLaneStats stats;
+	if (priority < 0 || priority >= NUM_JOB_PRIORITIES)
+	{
+		return stats;
+	}
+	LaneCounters const& counters = m_laneCounters[priority];
+	stats.m_queueDepth = counters.m_queueDepth.load();
+	stats.m_numJobsStarted = counters.m_numJobsStarted.load();
+	int numJobsTimed = counters.m_numJobsTimed.load();
+	if (numJobsTimed > 0)
+	{
+		stats.m_averageWaitSeconds = (double)counters.m_totalWaitMicroseconds.load() * 0.000001 / (double)numJobsTimed;
+	}
+	stats.m_maxWaitSeconds = (double)counters.m_maxWaitMicroseconds.load() * 0.000001;
+	return stats;
+}
+
+void JobSystem::ResetLaneStats()
+{
+	//queue depth is live state, not a statistic, so it is left alone
+	for (int lane = 0; lane < NUM_JOB_PRIORITIES; ++lane)
+	{
+		m_laneCounters[lane].m_numJobsStarted.store(0);
+		m_laneCounters[lane].m_numJobsTimed.store(0);
+		m_laneCounters[lane].m_totalWaitMicroseconds.store(0);
+		m_laneCounters[lane].m_maxWaitMicroseconds.store(0);
+	}
+}
+
+eJobPriority JobSystem::GetCallerPriority()
+{
+	//batches split off a job keep its lane, the main thread is always waiting on the frame
+	if (t_currentJobLane >= NUM_JOB_PRIORITIES)
+	{
+		return JOB_PRIORITY_FRAME_CRITICAL;
+	}
+	return (eJobPriority)t_currentJobLane;
+}
+
+bool JobSystem::HelpWhileWaiting(int awaitedLane)
+{
+	JobSystemWorkerThread* worker = t_currentWorker;
+	if (worker != nullptr && worker->m_system != this)
+	{
+		worker = nullptr;
+	}
+	//a less urgent job could run for a long time and make the caller miss its own deadline,
+	//unless there are no workers and nobody else would ever run it
+	int numLanes = std::max((int)GetCallerPriority(), awaitedLane) + 1;
+	if (m_numStealableWorkers.load() == 0)
+	{
+		numLanes = NUM_JOB_PRIORITIES;
+	}
+	Job* job = FindJobToRun(worker, numLanes);
+	if (job == nullptr)
+	{
+		return false;
+	}
+	ExecuteJob(job);
+	return true;
+}
+
+void JobSystem::WaitUntilZero(std::atomic<int> const& counter)
+{
+	//the batches were posted to the caller's lane
+	while (counter.load() > 0)
+	{
+		if (!HelpWhileWaiting(GetCallerPriority()))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+Job* JobSystem::FindJobToRun(JobSystemWorkerThread* worker, int numLanes)
+{
+	//a lane is searched everywhere before moving on, so a stealable frame job beats a local background one
+	for (int lane = 0; lane < numLanes; ++lane)
+	{
+		//the depth is raised before a job is pushed anywhere, so an empty lane is skipped without touching any queue
+		if (m_laneCounters[lane].m_queueDepth.load() <= 0)
+		{
+			continue;
+		}
+		Job* job = nullptr;
+		if (worker != nullptr && !worker->m_localJobs[lane].IsEmpty())
+		{
+			job = worker->m_localJobs[lane].Pop();
+		}
+		if (job == nullptr)
+		{
+			job = PopInjectedJob(lane);
+		}
+		if (job == nullptr)
+		{
+			job = StealJob(worker, lane);
+		}
+		if (job != nullptr)
+		{
+			m_laneCounters[lane].m_queueDepth.fetch_sub(1);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+Job* JobSystem::StealJob(JobSystemWorkerThread* thief, int lane)
+{
+	int numWorkers = m_numStealableWorkers.load();
+	if (numWorkers == 0 || (numWorkers == 1 && thief != nullptr))
+	{
+		return nullptr;
+	}
+	//start from a random victim so thieves spread out instead of all hitting worker 0
+	unsigned int randomValue = 0;
+	if (thief != nullptr)
+	{
+		randomValue = thief->GetNextRandom();
+	}
+	else
+	{
+		t_helperRandomState ^= t_helperRandomState << 13;
+		t_helperRandomState ^= t_helperRandomState >> 17;
+		t_helperRandomState ^= t_helperRandomState << 5;
+		randomValue = t_helperRandomState;
+	}
+	int startIndex = (int)(randomValue % (unsigned int)numWorkers);
+	for (int i = 0; i < numWorkers; ++i)
+	{
+		JobSystemWorkerThread* victim = m_stealableWorkers[(startIndex + i) % numWorkers].load();
+		if (victim == nullptr || victim == thief)
+		{
+			continue;
+		}
+		Job* job = victim->m_localJobs[lane].Steal();
+		if (job != nullptr)
+		{
+			JOB_TRACE(this, JOB_TRACE_STEAL, job->m_jobID, victim->m_threadID);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::ExecuteJob(Job* job)
+{
+	int lane = job->m_priority;
+	LaneCounters& counters = m_laneCounters[lane];
+	counters.m_numJobsStarted.fetch_add(1, std::memory_order_relaxed);
+	if (job->m_queuedTimeSeconds >= 0.0)
+	{
+		long long waitMicroseconds = (long long)((GetCurrentTimeSeconds() - job->m_queuedTimeSeconds) * 1000000.0);
+		counters.m_numJobsTimed.fetch_add(1, std::memory_order_relaxed);
+		counters.m_totalWaitMicroseconds.fetch_add(waitMicroseconds, std::memory_order_relaxed);
+		long long maxWaitMicroseconds = counters.m_maxWaitMicroseconds.load(std::memory_order_relaxed);
+		while (waitMicroseconds > maxWaitMicroseconds && !counters.m_maxWaitMicroseconds.compare_exchange_weak(maxWaitMicroseconds, waitMicroseconds, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	int outerLane = t_currentJobLane;
+	int outerJobID = t_currentJobID;
+	t_currentJobLane = lane;
+	t_currentJobID = job->m_jobID;
+	JOB_TRACE(this, JOB_TRACE_BEGIN, job->m_jobID, lane);
+	job->m_slot->m_status.store(JOB_STATUS_RUNNING, std::memory_order_release);
+	job->Execute(); // might take a while
+	JOB_TRACE(this, JOB_TRACE_END, t_currentJobID, lane);
+	t_currentJobLane = outerLane;
+	t_currentJobID = outerJobID;
+	ReleaseDependents(job);
+
+	//counters may belong to a waiting stack frame, so they have to be the last thing touched
+	JobCounter* counter = job->m_counter;
+	if (job->m_isDetached)
+	{
+		std::atomic<int>* completionCounter = job->m_completionCounter;
+		delete job;
+		if (completionCounter != nullptr)
+		{
+			completionCounter->fetch_sub(1);
+		}
+	}
+	else
+	{
+		//once it is on a completion list the main thread may delete it at any time
+		job->m_slot->m_status.store(JOB_STATUS_COMPLETED, std::memory_order_release);
+		PushCompletedJob(job);
+	}
+	if (counter != nullptr)
+	{
+		DecrementCounter(counter);
+	}
+}
+
+void JobSystem::DecrementCounter(JobCounter* counter)
+{
+	JobFiber* fiber = counter->Decrement();
+	while (fiber != nullptr)
+	{
+		JobFiber* nextFiber = fiber->m_nextInList;
+		PushReadyFiber(fiber);
+		fiber = nextFiber;
+	}
+}
+
+JobFiber* JobSystem::AcquireFiber()
+{
+	m_fiberMutex.lock();
+	JobFiber* fiber = m_freeFibers;
+	if (fiber != nullptr)
+	{
+		m_freeFibers = fiber->m_nextInList;
+	}
+	m_fiberMutex.unlock();
+	if (fiber != nullptr)
+	{
+		return fiber;
+	}
+
+	fiber = new JobFiber();
+	fiber->m_system = this;
+	fiber->m_fiberHandle = CreateFiber(m_fiberStackSize, &JobFiberMain, fiber);
+	if (fiber->m_fiberHandle == nullptr)
+	{
+		delete fiber;
+		return nullptr;
+	}
+	m_fiberMutex.lock();
+	m_allFibers.push_back(fiber);
+	m_fiberMutex.unlock();
+	return fiber;
+}
+
+void JobSystem::ReleaseFiber(JobFiber* fiber)
+{
+	m_fiberMutex.lock();
+	fiber->m_nextInList = m_freeFibers;
+	m_freeFibers = fiber;
+	m_fiberMutex.unlock();
+}
+
+void JobSystem::PushReadyFiber(JobFiber* fiber)
+{
+	fiber->m_nextInList = nullptr;
+	m_fiberMutex.lock();
+	if (m_readyFibersTail == nullptr)
+	{
+		m_readyFibersHead = fiber;
+	}
+	else
+	{
+		m_readyFibersTail->m_nextInList = fiber;
+	}
+	m_readyFibersTail = fiber;
+	m_fiberMutex.unlock();
+	//counts as pending work, so parked workers wake up for it
+	m_numReadyFibers.fetch_add(1);
+	WakeWorker();
+}
+
+JobFiber* JobSystem::PopReadyFiber()
+{
+	if (m_numReadyFibers.load() == 0)
+	{
+		return nullptr;
+	}
+	m_fiberMutex.lock();
+	JobFiber* fiber = m_readyFibersHead;
+	if (fiber != nullptr)
+	{
+		m_readyFibersHead = fiber->m_nextInList;
+		if (m_readyFibersHead == nullptr)
+		{
+			m_readyFibersTail = nullptr;
+		}
+	}
+	m_fiberMutex.unlock();
+	if (fiber != nullptr)
+	{
+		m_numReadyFibers.fetch_sub(1);
+	}
+	return fiber;
+}
+
+void JobSystem::DeleteFibers()
+{
+	//jobs still suspended at shut down never finish, their stacks go with the fibers
+	for (int i = 0; i < (int)m_allFibers.size(); ++i)
+	{
+		DeleteFiber(m_allFibers[i]->m_fiberHandle);
+		delete m_allFibers[i];
+	}
+	m_allFibers.clear();
+	m_freeFibers = nullptr;
+	m_readyFibersHead = nullptr;
+	m_readyFibersTail = nullptr;
+	m_numReadyFibers.store(0);
+}
+
+void JobSystem::PushCompletedJob(Job* job)
+{
+	JobSystemWorkerThread* worker = t_currentWorker;
+	std::atomic<Job*>& completedJobs = (worker != nullptr && worker->m_system == this) ? worker->m_completedJobs : m_jobsCompleted;
+	Job* head = completedJobs.load(std::memory_order_relaxed);
+	do
+	{
+		job->m_nextInList = head;
+	} while (!completedJobs.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void JobSystem::ReleaseDependents(Job* job)
+{
+	std::vector<Job*> dependents;
+	LockDependents(job->m_slot);
+	job->m_slot->m_hasExecuted.store(true, std::memory_order_release);
+	job->m_dependents.swap(dependents);
+	UnlockDependents(job->m_slot);
+
+	//runnable dependents go onto this worker's deque, no round trip through the main thread
+	for (int i = 0; i < dependents.size(); ++i)
+	{
+		if (dependents[i]->m_numPendingPrerequisites.fetch_sub(1) == 1)
+		{
+			EnqueueJob(dependents[i]);
+		}
+	}
+}
+
+bool JobSystem::HasPendingWork() const
+{
+	if (m_numReadyFibers.load() > 0)
+	{
+		return true;
+	}
+	for (int lane = 0; lane < NUM_JOB_PRIORITIES; ++lane)
+	{
+		if (m_laneCounters[lane].m_queueDepth.load() > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::WakeWorker()
+{
+	//a spinning worker finds the job on its own, and wakes the next one up if there is more
+	if (m_numSpinningWorkers.load() == 0 && m_numParkedWorkers.load() > 0)
+	{
+		//take the lock so the notify cannot slip in between a worker's check and its wait
+		m_idleMutex.lock();
+		m_idleCondition.notify_one();
+		m_idleMutex.unlock();
+	}
+}
+
+void JobSystem::ParkWorker()
+{
+	std::unique_lock<std::mutex> idleLock(m_idleMutex);
+	if (HasPendingWork() || m_isQuitting)
+	{
+		//jobs are counted before they are pushed, a poster that was interrupted in between needs the time more than we do
+		idleLock.unlock();
+		std::this_thread::yield();
+		return;
+	}
+	m_numParkedWorkers.fetch_add(1);
+	JOB_TRACE(this, JOB_TRACE_PARK, 0, 0);
+	m_idleCondition.wait(idleLock, [this]() { return HasPendingWork() || m_isQuitting; });
+	JOB_TRACE(this, JOB_TRACE_WAKE, 0, 0);
+	m_numParkedWorkers.fetch_sub(1);
+}
+
+void JobSystem::SetTraceEnabled(bool isEnabled)
+{
+#if defined( ENGINE_DISABLE_JOB_TRACE )
+	UNUSED(isEnabled);
+#else
+	m_isTracing.store(isEnabled);
+#endif
+}
+
+bool JobSystem::DumpTrace(std::string const& path) const
+{
+#if defined( ENGINE_DISABLE_JOB_TRACE )
+	UNUSED(path);
+	return false;
+#else
+	FILE* file = nullptr;
+#if defined( _WIN32 )
+	fopen_s(&file, path.c_str(), "wb");
+#else
+	file = fopen(path.c_str(), "wb");
+#endif
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	s_traceBuffersMutex.lock();
+	std::vector<JobTraceBuffer*> buffers = s_traceBuffers;
+	s_traceBuffersMutex.unlock();
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"JobSystem\"}}");
+	std::vector<JobTraceEvent> events;
+	for (int bufferIndex = 0; bufferIndex < (int)buffers.size(); ++bufferIndex)
+	{
+		JobTraceBuffer const* buffer = buffers[bufferIndex];
+		int tid = buffer->m_traceThreadID;
+		fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", tid, buffer->m_threadName.c_str());
+
+		//the owner keeps recording while we copy, anything it overwrites meanwhile is dropped slot by slot
+		unsigned int numRecorded = buffer->m_numRecorded.load(std::memory_order_acquire);
+		unsigned int firstIndex = (numRecorded > JobTraceBuffer::CAPACITY) ? numRecorded - JobTraceBuffer::CAPACITY : 0;
+		events.clear();
+		for (unsigned int index = firstIndex; index < numRecorded; ++index)
+		{
+			JobTraceEvent event;
+			if (ReadTraceEvent(buffer, index, event))
+			{
+				events.push_back(event);
+			}
+		}
+
+		for (int eventIndex = 0; eventIndex < (int)events.size(); ++eventIndex)
+		{
+			JobTraceEvent const& event = events[eventIndex];
+			double timeMicroseconds = event.m_timeSeconds * 1000000.0;
+			switch (event.m_type)
+			{
+			case JOB_TRACE_BEGIN:
+				fprintf(file, ",\n{\"name\":\"Job %d\",\"cat\":\"job\",\"ph\":\"B\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"args\":{\"lane\":%d}}", event.m_jobID, tid, timeMicroseconds, event.m_detail);
+				break;
+			case JOB_TRACE_END:
+				fprintf(file, ",\n{\"ph\":\"E\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}", tid, timeMicroseconds);
+				break;
+			case JOB_TRACE_STEAL:
+				fprintf(file, ",\n{\"name\":\"Steal\",\"cat\":\"steal\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"args\":{\"job\":%d,\"victimWorker\":%d}}", tid, timeMicroseconds, event.m_jobID, event.m_detail);
+				break;
+			case JOB_TRACE_PARK:
+				fprintf(file, ",\n{\"name\":\"Parked\",\"cat\":\"park\",\"ph\":\"B\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}", tid, timeMicroseconds);
+				break;
+			case JOB_TRACE_WAKE:
+				fprintf(file, ",\n{\"ph\":\"E\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}", tid, timeMicroseconds);
+				break;
+			}
+		}
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+#endif
+}
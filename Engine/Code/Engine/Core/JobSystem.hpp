@@ -1,18 +1,144 @@
 #pragma once
+#include "Engine/Core/MPMCRingQueue.hpp"
 #include <mutex>
 #include <atomic>
 #include <vector>
-#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <string>
 class JobSystem;
+class Job;
+
+enum eJobStatus
+{
+	JOB_STATUS_INVALID,		// handle does not refer to a job
+	JOB_STATUS_NEW,			// constructed but not posted yet
+	JOB_STATUS_WAITING,		// posted, waiting on prerequisites
+	JOB_STATUS_QUEUED,
+	JOB_STATUS_RUNNING,
+	JOB_STATUS_COMPLETED,	// executed, waiting to be claimed
+};
+
+//Workers always drain lower numbered lanes first
+enum eJobPriority
+{
+	JOB_PRIORITY_FRAME_CRITICAL,	// needed before the current frame can finish
+	JOB_PRIORITY_NORMAL,
+	JOB_PRIORITY_BACKGROUND,		// loading and IO, may call JobSystem::YieldToHigherPriorityJobs
+	NUM_JOB_PRIORITIES,
+};
+
+struct JobLaneStats
+{
+	int m_queueDepth = 0;				// jobs waiting in this lane right now
+	int m_numJobsStarted = 0;			// since the last ResetLaneStats
+	//Wait times run from being queued to starting execution. Reading the clock costs as much as the rest of a post,
+	//so only every JobSystem::WAIT_SAMPLE_INTERVAL'th job a thread posts to a lane is timed.
+	double m_averageWaitSeconds = 0.0;
+	double m_maxWaitSeconds = 0.0;
+};
+
+//Sits in front of a job's memory and is never freed, so a handle can be checked without touching the job.
+//m_generation goes up every time the job in the slot is freed.
+struct JobSlot
+{
+	std::atomic<unsigned int>	m_generation{ 0 };
+	std::atomic<eJobStatus>		m_status{ JOB_STATUS_NEW };
+	std::atomic<bool>			m_hasExecuted{ false };//dependents added after this are not waited for
+	std::atomic_flag			m_dependentsLock = ATOMIC_FLAG_INIT;
+};
+
+//Returned by PostJob, stays valid until the job is claimed by ClaimAndDeleteAllCompletedJobs.
+//Kept past that it reads as JOB_STATUS_INVALID, m_generation tells the job apart from a later one in the same slot.
+struct JobHandle
+{
+public:
+	Job* m_job = nullptr;
+	JobSlot* m_slot = nullptr;
+	unsigned int m_generation = 0;
+	eJobPriority m_priority = JOB_PRIORITY_NORMAL;//lane the job was posted to, a wait helps with it
+public:
+	bool IsValid() const { return m_job != nullptr; }
+};
+
+//Fixed-size blocks for Job objects. Each thread keeps its own free list and trades whole batches
+//with a shared pool, so posting and claiming jobs does not go through the heap.
+class JobAllocator
+{
+public:
+	static constexpr size_t BLOCK_SIZE = 256;//includes the slot, jobs that do not fit take their memory from the heap
+	static constexpr int BLOCKS_PER_BATCH = 64;
+
+	static void* Allocate(size_t size);
+	static void Free(void* block, size_t size);
+	//Works for heap allocated jobs too, they borrow the slot of a block
+	static JobSlot* GetSlot(void* block);
+};
+
+struct JobFiber;
+
+//Counts outstanding jobs posted with it, see JobSystem::WaitFor(JobCounter const&)
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(JobCounter const& copy) = delete;
+	JobCounter& operator=(JobCounter const& copy) = delete;
+
+	int GetValue() const { return m_value.load(); }
+	//Once this returns true the last job is done touching the counter, so it can be destroyed
+	bool IsZero() const;
+
+private:
+	void Increment() { m_value.fetch_add(1); }
+	JobFiber* Decrement();//returns the fibers to resume when the count reaches zero
+	bool AddWaitingFiber(JobFiber* fiber) const;//false if the count already reached zero
+	void Lock() const;
+	void Unlock() const;
+
+	std::atomic<int>		m_value{ 0 };
+	std::atomic<int>		m_leastUrgentLane{ JOB_PRIORITY_FRAME_CRITICAL };//of the jobs posted with it, a wait helps with it
+	mutable std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+	mutable JobFiber*		m_waitingFibers = nullptr;
+
+	friend class JobSystem;
+	friend class JobSystemWorkerThread;
+};
+
 class Job
 {
+	friend class JobSystem;
 public:
 	Job();
 	virtual ~Job() {}
+	static void* operator new(size_t size) { return JobAllocator::Allocate(size); }
+	static void operator delete(void* block, size_t size) { JobAllocator::Free(block, size); }
+
 	virtual void Execute() = 0;
 	virtual void OnCompleteCallBack() {};
 
+	//Call before posting this job, it will not run until the prerequisite has executed
+	void AddPrerequisite(JobHandle const& prerequisite);
+
+	eJobStatus GetStatus() const { return (m_slot != nullptr) ? m_slot->m_status.load(std::memory_order_acquire) : JOB_STATUS_NEW; }
+	void SetPriority(eJobPriority priority) { m_priority = priority; }
+	eJobPriority GetPriority() const { return m_priority; }
+
 	int m_jobID = 0;
+protected:
+	//detached jobs are deleted by the thread that ran them and never reach ClaimAndDeleteAllCompletedJobs
+	bool				m_isDetached = false;
+	std::atomic<int>*	m_completionCounter = nullptr;//decremented once a detached job is deleted
+	eJobPriority		m_priority = JOB_PRIORITY_NORMAL;
+private:
+	//starts at 1 for the post itself, so a job never runs before PostJob
+	std::atomic<int>	m_numPendingPrerequisites{ 1 };
+	std::vector<Job*>	m_dependents;//guarded by the slot's m_dependentsLock
+	JobSlot*			m_slot = nullptr;//set by PostJob
+	Job*				m_nextInList = nullptr;//intrusive link for the queued and completed lists
+	double				m_queuedTimeSeconds = -1.0;//negative when the wait of this job is not sampled
+	JobCounter*			m_counter = nullptr;
 };
 
 class ExampleJob : public Job
@@ -21,15 +147,79 @@ class ExampleJob : public Job
 	virtual void OnCompleteCallBack() override;
 };
 
+//Wraps a callable so it can be posted without writing a Job subclass, the callable is stored inline
+template<typename FUNC>
+class LambdaJob : public Job
+{
+public:
+	explicit LambdaJob(FUNC const& func)
+		: m_func(func)
+	{}
+	virtual void Execute() override { m_func(); }
+
+	FUNC m_func;
+};
+
+//One batch of a ParallelFor/ParallelReduce, calls func(batchBegin, batchEnd, batchIndex)
+template<typename BATCH_FUNC>
+class ParallelBatchJob : public Job
+{
+public:
+	ParallelBatchJob(BATCH_FUNC const* batchFunc, int batchBegin, int batchEnd, int batchIndex, std::atomic<int>* completionCounter, eJobPriority priority)
+		: m_batchFunc(batchFunc)
+		, m_batchBegin(batchBegin)
+		, m_batchEnd(batchEnd)
+		, m_batchIndex(batchIndex)
+	{
+		m_isDetached = true;
+		m_completionCounter = completionCounter;
+		m_priority = priority;
+	}
+	virtual void Execute() override { (*m_batchFunc)(m_batchBegin, m_batchEnd, m_batchIndex); }
+
+	BATCH_FUNC const* m_batchFunc = nullptr;
+	int m_batchBegin = 0;
+	int m_batchEnd = 0;
+	int m_batchIndex = 0;
+};
+
+//Chase-Lev deque, the owning worker pushes and pops at the bottom, other workers steal from the top
+class JobWorkStealingQueue
+{
+public:
+	JobWorkStealingQueue();
+	bool Push(Job* job);//owner only, false when full
+	Job* Pop();//owner only
+	Job* Steal();//any thread
+	bool IsEmpty() const;
+
+	static constexpr int CAPACITY = 4096;//must be power of two
+private:
+	std::atomic<long long> m_top;
+	std::atomic<long long> m_bottom;
+	std::atomic<Job*> m_jobs[CAPACITY];
+};
+
+//A job stack that can be switched away from in WaitFor(JobCounter const&) and resumed on any worker
+struct JobFiber
+{
+	void*				m_fiberHandle = nullptr;
+	JobSystem*			m_system = nullptr;
+	Job*				m_job = nullptr;//job to start on the next switch, null while it is running or idle
+	JobCounter const*	m_waitCounter = nullptr;//set by the fiber right before it switches away to wait
+	JobFiber*			m_nextInList = nullptr;//intrusive link for the free, ready and waiting lists
+};
+
 class JobSystemWorkerThread
 {
 public:
 	void WorkerThreadMain();
-	void StartJob(Job* job);
-	void FinishJob(Job* job);
+	void RunFiber(JobFiber* fiber);
+	static void FiberMain(JobFiber* fiber);
 	JobSystemWorkerThread(int threadID, JobSystem* system)
 		: m_threadID(threadID)
 		, m_system(system)
+		, m_randomState(2654435761u * (unsigned int)(threadID + 1))
 	{
 		m_threadObject = new std::thread(&JobSystemWorkerThread::WorkerThreadMain, this);
 	}
@@ -38,34 +228,251 @@ public:
 	{
 		delete m_threadObject;
 	}
+	unsigned int GetNextRandom();
 public:
 	std::thread* m_threadObject = nullptr;
 	int m_threadID = 0;
 	JobSystem* m_system = nullptr;
+	JobWorkStealingQueue m_localJobs[NUM_JOB_PRIORITIES];
+	std::atomic<Job*> m_completedJobs{ nullptr };//jobs this worker finished, claimed by the main thread
+	unsigned int m_randomState = 1;
+	void* m_schedulerFiber = nullptr;//the worker thread itself, converted, when fibers are enabled
+	JobFiber* m_runningFiber = nullptr;
 };
 
 class JobSystem
 {
 public:
-	JobSystem() = default;
+	static constexpr size_t DEFAULT_FIBER_STACK_SIZE = 64 * 1024;
+	static constexpr int WAIT_SAMPLE_INTERVAL = 8;
+
+	JobSystem();
 	~JobSystem();//handle shut down case
+	//Call before creating worker threads. Workers then run every job on a fiber and a job that calls
+	//WaitFor(JobCounter const&) hands its worker to other jobs instead of blocking it.
+	//Jobs may resume on a different thread, so do not keep thread local state across that wait.
+	//Win32 fibers on Windows, ucontext everywhere else.
+	void EnableFibers(size_t fiberStackSizeBytes = DEFAULT_FIBER_STACK_SIZE);
 	void CreateWorkerThread(int threadID);
 	void CreateWorkerThreads(int numThread);
 	void StopWorkerThreads();
-	void PostJob(Job* job);
+	//job must come from new, it is deleted once it has been claimed
+	JobHandle PostJob(Job* job);
+	//counter goes up now and down once the job has executed
+	JobHandle PostJob(Job* job, JobCounter* counter);
+	template<typename FUNC>
+	JobHandle PostLambdaJob(FUNC const& func, eJobPriority priority = JOB_PRIORITY_NORMAL);
+	template<typename FUNC>
+	JobHandle PostLambdaJob(FUNC const& func, JobCounter* counter, eJobPriority priority = JOB_PRIORITY_NORMAL);
 	void ClaimAndDeleteAllCompletedJobs();//
-	Job* PopJobFromRunningByIndex(int id);
 	void ShutDown();
 
+	eJobStatus GetStatus(JobHandle const& handle) const;
+	//Blocks until the job has executed. In the meantime the caller runs queued jobs from its own lane
+	//(frame critical outside of a job), more urgent lanes and the lane of the job it waits for, never less urgent ones.
+	void WaitFor(JobHandle const& handle);
+	//Returns once every job posted with counter has executed. On a fiber the job is suspended,
+	//anywhere else the caller runs queued jobs in the meantime, picked the same way as in WaitFor(JobHandle const&).
+	void WaitFor(JobCounter const& counter);
+
+	//Runs one queued job on the calling thread, returns false if there was nothing to run
+	bool TryExecuteOneJob();
+	//Called from inside a running job, executes any queued jobs of a more urgent lane before returning.
+	//Returns true if anything ran.
+	bool YieldToHigherPriorityJobs();
+
+	JobLaneStats GetLaneStats(eJobPriority priority) const;
+	void ResetLaneStats();
+
+	//Records job begin/end, steals and parking into per-thread ring buffers.
+	//#define ENGINE_DISABLE_JOB_TRACE in EngineBuildPreferences.hpp to compile it out.
+	void SetTraceEnabled(bool isEnabled);
+	//Writes the recorded events as Chrome trace event JSON (chrome://tracing), false if nothing was written
+	bool DumpTrace(std::string const& path) const;
+
+	//Splits [begin, end) into batches of grainSize and blocks until func(index) ran for every index.
+	//The calling thread executes queued jobs while it waits.
+	template<typename FUNC>
+	void ParallelFor(int begin, int end, int grainSize, FUNC const& func);
+
+	//Same batching as ParallelFor, map(index) results are folded with reduce(a, b) starting from identity.
+	//Partial results are combined in batch order, so the result does not depend on scheduling.
+	template<typename T, typename MAP, typename REDUCE>
+	T ParallelReduce(int begin, int end, int grainSize, T const& identity, MAP const& map, REDUCE const& reduce);
+
+private:
+	template<typename BATCH_FUNC>
+	void RunBatches(int begin, int end, int grainSize, BATCH_FUNC const& batchFunc);
+	static eJobPriority GetCallerPriority();
+	bool HelpWhileWaiting(int awaitedLane);//runs one queued job, see WaitFor(JobHandle const&)
+	void WaitUntilZero(std::atomic<int> const& counter);
+	void EnqueueJob(Job* job);
+	void ReleaseDependents(Job* job);
+	void PushCompletedJob(Job* job);
+	static void CallBackAndDeleteCompletedJobs(Job* newestJob);
+	void PushInjectedJob(Job* job, int lane);
+	Job* PopInjectedJob(int lane);
+	Job* FindJobToRun(JobSystemWorkerThread* worker, int numLanes = NUM_JOB_PRIORITIES);
+	Job* StealJob(JobSystemWorkerThread* thief, int lane);
+	void ExecuteJob(Job* job);
+	bool HasPendingWork() const;//queued jobs in any lane or fibers ready to resume
+	void WakeWorker();
+	void ParkWorker();
+	void DecrementCounter(JobCounter* counter);
+	JobFiber* AcquireFiber();
+	void ReleaseFiber(JobFiber* fiber);
+	void PushReadyFiber(JobFiber* fiber);
+	JobFiber* PopReadyFiber();
+	void DeleteFibers();
+
 private:
-	std::deque< Job* >	m_jobsQueued;
-	std::deque< Job* >  m_jobsRunning;
-	std::deque< Job* >	m_jobsCompleted;
-	std::mutex			m_jobsQueuedMutex;
-	std::mutex			m_jobsRunningMutex;
-	std::mutex			m_jobsCompleteMutex;
+	//jobs posted from threads outside of the system, e.g. the main thread, lock-free so posting never waits on a worker
+	static constexpr size_t INJECTED_JOBS_CAPACITY = 16384;
+	typedef MPMCRingQueue<Job*, INJECTED_JOBS_CAPACITY> InjectedJobQueue;
+	InjectedJobQueue*	m_injectedJobs[NUM_JOB_PRIORITIES] = {};
+	//only used while a lane's inject queue is full, the count lets everyone else skip the lock
+	Job*				m_overflowJobsHead[NUM_JOB_PRIORITIES] = {};
+	Job*				m_overflowJobsTail[NUM_JOB_PRIORITIES] = {};
+	std::atomic<int>	m_numOverflowJobs[NUM_JOB_PRIORITIES] = {};
+	std::mutex			m_overflowJobsMutex;
+	std::atomic<Job*>	m_jobsCompleted{ nullptr };//finished by threads that are not workers
 	std::atomic<bool>	m_isQuitting = false;
 	std::vector< JobSystemWorkerThread* >		m_workerThreads;
 
+	//workers visible to thieves, filled once per thread so it can be read without locking
+	static constexpr int MAX_WORKER_THREADS = 64;
+	std::atomic<JobSystemWorkerThread*>	m_stealableWorkers[MAX_WORKER_THREADS] = {};
+	std::atomic<int>		m_numStealableWorkers{ 0 };
+
+	//idle workers park here instead of polling the queues, after retrying FindJobToRun this many times
+	static constexpr int IDLE_SPINS_BEFORE_PARKING = 64;
+	std::mutex				m_idleMutex;
+	std::condition_variable	m_idleCondition;
+	std::atomic<int>		m_numParkedWorkers{ 0 };
+	std::atomic<int>		m_numSpinningWorkers{ 0 };//still retrying FindJobToRun, they pick new jobs up without a wake-up
+
+	struct LaneCounters
+	{
+		std::atomic<int>		m_queueDepth{ 0 };
+		std::atomic<int>		m_numJobsStarted{ 0 };
+		std::atomic<int>		m_numJobsTimed{ 0 };
+		std::atomic<long long>	m_totalWaitMicroseconds{ 0 };
+		std::atomic<long long>	m_maxWaitMicroseconds{ 0 };
+	};
+	LaneCounters			m_laneCounters[NUM_JOB_PRIORITIES];
+
+	bool					m_useFibers = false;
+	size_t					m_fiberStackSize = DEFAULT_FIBER_STACK_SIZE;
+	std::mutex				m_fiberMutex;
+	std::vector<JobFiber*>	m_allFibers;
+	JobFiber*				m_freeFibers = nullptr;
+	JobFiber*				m_readyFibersHead = nullptr;//waits that finished, resumed before new jobs start
+	JobFiber*				m_readyFibersTail = nullptr;
+	std::atomic<int>		m_numReadyFibers{ 0 };
+
+	std::atomic<bool>		m_isTracing{ false };
+
 	friend class JobSystemWorkerThread;
-};
\ No newline at end of file
+};
+
+template<typename FUNC>
+JobHandle JobSystem::PostLambdaJob(FUNC const& func, eJobPriority priority)
+{
+	LambdaJob<FUNC>* job = new LambdaJob<FUNC>(func);
+	job->SetPriority(priority);
+	return PostJob(job);
+}
+
+template<typename FUNC>
+JobHandle JobSystem::PostLambdaJob(FUNC const& func, JobCounter* counter, eJobPriority priority)
+{
+	LambdaJob<FUNC>* job = new LambdaJob<FUNC>(func);
+	job->SetPriority(priority);
+	return PostJob(job, counter);
+}
+
+template<typename BATCH_FUNC>
+void JobSystem::RunBatches(int begin, int end, int grainSize, BATCH_FUNC const& batchFunc)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+	int numBatches = (end - begin + grainSize - 1) / grainSize;
+	if (numBatches == 1 || m_numStealableWorkers.load() == 0 || m_isQuitting)
+	{
+		for (int batchIndex = 0; batchIndex < numBatches; ++batchIndex)
+		{
+			int batchBegin = begin + batchIndex * grainSize;
+			batchFunc(batchBegin, std::min(batchBegin + grainSize, end), batchIndex);
+		}
+		return;
+	}
+
+	//first batch runs on the calling thread, the rest are posted
+	std::atomic<int> numBatchesRemaining(numBatches - 1);
+	eJobPriority priority = GetCallerPriority();
+	for (int batchIndex = 1; batchIndex < numBatches; ++batchIndex)
+	{
+		int batchBegin = begin + batchIndex * grainSize;
+		PostJob(new ParallelBatchJob<BATCH_FUNC>(&batchFunc, batchBegin, std::min(batchBegin + grainSize, end), batchIndex, &numBatchesRemaining, priority));
+	}
+	batchFunc(begin, std::min(begin + grainSize, end), 0);
+	WaitUntilZero(numBatchesRemaining);
+}
+
+template<typename FUNC>
+void JobSystem::ParallelFor(int begin, int end, int grainSize, FUNC const& func)
+{
+	auto batchFunc = [&func](int batchBegin, int batchEnd, int batchIndex)
+	{
+		(void)batchIndex;
+		for (int index = batchBegin; index < batchEnd; ++index)
+		{
+			func(index);
+		}
+	};
+	RunBatches(begin, end, grainSize, batchFunc);
+}
+
+template<typename T, typename MAP, typename REDUCE>
+T JobSystem::ParallelReduce(int begin, int end, int grainSize, T const& identity, MAP const& map, REDUCE const& reduce)
+{
+	if (end <= begin)
+	{
+		return identity;
+	}
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+	int numBatches = (end - begin + grainSize - 1) / grainSize;
+	//one cache line each, batches finishing at the same time do not write to the same line.
+	//Also keeps std::vector<bool> from packing the results of different batches into one word.
+	struct alignas(64) Partial
+	{
+		T m_value;
+	};
+	std::vector<Partial> partials(numBatches, Partial{ identity });
+	auto batchFunc = [&](int batchBegin, int batchEnd, int batchIndex)
+	{
+		T partial = identity;
+		for (int index = batchBegin; index < batchEnd; ++index)
+		{
+			partial = reduce(partial, map(index));
+		}
+		partials[batchIndex].m_value = partial;
+	};
+	RunBatches(begin, end, grainSize, batchFunc);
+
+	T result = identity;
+	for (int batchIndex = 0; batchIndex < numBatches; ++batchIndex)
+	{
+		result = reduce(result, partials[batchIndex].m_value);
+	}
+	return result;
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+//Bounded lock-free queue for any number of producers and consumers (Vyukov's ring with per-slot sequence numbers).
+//Never allocates after construction. CAPACITY must be a power of two.
+template<typename T, size_t CAPACITY = 1024>
+class MPMCRingQueue
+{
+public:
+	using value_type = T;
+public:
+	MPMCRingQueue();
+	MPMCRingQueue(MPMCRingQueue const&) = delete;
+	MPMCRingQueue(MPMCRingQueue const&&) = delete;
+	~MPMCRingQueue() = default;
+
+	MPMCRingQueue& operator=(MPMCRingQueue const&) = delete;
+	MPMCRingQueue& operator=(MPMCRingQueue const&&) = delete;
+
+	//Approximate while other threads are pushing or popping
+	size_t GetSize() const;
+
+	//Return false instead of waiting when the queue is full or empty
+	bool try_push(value_type const& value);
+	bool try_push(value_type&& value);
+	bool try_pop(value_type& out_value);
+	//Moves up to maxCount items into out_values with a single claim, returns how many it took
+	size_t pop_n(value_type* out_values, size_t maxCount);
+
+	//Same interface as SynchronizedNonblockingQueue: push drops the value when full,
+	//pop returns a default constructed value when empty
+	bool push(value_type const& value) { return try_push(value); }
+	value_type pop();
+
+private:
+	template<typename VALUE>
+	bool Enqueue(VALUE&& value);
+
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+	static constexpr size_t INDEX_MASK = CAPACITY - 1;
+	static_assert(CAPACITY >= 2 && (CAPACITY & INDEX_MASK) == 0, "MPMCRingQueue capacity must be a power of two");
+
+	struct Slot
+	{
+		//equals the position when the slot is free for that push, position + 1 once it holds that push's value
+		std::atomic<size_t> m_sequence;
+		value_type m_value;
+	};
+
+	//producers and consumers each hammer their own position, keep them on separate cache lines
+	char m_padding0[CACHE_LINE_SIZE];
+	std::atomic<size_t> m_enqueuePosition{ 0 };
+	char m_padding1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> m_dequeuePosition{ 0 };
+	char m_padding2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	Slot m_slots[CAPACITY];
+};
+
+template<typename T, size_t CAPACITY>
+MPMCRingQueue<T, CAPACITY>::MPMCRingQueue()
+{
+	for (size_t index = 0; index < CAPACITY; ++index)
+	{
+		m_slots[index].m_sequence.store(index, std::memory_order_relaxed);
+	}
+}
+
+template<typename T, size_t CAPACITY>
+size_t MPMCRingQueue<T, CAPACITY>::GetSize() const
+{
+	size_t enqueuePosition = m_enqueuePosition.load(std::memory_order_acquire);
+	size_t dequeuePosition = m_dequeuePosition.load(std::memory_order_acquire);
+	return (enqueuePosition > dequeuePosition) ? enqueuePosition - dequeuePosition : 0;
+}
+
+template<typename T, size_t CAPACITY>
+bool MPMCRingQueue<T, CAPACITY>::try_push(value_type const& value)
+{
+	return Enqueue(value);
+}
+
+template<typename T, size_t CAPACITY>
+bool MPMCRingQueue<T, CAPACITY>::try_push(value_type&& value)
+{
+	return Enqueue(std::move(value));
+}
+
+template<typename T, size_t CAPACITY>
+template<typename VALUE>
+bool MPMCRingQueue<T, CAPACITY>::Enqueue(VALUE&& value)
+{
+	size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Slot& slot = m_slots[position & INDEX_MASK];
+		size_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+		ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)position;
+		if (difference == 0)
+		{
+			if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				slot.m_value = std::forward<VALUE>(value);
+				slot.m_sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+			//lost the slot, position now holds the current enqueue position
+		}
+		else if (difference < 0)
+		{
+			//the consumer one lap behind has not freed this slot yet
+			return false;
+		}
+		else
+		{
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template<typename T, size_t CAPACITY>
+bool MPMCRingQueue<T, CAPACITY>::try_pop(value_type& out_value)
+{
+	size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Slot& slot = m_slots[position & INDEX_MASK];
+		size_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+		ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)(position + 1);
+		if (difference == 0)
+		{
+			if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				out_value = std::move(slot.m_value);
+				slot.m_sequence.store(position + CAPACITY, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else
+		{
+			position = m_dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template<typename T, size_t CAPACITY>
+size_t MPMCRingQueue<T, CAPACITY>::pop_n(value_type* out_values, size_t maxCount)
+{
+	size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		//count how many filled slots follow position, then claim them all at once
+		size_t numReady = 0;
+		while (numReady < maxCount && numReady < CAPACITY)
+		{
+			size_t sequence = m_slots[(position + numReady) & INDEX_MASK].m_sequence.load(std::memory_order_acquire);
+			if (sequence != position + numReady + 1)
+			{
+				break;
+			}
+			++numReady;
+		}
+		if (numReady == 0)
+		{
+			size_t sequence = m_slots[position & INDEX_MASK].m_sequence.load(std::memory_order_acquire);
+			if ((ptrdiff_t)sequence - (ptrdiff_t)(position + 1) < 0)
+			{
+				return 0;
+			}
+			//another consumer moved on, retry from the new position
+			position = m_dequeuePosition.load(std::memory_order_relaxed);
+			continue;
+		}
+		if (m_dequeuePosition.compare_exchange_weak(position, position + numReady, std::memory_order_relaxed))
+		{
+			for (size_t index = 0; index < numReady; ++index)
+			{
+				Slot& slot = m_slots[(position + index) & INDEX_MASK];
+				out_values[index] = std::move(slot.m_value);
+				slot.m_sequence.store(position + index + CAPACITY, std::memory_order_release);
+			}
+			return numReady;
+		}
+	}
+}
+
+template<typename T, size_t CAPACITY>
+typename MPMCRingQueue<T, CAPACITY>::value_type MPMCRingQueue<T, CAPACITY>::pop()
+{
+	value_type value = value_type();
+	try_pop(value);
+	return value;
+}
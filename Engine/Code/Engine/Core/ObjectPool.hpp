@@ -0,0 +1,109 @@
+#pragma once
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <new>
+#include <type_traits>
+#include <vector>
+
+//Weak reference to an object in an ObjectPool, the generation tells the object apart from later ones in the same slot
+struct PoolHandle
+{
+	int m_index = -1;
+	unsigned int m_generation = 0;
+};
+
+//Slots for objects of one type, allocated BLOCK_SIZE at a time and never moved or given back while the pool lives,
+//so pointers stay valid until their slot is freed. Allocate and Free are O(1), freed slots are reused last in first out.
+//The pool only hands out storage, the owner constructs and destroys the objects in it.
+template<typename T, int BLOCK_SIZE = 256>
+class ObjectPool
+{
+public:
+	ObjectPool() = default;
+	ObjectPool(ObjectPool const&) = delete;
+	~ObjectPool();
+
+	ObjectPool& operator=(ObjectPool const&) = delete;
+
+	//Uninitialized storage for one T
+	void* Allocate(PoolHandle& outHandle);
+	//The object must already be destroyed, every handle to the slot goes stale
+	void Free(PoolHandle const& handle);
+	bool IsValid(PoolHandle const& handle) const;
+	//nullptr once the slot was freed
+	T* Get(PoolHandle const& handle) const;
+
+	int GetLiveCount() const { return m_liveCount; }
+	int GetCapacity() const { return (int)m_blocks.size() * BLOCK_SIZE; }
+	size_t GetMemoryUsage() const;
+
+private:
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+	Slot* GetSlot(int index) const { return &m_blocks[index / BLOCK_SIZE][index % BLOCK_SIZE]; }
+
+private:
+	std::vector<Slot*> m_blocks;
+	std::vector<unsigned int> m_generations;	//odd while the slot is in use
+	std::vector<int> m_freeIndices;
+	int m_liveCount = 0;
+};
+
+template<typename T, int BLOCK_SIZE>
+ObjectPool<T, BLOCK_SIZE>::~ObjectPool()
+{
+	for (Slot* block : m_blocks)
+	{
+		delete[] block;
+	}
+}
+
+template<typename T, int BLOCK_SIZE>
+void* ObjectPool<T, BLOCK_SIZE>::Allocate(PoolHandle& outHandle)
+{
+	if (m_freeIndices.empty())
+	{
+		int firstIndex = GetCapacity();
+		m_blocks.push_back(new Slot[BLOCK_SIZE]);
+		m_generations.resize(firstIndex + BLOCK_SIZE, 0);
+		//highest index on top so a fresh block is handed out front to back
+		for (int index = firstIndex + BLOCK_SIZE - 1; index >= firstIndex; --index)
+		{
+			m_freeIndices.push_back(index);
+		}
+	}
+	int index = m_freeIndices.back();
+	m_freeIndices.pop_back();
+	++m_generations[index];
+	++m_liveCount;
+	outHandle.m_index = index;
+	outHandle.m_generation = m_generations[index];
+	return GetSlot(index);
+}
+
+template<typename T, int BLOCK_SIZE>
+void ObjectPool<T, BLOCK_SIZE>::Free(PoolHandle const& handle)
+{
+	GUARANTEE_OR_DIE(IsValid(handle), "Freeing a stale pool handle");
+	++m_generations[handle.m_index];
+	--m_liveCount;
+	m_freeIndices.push_back(handle.m_index);
+}
+
+template<typename T, int BLOCK_SIZE>
+bool ObjectPool<T, BLOCK_SIZE>::IsValid(PoolHandle const& handle) const
+{
+	return handle.m_index >= 0 && handle.m_index < (int)m_generations.size() && (handle.m_generation & 1) != 0 &&
+		m_generations[handle.m_index] == handle.m_generation;
+}
+
+template<typename T, int BLOCK_SIZE>
+T* ObjectPool<T, BLOCK_SIZE>::Get(PoolHandle const& handle) const
+{
+	return IsValid(handle) ? reinterpret_cast<T*>(GetSlot(handle.m_index)) : nullptr;
+}
+
+template<typename T, int BLOCK_SIZE>
+size_t ObjectPool<T, BLOCK_SIZE>::GetMemoryUsage() const
+{
+	return (size_t)GetCapacity() * sizeof(Slot) + m_blocks.capacity() * sizeof(Slot*) +
+		m_generations.capacity() * sizeof(unsigned int) + m_freeIndices.capacity() * sizeof(int);
+}
@@ -0,0 +1,2 @@
+#include "Engine/Core/SPSCRing.hpp"
+
@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//Wait-free ring for exactly one producer thread and one consumer thread.
+//Values are constructed in place in the ring and destroyed as they are popped. CAPACITY must be a power of two.
+template<typename T, size_t CAPACITY = 1024>
+class SPSCRing
+{
+public:
+	using value_type = T;
+public:
+	SPSCRing() = default;
+	SPSCRing(SPSCRing const&) = delete;
+	SPSCRing(SPSCRing const&&) = delete;
+	~SPSCRing();
+
+	SPSCRing& operator=(SPSCRing const&) = delete;
+	SPSCRing& operator=(SPSCRing const&&) = delete;
+
+	//Approximate unless called from the producer or consumer thread
+	size_t GetSize() const;
+
+	//Producer only, return false when the ring is full
+	template<typename... ARGS>
+	bool try_emplace(ARGS&&... args);
+	bool try_push(value_type const& value) { return try_emplace(value); }
+	bool try_push(value_type&& value) { return try_emplace(std::move(value)); }
+
+	//Consumer only
+	bool try_pop(value_type& out_value);
+	//Moves up to maxCount values into out_values, returns how many it took
+	size_t pop_n(value_type* out_values, size_t maxCount);
+
+	//Same interface as SynchronizedNonblockingQueue: push drops the value when full,
+	//pop returns a default constructed value when empty
+	bool push(value_type const& value) { return try_emplace(value); }
+	value_type pop();
+
+private:
+	value_type* GetSlot(size_t position) { return reinterpret_cast<value_type*>(&m_slots[position & INDEX_MASK]); }
+
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+	static constexpr size_t INDEX_MASK = CAPACITY - 1;
+	static_assert(CAPACITY >= 2 && (CAPACITY & INDEX_MASK) == 0, "SPSCRing capacity must be a power of two");
+
+	//each side owns one cache line: its own position plus its last look at the other side's position,
+	//so the shared line is only read again when the cached value says the ring is full or empty
+	char				m_padding0[CACHE_LINE_SIZE];
+	std::atomic<size_t>	m_head{ 0 };//next position to pop, written by the consumer
+	size_t				m_cachedTail = 0;
+	char				m_padding1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+	std::atomic<size_t>	m_tail{ 0 };//next position to push, written by the producer
+	size_t				m_cachedHead = 0;
+	char				m_padding2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+	typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type m_slots[CAPACITY];
+};
+
+template<typename T, size_t CAPACITY>
+SPSCRing<T, CAPACITY>::~SPSCRing()
+{
+	size_t tail = m_tail.load(std::memory_order_acquire);
+	for (size_t position = m_head.load(std::memory_order_relaxed); position != tail; ++position)
+	{
+		GetSlot(position)->~value_type();
+	}
+}
+
+template<typename T, size_t CAPACITY>
+size_t SPSCRing<T, CAPACITY>::GetSize() const
+{
+	size_t head = m_head.load(std::memory_order_acquire);
+	size_t tail = m_tail.load(std::memory_order_acquire);
+	return (tail > head) ? tail - head : 0;
+}
+
+template<typename T, size_t CAPACITY>
+template<typename... ARGS>
+bool SPSCRing<T, CAPACITY>::try_emplace(ARGS&&... args)
+{
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	if (tail - m_cachedHead >= CAPACITY)
+	{
+		m_cachedHead = m_head.load(std::memory_order_acquire);
+		if (tail - m_cachedHead >= CAPACITY)
+		{
+			return false;
+		}
+	}
+	new (GetSlot(tail)) value_type(std::forward<ARGS>(args)...);
+	m_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T, size_t CAPACITY>
+bool SPSCRing<T, CAPACITY>::try_pop(value_type& out_value)
+{
+	return pop_n(&out_value, 1) == 1;
+}
+
+template<typename T, size_t CAPACITY>
+size_t SPSCRing<T, CAPACITY>::pop_n(value_type* out_values, size_t maxCount)
+{
+	size_t head = m_head.load(std::memory_order_relaxed);
+	if (m_cachedTail - head < maxCount)
+	{
+		m_cachedTail = m_tail.load(std::memory_order_acquire);
+	}
+	size_t numAvailable = m_cachedTail - head;
+	size_t numToPop = (numAvailable < maxCount) ? numAvailable : maxCount;
+	for (size_t index = 0; index < numToPop; ++index)
+	{
+		value_type* slot = GetSlot(head + index);
+		out_values[index] = std::move(*slot);
+		slot->~value_type();
+	}
+	if (numToPop > 0)
+	{
+		m_head.store(head + numToPop, std::memory_order_release);
+	}
+	return numToPop;
+}
+
+template<typename T, size_t CAPACITY>
+typename SPSCRing<T, CAPACITY>::value_type SPSCRing<T, CAPACITY>::pop()
+{
+	value_type value = value_type();
+	try_pop(value);
+	return value;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <queue>
+#include <vector>
 #include <mutex>
+#include <chrono>
 #include <condition_variable>
 template<typename T>
 class SynchronizedBlockingQueue : protected std::queue<T>
@@ -19,27 +21,62 @@ public:
 	SynchronizedBlockingQueue& operator=(SynchronizedBlockingQueue const&&) = delete;
 
 	size_t GetSize();
+	//Values pushed after close are dropped
 	void push(const value_type& value);
+	void push(value_type&& value);
+	//Blocks until there is a value, returns a default constructed value once the queue is closed and empty
 	value_type pop();
+	//Returns false if nothing arrived within timeout or the queue is closed and empty
+	template<typename REP, typename PERIOD>
+	bool pop_for(value_type& out_value, std::chrono::duration<REP, PERIOD> const& timeout);
+	//Blocks until there is a value, then moves up to maxCount values into out_values under one lock.
+	//Returns 0 only once the queue is closed and empty.
+	size_t drain(std::vector<value_type>& out_values, size_t maxCount);
+	//Wakes every waiting pop for shut down, the remaining values can still be popped
+	void close();
+	bool IsClosed();
 	void notify_all();
 protected:
 
 private:
 	std::mutex m_lock;
 	std::condition_variable m_condition;
+	bool m_isClosed = false;
 };
 
 template<typename T>
 void SynchronizedBlockingQueue<T>::push(const value_type& value)
 {
-	std::lock_guard<std::mutex> guard(m_lock);
-	base::push(value);
-	m_condition.notify_all();
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		if (m_isClosed)
+		{
+			return;
+		}
+		base::push(value);
+	}
+	//one value only needs one consumer, and notifying outside the lock saves it from waking into a held mutex
+	m_condition.notify_one();
+}
+
+template<typename T>
+void SynchronizedBlockingQueue<T>::push(value_type&& value)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		if (m_isClosed)
+		{
+			return;
+		}
+		base::push(std::move(value));
+	}
+	m_condition.notify_one();
 }
 
 template<typename T>
 size_t SynchronizedBlockingQueue<T>::GetSize()
 {
+	std::lock_guard<std::mutex> guard(m_lock);
 	return base::size();
 }
 
@@ -48,20 +85,62 @@ typename SynchronizedBlockingQueue<T>::value_type SynchronizedBlockingQueue<T>::
 {
 	value_type value = value_type();
 	std::unique_lock<std::mutex> uniqueLock(m_lock);
-	if (base::empty())
-	{
-		m_condition.wait(uniqueLock);
-	}
-	//If it is still empty
+	m_condition.wait(uniqueLock, [this]() { return !base::empty() || m_isClosed; });
 	if (base::empty())
 	{
 		return value;
 	}
-	value = base::front();
+	value = std::move(base::front());
 	base::pop();
 	return value;
 }
 
+template<typename T>
+template<typename REP, typename PERIOD>
+bool SynchronizedBlockingQueue<T>::pop_for(value_type& out_value, std::chrono::duration<REP, PERIOD> const& timeout)
+{
+	std::unique_lock<std::mutex> uniqueLock(m_lock);
+	if (!m_condition.wait_for(uniqueLock, timeout, [this]() { return !base::empty() || m_isClosed; }) || base::empty())
+	{
+		return false;
+	}
+	out_value = std::move(base::front());
+	base::pop();
+	return true;
+}
+
+template<typename T>
+size_t SynchronizedBlockingQueue<T>::drain(std::vector<value_type>& out_values, size_t maxCount)
+{
+	std::unique_lock<std::mutex> uniqueLock(m_lock);
+	m_condition.wait(uniqueLock, [this]() { return !base::empty() || m_isClosed; });
+	size_t numDrained = 0;
+	while (!base::empty() && numDrained < maxCount)
+	{
+		out_values.push_back(std::move(base::front()));
+		base::pop();
+		++numDrained;
+	}
+	return numDrained;
+}
+
+template<typename T>
+void SynchronizedBlockingQueue<T>::close()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_isClosed = true;
+	}
+	m_condition.notify_all();
+}
+
+template<typename T>
+bool SynchronizedBlockingQueue<T>::IsClosed()
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_isClosed;
+}
+
 template<typename T>
 void SynchronizedBlockingQueue<T>::notify_all()
 {
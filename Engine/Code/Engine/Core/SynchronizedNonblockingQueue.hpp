@@ -7,7 +7,7 @@ template<typename T>
 class SynchronizedNonblockingQueue : protected std::queue<T>
 {
 public:
-	using value_type = typename T;
+	using value_type = T;
 protected:
 	using base = typename std::queue<T>;
 public:
@@ -27,14 +27,18 @@ protected:
 private:
 	const int UNLOCKED = 0;
 	const int LOCKED = 1;
-	std::atomic<int> m_atomic;
+	std::atomic<int> m_atomic{ UNLOCKED };
 };
 
 template<typename T>
 void SynchronizedNonblockingQueue<T>::lock()
 {
 	int expected = UNLOCKED;
-	while (!m_atomic.compare_exchange_strong(expected, LOCKED));
+	while (!m_atomic.compare_exchange_strong(expected, LOCKED))
+	{
+		//a failed exchange leaves LOCKED in expected, the next try would take the lock from its owner
+		expected = UNLOCKED;
+	}
 }
 
 template<typename T>
@@ -1,4 +1,5 @@
 #include "Engine/Core/Vertex_Lit.hpp"
+#include <cstddef>
 
 Vertex_Lit::Vertex_Lit(const Vec3& position, const Rgba8& tint, const Vec2& uvTexCoords,
 	const Vec4& tangent, const Vec3 normal)
@@ -1,4 +1,5 @@
 #include "Engine/Core/Vertex_PCU.hpp"
+#include <cstddef>
 
 Vertex_PCU::Vertex_PCU()
 	:m_position( Vec3(0.f, 0.f, 0.f) )
@@ -12,6 +12,7 @@
 #include "Engine/Math/Disc2.hpp"
 #include "Engine/Math/Segment2D.hpp"
 #include <vector>
+#include <utility>
 
 float	ConvertDegreesToRadians( float degrees )
 {
@@ -201,6 +202,19 @@ bool	DoPolygonPlaneOverlap(const Polygon2D& polygon, const Plane2D& plane)
 	return false;
 }
 
+bool	DoAABBsOverlap2D(const AABB2& boxA, const AABB2& boxB)
+{
+	//touching edges do not count, same as DoDiscsOverlap
+	return boxA.mins.x < boxB.maxs.x && boxB.mins.x < boxA.maxs.x &&
+		boxA.mins.y < boxB.maxs.y && boxB.mins.y < boxA.maxs.y;
+}
+
+bool	DoesAABBContainAABB2D(const AABB2& outerBox, const AABB2& innerBox)
+{
+	return outerBox.mins.x <= innerBox.mins.x && outerBox.mins.y <= innerBox.mins.y &&
+		innerBox.maxs.x <= outerBox.maxs.x && innerBox.maxs.y <= outerBox.maxs.y;
+}
+
 bool	DoDiscPlaneOverlap(const Vec2& center, float radius, const Plane2D& plane)
 {
 	Vec2 planeCenter = plane.distanceFromOriginAlongNormal * plane.normal;
@@ -420,7 +434,7 @@ void	AddVertsForPolygon2D(std::vector<Vertex_PCU>& vertices, const Polygon2D& po
 	Vec2 center = polygon.GetCenter();
 	int numPoints = polygon.GetVertexCount();
 
-	std::vector<Vec2> points = polygon.GetPoints();
+	std::vector<Vec2> const& points = polygon.GetPoints();
 	std::vector<Vertex_PCU> polyVertices;
 	for (int edgeIndex = 0; edgeIndex < numPoints - 1; ++edgeIndex)
 	{
@@ -673,9 +687,14 @@ const Vec2 GetNearestPointOnPolygon2D(const Vec2& point, std::vector<Vec2> const
 
 const Vec2 GetNearestPointOnPolygon2DEdge(const Vec2& point, std::vector<Vec2> const& polygon)
 {
-	Vec2 nearestPoint = GetNearestPointOnLineSegment2D(point, polygon[0], polygon[polygon.size() - 1]);
+	return GetNearestPointOnPolygon2DEdge(point, polygon.data(), (int)polygon.size());
+}
+
+const Vec2 GetNearestPointOnPolygon2DEdge(const Vec2& point, Vec2 const* polygon, int pointCount)
+{
+	Vec2 nearestPoint = GetNearestPointOnLineSegment2D(point, polygon[0], polygon[pointCount - 1]);
 	float shortestDistance = GetDistance2D(nearestPoint, point);
-	for (int vertexIndex = 0; vertexIndex < polygon.size() - 1; ++vertexIndex)
+	for (int vertexIndex = 0; vertexIndex < pointCount - 1; ++vertexIndex)
 	{
 		Vec2 currPoint = GetNearestPointOnLineSegment2D(point, polygon[vertexIndex], polygon[vertexIndex + 1]);
 		float distance = GetDistance2D(currPoint, point);
@@ -712,6 +731,162 @@ void	GetIntersectPointsBetweenSegementsAndDisc(const Vec2& start, const Vec2& en
 	pointB = pointB + center;
 }
 
+bool	RaycastVsAABB2D(const Vec2& start, const Vec2& direction, float maxDistance, const AABB2& box, float& outDistance)
+{
+	//slab test, an axis the ray runs parallel to only has to contain the start
+	float const starts[2] = { start.x, start.y };
+	float const directions[2] = { direction.x, direction.y };
+	float const mins[2] = { box.mins.x, box.mins.y };
+	float const maxs[2] = { box.maxs.x, box.maxs.y };
+	float entryDistance = 0.f;
+	float exitDistance = maxDistance;
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		if (fabsf(directions[axis]) < 1e-8f)
+		{
+			if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+		float inverseDirection = 1.f / directions[axis];
+		float axisEntry = (mins[axis] - starts[axis]) * inverseDirection;
+		float axisExit = (maxs[axis] - starts[axis]) * inverseDirection;
+		if (axisEntry > axisExit)
+		{
+			float temp = axisEntry;
+			axisEntry = axisExit;
+			axisExit = temp;
+		}
+		entryDistance = fmaxf(entryDistance, axisEntry);
+		exitDistance = fminf(exitDistance, axisExit);
+		if (entryDistance > exitDistance)
+		{
+			return false;
+		}
+	}
+	outDistance = entryDistance;
+	return true;
+}
+
+bool	RaycastVsDisc2D(const Vec2& start, const Vec2& direction, float maxDistance, const Vec2& center, float radius, float& outDistance, Vec2& outNormal)
+{
+	Vec2 centerToStart = start - center;
+	float startOutside = DotProduct2D(centerToStart, centerToStart) - radius * radius;
+	if (startOutside <= 0.f)
+	{
+		outDistance = 0.f;
+		outNormal = -direction;
+		return true;
+	}
+	float approach = DotProduct2D(centerToStart, direction);
+	if (approach >= 0.f)
+	{
+		return false;
+	}
+	//measured from the closest approach instead of approach^2 - startOutside, which cancels badly for far away discs
+	Vec2 closestToCenter = centerToStart - direction * approach;
+	float discriminant = radius * radius - DotProduct2D(closestToCenter, closestToCenter);
+	if (discriminant < 0.f)
+	{
+		return false;
+	}
+	float distance = -approach - sqrtf(discriminant);
+	if (distance > maxDistance)
+	{
+		return false;
+	}
+	outDistance = distance;
+	outNormal = (centerToStart + direction * distance).GetNormalized();
+	return true;
+}
+
+bool	RaycastVsPolygon2D(const Vec2& start, const Vec2& direction, float maxDistance, Vec2 const* points, Vec2 const* normals, int pointCount,
+	float& outDistance, Vec2& outNormal)
+{
+	//clip the ray against every edge's plane, it is inside the polygon between the last entry and the first exit
+	float entryDistance = 0.f;
+	float exitDistance = maxDistance;
+	int entryEdge = -1;
+	for (int edgeIndex = 0; edgeIndex < pointCount; ++edgeIndex)
+	{
+		float startInside = DotProduct2D(normals[edgeIndex], points[edgeIndex] - start);
+		float approach = DotProduct2D(normals[edgeIndex], direction);
+		if (fabsf(approach) < 1e-8f)
+		{
+			if (startInside < 0.f)
+			{
+				return false;
+			}
+			continue;
+		}
+		float distance = startInside / approach;
+		if (approach < 0.f)
+		{
+			if (distance > entryDistance)
+			{
+				entryDistance = distance;
+				entryEdge = edgeIndex;
+			}
+		}
+		else if (distance < exitDistance)
+		{
+			exitDistance = distance;
+		}
+		if (entryDistance > exitDistance)
+		{
+			return false;
+		}
+	}
+	outDistance = entryDistance;
+	outNormal = (entryEdge == -1) ? -direction : normals[entryEdge];
+	return true;
+}
+
+bool	DiscCastVsPolygon2D(const Vec2& start, float radius, const Vec2& direction, float maxDistance, Vec2 const* points, Vec2 const* normals, int pointCount,
+	float& outDistance, Vec2& outNormal)
+{
+	if (IsPointInsidePolygon2D(start, points, pointCount) ||
+		GetDistanceSquared2D(start, GetNearestPointOnPolygon2DEdge(start, points, pointCount)) <= radius * radius)
+	{
+		outDistance = 0.f;
+		outNormal = -direction;
+		return true;
+	}
+	//the center hits the polygon grown by radius, which is the edges pushed out along their normals joined by discs at the corners
+	bool isHit = false;
+	float closestDistance = maxDistance;
+	for (int edgeIndex = 0; edgeIndex < pointCount; ++edgeIndex)
+	{
+		Vec2 const& normal = normals[edgeIndex];
+		float approach = DotProduct2D(normal, direction);
+		if (approach < 0.f)
+		{
+			Vec2 edgeStart = points[edgeIndex] + normal * radius;
+			Vec2 edge = points[(edgeIndex + 1) % pointCount] - points[edgeIndex];
+			float distance = DotProduct2D(normal, edgeStart - start) / approach;
+			float alongEdge = DotProduct2D(start + direction * distance - edgeStart, edge);
+			if (distance >= 0.f && distance <= closestDistance && alongEdge >= 0.f && alongEdge <= DotProduct2D(edge, edge))
+			{
+				isHit = true;
+				closestDistance = distance;
+				outNormal = normal;
+			}
+		}
+		float cornerDistance = 0.f;
+		Vec2 cornerNormal;
+		if (RaycastVsDisc2D(start, direction, closestDistance, points[edgeIndex], radius, cornerDistance, cornerNormal))
+		{
+			isHit = true;
+			closestDistance = cornerDistance;
+			outNormal = cornerNormal;
+		}
+	}
+	outDistance = closestDistance;
+	return isHit;
+}
+
 bool IsPointInsideDisk2D(const Vec2& point, const Vec2& discCenter, float discRadius)
 {
 	float distance = GetDistance2D(point, discCenter);
@@ -745,8 +920,13 @@ bool IsPointInsideOBB2D(const Vec2& point, const OBB2& box)
 
 bool IsPointInsidePolygon2D(const Vec2& point, std::vector<Vec2> const& polygon)
 {
-	int numVertices = (int)polygon.size();
-	for (int vertexIndex = 0; vertexIndex < polygon.size(); ++vertexIndex)
+	return IsPointInsidePolygon2D(point, polygon.data(), (int)polygon.size());
+}
+
+bool IsPointInsidePolygon2D(const Vec2& point, Vec2 const* polygon, int pointCount)
+{
+	int numVertices = pointCount;
+	for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
 	{
 		float crossProduct = CrossProduct2D(polygon[(vertexIndex + 1) % numVertices] - polygon[vertexIndex % numVertices],
 			point - polygon[vertexIndex % numVertices]);
@@ -890,7 +1070,7 @@ float GetApproximateRadiusOfPolygon2D(Polygon2D const& polygon)
 {
 	float farthestDistance = 0;
 	Vec2 center = polygon.GetCenter();
-	std::vector<Vec2> points = polygon.GetPoints();
+	std::vector<Vec2> const& points = polygon.GetPoints();
 	int numPoints = polygon.GetVertexCount();
 	for (int vertexIndex = 0; vertexIndex < numPoints; ++vertexIndex)
 	{
@@ -1055,15 +1235,20 @@ Vec2 GetCenterOfMassOfPolygon(std::vector<Vec2> const& polygon)
 
 Vec2 GetSupportOfPolygon(std::vector<Vec2> const& polygon, const Vec2& direction)
 {
-	float maxDistance = DotProduct2D(polygon[0], direction);
-	Vec2 supportPoint = polygon[0];
-	for (int verticesIndex = 1; verticesIndex < polygon.size(); ++verticesIndex)
+	return GetSupportOfPolygon(polygon.data(), (int)polygon.size(), direction);
+}
+
+Vec2 GetSupportOfPolygon(Vec2 const* points, int pointCount, const Vec2& direction)
+{
+	float maxDistance = DotProduct2D(points[0], direction);
+	Vec2 supportPoint = points[0];
+	for (int verticesIndex = 1; verticesIndex < pointCount; ++verticesIndex)
 	{
-		float distance = DotProduct2D(polygon[verticesIndex], direction);
+		float distance = DotProduct2D(points[verticesIndex], direction);
 		if (distance > maxDistance)
 		{
 			maxDistance = distance;
-			supportPoint = polygon[verticesIndex];
+			supportPoint = points[verticesIndex];
 		}
 	}
 	return supportPoint;
@@ -1104,6 +1289,17 @@ Segment2D ClipSegmentToSegment(Segment2D const& toClip, Segment2D const& refEdge
 	float Prf = DotProduct2D(Rf, Rd);
 	float Pci = DotProduct2D(Ci, Rd);
 	float Pcf = DotProduct2D(Cf, Rd);
+	//an edge perpendicular to the reference has nothing to clip and would divide by zero below
+	if (abs(Pcf - Pci) < 0.0001f)
+	{
+		return toClip;
+	}
+	//walk the edge in the reference direction so the max/min below pick the inner ends
+	if (Pci > Pcf)
+	{
+		std::swap(Ci, Cf);
+		std::swap(Pci, Pcf);
+	}
 
 	float fi = Pri;
 	if (Pci > fi)
@@ -1117,50 +1313,58 @@ Segment2D ClipSegmentToSegment(Segment2D const& toClip, Segment2D const& refEdge
 		ff = Pcf;
 	}
 
+	//an edge that misses the reference range collapses onto its nearest end instead of being extended,
+	//extending a nearly perpendicular edge would put the point far outside both shapes
+	fi = std::min(fi, Pcf);
+	ff = std::max(ff, Pci);
+
 	Vec2 Fi = RangeMapVec2(Pci, Pcf, Ci, Cf, fi);
 	Vec2 Ff = RangeMapVec2(Pci, Pcf, Ci, Cf, ff);
 	return Segment2D(Fi, Ff);
 }
 
-bool IsPolygonIntersectWithOtherPolygon(Polygon2D const& polygonA, Polygon2D const& polygonB)
+//The polytope gains at most one vertex per expansion, so both routines below fit on the stack
+static constexpr int GJK_MAX_ITERATIONS = 32;
+static constexpr int EPA_MAX_ITERATIONS = 32;
+static constexpr int EPA_MAX_VERTICES = 3 + EPA_MAX_ITERATIONS;
+
+static Vec2 GetSupportOfMinkowskiDifference(Vec2 const* pointsA, int countA, Vec2 const* pointsB, int countB, const Vec2& direction)
 {
-	Vec2 direction = polygonB.GetCenter() - polygonA.GetCenter();
-	Vec2 vert1 = polygonA.GetSupport(direction) - polygonB.GetSupport(-direction);
-	Vec2 vert2 = polygonA.GetSupport(-direction) - polygonB.GetSupport(direction);
-	Vec2 vert1ToVert2 = (vert2 - vert1).GetNormalized();
-	Vec2 vert1ToOrigin = (-vert1).GetNormalized();
+	return GetSupportOfPolygon(pointsA, countA, direction) - GetSupportOfPolygon(pointsB, countB, -direction);
+}
+
+//Leaves a triangle of A - B around the origin in simplex when the polygons overlap
+static bool RunGJK(Vec2 const* pointsA, int countA, const Vec2& centerA, Vec2 const* pointsB, int countB, const Vec2& centerB, Vec2* simplex)
+{
+	Vec2 direction = centerB - centerA;
+	Vec2 vert1 = GetSupportOfMinkowskiDifference(pointsA, countA, pointsB, countB, direction);
+	Vec2 vert2 = GetSupportOfMinkowskiDifference(pointsA, countA, pointsB, countB, -direction);
 	Vec2 normalDirection = TripleCrossProduct((vert1 - vert2), -vert2, (vert1 - vert2));
-	Vec2 vert3 = polygonA.GetSupport(normalDirection) - polygonB.GetSupport(-normalDirection);
-	
-	//Make simplex(polygon)
-	std::vector<Vec2> vertices;
-	vertices.push_back(vert1);
-	vertices.push_back(vert2);
-	vertices.push_back(vert3);
-	while (!IsOriginInsideTriangle(vertices[0], vertices[1], vertices[2]))
-	{
-		Vec2 vertA = vertices[0];
-		Vec2 vertB = vertices[1];
-		Vec2 vertC = vertices[2];
-		
-		Vec2 pointNotOnNearestEdge =
-			GetPointOfTriangleNotOnClosestEdgeOfPoint(vertA, vertB, vertC, Vec2::ZERO);
-		
-		if (pointNotOnNearestEdge == vertA)
+	simplex[0] = vert1;
+	simplex[1] = vert2;
+	simplex[2] = GetSupportOfMinkowskiDifference(pointsA, countA, pointsB, countB, normalDirection);
+	for (int iteration = 0; iteration < GJK_MAX_ITERATIONS; ++iteration)
+	{
+		if (IsOriginInsideTriangle(simplex[0], simplex[1], simplex[2]))
 		{
-			vertices.erase(vertices.begin());
+			return true;
 		}
-		else if (pointNotOnNearestEdge == vertB)
+		Vec2 pointNotOnNearestEdge =
+			GetPointOfTriangleNotOnClosestEdgeOfPoint(simplex[0], simplex[1], simplex[2], Vec2::ZERO);
+
+		//drop that point, the other two keep their order
+		if (pointNotOnNearestEdge == simplex[0])
 		{
-			vertices.erase(vertices.begin() + 1);
+			simplex[0] = simplex[1];
+			simplex[1] = simplex[2];
 		}
-		else
+		else if (pointNotOnNearestEdge == simplex[1])
 		{
-			vertices.erase(vertices.begin() + 2);
+			simplex[1] = simplex[2];
 		}
 
-		Vec2 nearestEdge = vertices[1] - vertices[0];
-		if (CrossProduct2D(nearestEdge, -vertices[0]) < 0)
+		Vec2 nearestEdge = simplex[1] - simplex[0];
+		if (CrossProduct2D(nearestEdge, -simplex[0]) < 0)
 		{
 			direction = nearestEdge.GetRotatedMinus90Degrees().GetNormalized();
 		}
@@ -1168,111 +1372,197 @@ bool IsPolygonIntersectWithOtherPolygon(Polygon2D const& polygonA, Polygon2D con
 		{
 			direction = nearestEdge.GetRotated90Degrees().GetNormalized();
 		}
-		Vec2 newVert = polygonA.GetSupport(direction) - polygonB.GetSupport(-direction);
+		Vec2 newVert = GetSupportOfMinkowskiDifference(pointsA, countA, pointsB, countB, direction);
 		if (!IsPointPassedOrigin(newVert, direction))
 		{
 			return false;
 		}
-		vertices.push_back(newVert);
+		simplex[2] = newVert;
 	}
-	return true;
+	//still cycling, the origin sits on the boundary and the shapes only touch
+	return false;
 }
 
-Vec2 GetContactNormalOfTwoPolygons(Polygon2D const& polygonA, Polygon2D const& polygonB)
+bool IsPolygonIntersectWithOtherPolygon(Polygon2D const& polygonA, Polygon2D const& polygonB)
 {
-	Vec2 direction = polygonB.GetCenter() - polygonA.GetCenter();
-	Vec2 vert1 = polygonA.GetSupport(direction) - polygonB.GetSupport(-direction);
-	Vec2 vert2 = polygonA.GetSupport(-direction) - polygonB.GetSupport(direction);
-	Vec2 vert1ToVert2 = (vert2 - vert1).GetNormalized();
-	Vec2 vert1ToOrigin = (-vert1).GetNormalized();
-	Vec2 normalDirection = TripleCrossProduct((vert1 - vert2), -vert2, (vert1 - vert2));
-	Vec2 vert3 = polygonA.GetSupport(normalDirection) - polygonB.GetSupport(-normalDirection);
+	std::vector<Vec2> const& pointsA = polygonA.GetPoints();
+	std::vector<Vec2> const& pointsB = polygonB.GetPoints();
+	return IsPolygonIntersectWithOtherPolygon(pointsA.data(), (int)pointsA.size(), polygonA.GetCenter(),
+		pointsB.data(), (int)pointsB.size(), polygonB.GetCenter());
+}
 
-	//Make simplex(polygon)
-	std::vector<Vec2> vertices;
-	vertices.push_back(vert1);
-	vertices.push_back(vert2);
-	vertices.push_back(vert3);
-	while (!IsOriginInsideTriangle(vertices[0], vertices[1], vertices[2]))
-	{
-		Vec2 vertA = vertices[0];
-		Vec2 vertB = vertices[1];
-		Vec2 vertC = vertices[2];
+bool IsPolygonIntersectWithOtherPolygon(Vec2 const* pointsA, int countA, const Vec2& centerA, Vec2 const* pointsB, int countB, const Vec2& centerB)
+{
+	Vec2 simplex[3];
+	return RunGJK(pointsA, countA, centerA, pointsB, countB, centerB, simplex);
+}
 
-		Vec2 pointNotOnNearestEdge =
-			GetPointOfTriangleNotOnClosestEdgeOfPoint(vertA, vertB, vertC, Vec2::ZERO);
+Vec2 GetContactNormalOfTwoPolygons(Polygon2D const& polygonA, Polygon2D const& polygonB)
+{
+	std::vector<Vec2> const& pointsA = polygonA.GetPoints();
+	std::vector<Vec2> const& pointsB = polygonB.GetPoints();
+	Vec2 normal;
+	float depth = 0.f;
+	Segment2D contactEdge(Vec2::ZERO, Vec2::ZERO);
+	GetPolygonContact(pointsA.data(), (int)pointsA.size(), polygonA.GetCenter(),
+		pointsB.data(), (int)pointsB.size(), polygonB.GetCenter(), normal, depth, contactEdge);
+	return normal * -depth;
+}
+
+bool GetPolygonContact(Vec2 const* pointsA, int countA, const Vec2& centerA, Vec2 const* pointsB, int countB, const Vec2& centerB,
+	Vec2& outNormal, float& outDepth, Segment2D& outContactEdge)
+{
+	outNormal = Vec2::ZERO;
+	outDepth = 0.f;
+	outContactEdge = Segment2D(Vec2::ZERO, Vec2::ZERO);
 
-		if (pointNotOnNearestEdge == vertA)
+	Vec2 polytope[EPA_MAX_VERTICES];
+	if (!RunGJK(pointsA, countA, centerA, pointsB, countB, centerB, polytope))
+	{
+		return false;
+	}
+	//Make sure triangle is counter clockwise
+	bool isCounterClockwise = true;
+	for (int vertexIndex = 0; vertexIndex < 3; ++vertexIndex)
+	{
+		Vec2 const& vertex0 = polytope[vertexIndex];
+		Vec2 const& vertex1 = polytope[(vertexIndex + 1) % 3];
+		Vec2 const& vertex2 = polytope[(vertexIndex + 2) % 3];
+		if (CrossProduct2D(vertex1 - vertex0, vertex2 - vertex1) < 0)
 		{
-			vertices.erase(vertices.begin());
+			isCounterClockwise = false;
 		}
-		else if (pointNotOnNearestEdge == vertB)
+	}
+	if (!isCounterClockwise)
+	{
+		std::swap(polytope[1], polytope[2]);
+	}
+	//expand the polytope towards its closest face until the face is on the Minkowski boundary,
+	//faces are judged by their normals, the clamped nearest point can stop on a vertex of a wrong face
+	int numVertices = 3;
+	Vec2 closestNormal = Vec2::ZERO;
+	float closestDistance = 0.f;
+	for (int iteration = 0; iteration < EPA_MAX_ITERATIONS; ++iteration)
+	{
+		int closestEdgeIndex = 0;
+		closestDistance = INFINITY;
+		for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
 		{
-			vertices.erase(vertices.begin() + 1);
+			Vec2 edgeStart = polytope[vertexIndex];
+			Vec2 edgeEnd = polytope[(vertexIndex + 1) % numVertices];
+			//counter clockwise, so the right hand normal points away from the origin
+			Vec2 normal = (edgeEnd - edgeStart).GetRotatedMinus90Degrees().GetNormalized();
+			float distance = DotProduct2D(normal, edgeStart);
+			if (distance < closestDistance)
+			{
+				closestDistance = distance;
+				closestNormal = normal;
+				closestEdgeIndex = vertexIndex + 1;
+			}
 		}
-		else
+
+		Vec2 newVert = GetSupportOfMinkowskiDifference(pointsA, countA, pointsB, countB, closestNormal);
+		if (DotProduct2D(newVert, closestNormal) - closestDistance < 0.0001f)
 		{
-			vertices.erase(vertices.begin() + 2);
+			break;
 		}
-
-		Vec2 nearestEdge = vertices[1] - vertices[0];
-		if (CrossProduct2D(nearestEdge, -vertices[0]) < 0)
+		for (int vertexIndex = numVertices; vertexIndex > closestEdgeIndex; --vertexIndex)
 		{
-			direction = nearestEdge.GetRotatedMinus90Degrees().GetNormalized();
+			polytope[vertexIndex] = polytope[vertexIndex - 1];
 		}
-		else
+		polytope[closestEdgeIndex] = newVert;
+		++numVertices;
+	}
+	if (closestDistance <= 0.f)
+	{
+		//origin on (or rounding just outside) the boundary, touching only
+		return true;
+	}
+	Vec2 contactNormal = closestNormal * -closestDistance;
+	outDepth = contactNormal.GetLength();
+	contactNormal.Normalize();
+	outNormal = contactNormal;
+
+	//Reference face of B, every vertex of B within the tolerance of its supporting plane
+	Vec2 p = GetSupportOfPolygon(pointsB, countB, contactNormal);
+	Plane2D R = Plane2D(contactNormal, p);
+	Vec2 tMax = contactNormal.GetRotated90Degrees();
+	float refMin = INFINITY;
+	float refMax = -INFINITY;
+	Vec2 edgeMax = p;
+	Vec2 edgeMin = p;
+	for (int verticesIndex = 0; verticesIndex < countB; ++verticesIndex)
+	{
+		if (R.GetDistance(pointsB[verticesIndex]) >= 0.01f)
 		{
-			direction = nearestEdge.GetRotated90Degrees().GetNormalized();
+			continue;
 		}
-		Vec2 newVert = polygonA.GetSupport(direction) - polygonB.GetSupport(-direction);
-		if (!IsPointPassedOrigin(newVert, direction))
+		float distanceOnEdge = DotProduct2D(tMax, pointsB[verticesIndex]);
+		if (distanceOnEdge > refMax)
 		{
-			return Vec2::ZERO;//no contact point
+			refMax = distanceOnEdge;
+			edgeMax = pointsB[verticesIndex];
+		}
+
+		if (distanceOnEdge < refMin)
+		{
+			refMin = distanceOnEdge;
+			edgeMin = pointsB[verticesIndex];
 		}
-		vertices.push_back(newVert);
 	}
-	//Make sure triangle is counter clockwise
-	if (!IsPolygon2DConvex(vertices))
+	if (edgeMax == edgeMin)
 	{
-		vertices.push_back(vertices[1]);
-		vertices.erase(vertices.begin() + 1);
+		outContactEdge = Segment2D(edgeMax, edgeMin);
+		return true;
 	}
-	while (1)
+	Segment2D refEdge(edgeMin, edgeMax);
+
+	//points of A just in front of the face count too, otherwise a face that is barely touching
+	//reports no points and falls back to a single corner, which tips resting boxes over
+	float const contactTolerance = 0.01f;
+	float min = INFINITY;
+	float max = -INFINITY;
+	//no vertex of A behind the reference face falls back to the deepest point of B
+	Vec2 contactMax = p;
+	Vec2 contactMin = p;
+	auto addContactPoint = [&](Vec2 const& point)
 	{
-		Vec2 nearestPoint = GetNearestPointOnLineSegment2D(Vec2::ZERO, vertices[vertices.size() - 1], vertices[0]);
-		float shortestDistance = GetDistance2D(nearestPoint, Vec2::ZERO);
-		int shortestEdgeIndex = 0;
-		for (int vertexIndex = 0; vertexIndex < vertices.size() - 1; ++vertexIndex)
+		if (R.GetSignedDistanceFromPlane(point) >= contactTolerance)
 		{
-			Vec2 currPoint = GetNearestPointOnLineSegment2D(Vec2::ZERO, vertices[vertexIndex], vertices[vertexIndex + 1]);
-			float distance = GetDistance2D(currPoint, Vec2::ZERO);
-			if (distance < shortestDistance)
-			{
-				shortestDistance = distance;
-				nearestPoint = currPoint;
-				shortestEdgeIndex = vertexIndex + 1;
-			}
+			return;
 		}
-		//get direction and new vert
-		
-		Vec2 splitDirection = nearestPoint.GetNormalized();
-		Vec2 newVert = polygonA.GetSupport(splitDirection) - polygonB.GetSupport(-splitDirection);
-		int startIndex = shortestEdgeIndex - 1;
-		if (startIndex == -1)
+		float distanceOnEdge = DotProduct2D(tMax, point);
+		//edges of A that miss the reference face entirely come back unclipped
+		if (distanceOnEdge < refMin - 0.01f || distanceOnEdge > refMax + 0.01f)
 		{
-			startIndex = (int)vertices.size() - 1;
+			return;
+		}
+		if (distanceOnEdge > max)
+		{
+			max = distanceOnEdge;
+			contactMax = point;
 		}
-		Vec2 edgeStart = vertices[startIndex];
-		Vec2 edgeEnd = vertices[shortestEdgeIndex];
 
-		//If cannot split, normal is found
-		if (GetDistance2D(newVert, edgeStart) < 0.01f ||
-			GetDistance2D(newVert, edgeEnd) < 0.01f)
+		if (distanceOnEdge < min)
 		{
-			return splitDirection * shortestDistance;
+			min = distanceOnEdge;
+			contactMin = point;
+		}
+	};
+	//edges of A starting with the closing one
+	for (int edgeIndex = 0; edgeIndex < countA; ++edgeIndex)
+	{
+		Segment2D edgeA(pointsA[(edgeIndex + countA - 1) % countA], pointsA[edgeIndex]);
+		if (R.GetSignedDistanceFromPlane(edgeA.pointA) < contactTolerance ||
+			R.GetSignedDistanceFromPlane(edgeA.pointB) < contactTolerance)
+		{
+			Segment2D clipedEdgeA = ClipSegmentToSegment(edgeA, refEdge);
+			addContactPoint(clipedEdgeA.pointA);
+			addContactPoint(clipedEdgeA.pointB);
 		}
-		vertices.insert(vertices.begin() + shortestEdgeIndex, newVert);
 	}
+	outContactEdge = Segment2D(contactMin, contactMax);
+	return true;
 }
 
 float SmoothStart2(float t)
@@ -36,6 +36,8 @@ float	GetDistanceXYSquared3D( const Vec3& positionA, const Vec3& positionB );
 bool	DoDiscsOverlap(const Vec2& centerA, float radiusA, const Vec2& centerB, float radiusB);
 bool	DoDiscsContains(const Vec2& centerInner, float radiusInner, const Vec2& centerOuter, float radiusOuter);
 bool	DoSpheresOverlap(const Vec3& centerA, float radiusA, const Vec3& centerB, float radiusB);
+bool	DoAABBsOverlap2D(const AABB2& boxA, const AABB2& boxB);
+bool	DoesAABBContainAABB2D(const AABB2& outerBox, const AABB2& innerBox);
 
 bool	DoPolygonPlaneOverlap(const Polygon2D& polygon, const Plane2D& plane);
 bool	DoDiscPlaneOverlap(const Vec2& center, float radius, const Plane2D& plane);
@@ -93,14 +95,25 @@ const Vec2 GetNearestPointOnCapsule2D(const Vec2& point, const Vec2& capsuleMidS
 const Vec2 GetNearestPointOnOBB2D(const Vec2& point, const OBB2& box);
 const Vec2 GetNearestPointOnPolygon2D(const Vec2& point, std::vector<Vec2> const& polygon);
 const Vec2 GetNearestPointOnPolygon2DEdge(const Vec2& point, std::vector<Vec2> const& polygon);
+const Vec2 GetNearestPointOnPolygon2DEdge(const Vec2& point, Vec2 const* polygon, int pointCount);
 
 void	GetIntersectPointsBetweenSegementsAndDisc(const Vec2& start, const Vec2& end, const Vec2& m_center, float radius, Vec2& pointA, Vec2& pointB);
+//Raycasts take a normalized direction and report the distance along it. A ray that starts inside the shape hits it
+//at distance 0 with the normal facing back along the ray. Polygons are counter clockwise with normals[i] facing out of edge i -> i + 1
+bool	RaycastVsAABB2D(const Vec2& start, const Vec2& direction, float maxDistance, const AABB2& box, float& outDistance);
+bool	RaycastVsDisc2D(const Vec2& start, const Vec2& direction, float maxDistance, const Vec2& center, float radius, float& outDistance, Vec2& outNormal);
+bool	RaycastVsPolygon2D(const Vec2& start, const Vec2& direction, float maxDistance, Vec2 const* points, Vec2 const* normals, int pointCount,
+	float& outDistance, Vec2& outNormal);
+//Moves a disc along the ray until it touches the polygon, outDistance is how far its center got
+bool	DiscCastVsPolygon2D(const Vec2& start, float radius, const Vec2& direction, float maxDistance, Vec2 const* points, Vec2 const* normals, int pointCount,
+	float& outDistance, Vec2& outNormal);
 
 bool	IsPointInsideDisk2D(const Vec2& point, const Vec2& discCenter, float discRadius);
 bool	IsPointInsideAABB2D(const Vec2& point, const AABB2& box);
 bool	IsPointInsideCapsule2D(const Vec2& point, const Vec2& capsuleMidStart, const Vec2& capsuleMidEnd, float capsuleRadius);
 bool	IsPointInsideOBB2D(const Vec2& point, const OBB2& box);
 bool    IsPointInsidePolygon2D(const Vec2& point, std::vector<Vec2> const& polygon);
+bool    IsPointInsidePolygon2D(const Vec2& point, Vec2 const* polygon, int pointCount);
 bool    IsOriginInsideTriangle(const Vec2& pointA, const Vec2& pointB, const Vec2& pointC);
 void	PushDiscOutOfDisc2D(Vec2& centerMobile, float radiusMobile, const Vec2& centerFixed, float radiusFixed);
 void	PushDiscsOutOfEachOther2D(Vec2& centerA, float radiusA, Vec2& centerB, float radiusB, float massRatioA = 0.5f);
@@ -123,9 +136,15 @@ Disc2 GetDiscFromTwoPoints(const Vec2& pointA, const Vec2& pointB);
 Disc2 GetTightBoundDiscOfPolygon(std::vector<Vec2> const& polygon);
 Vec2 GetCenterOfMassOfPolygon(std::vector<Vec2> const& polygon);
 Vec2 GetSupportOfPolygon(std::vector<Vec2> const& polygon, const Vec2& direction);
+Vec2 GetSupportOfPolygon(Vec2 const* points, int pointCount, const Vec2& direction);
 bool IsPointPassedOrigin(const Vec2& point, const Vec2& direction);
 bool IsPolygonIntersectWithOtherPolygon(Polygon2D const& polygonA, Polygon2D const& polygonB);
+bool IsPolygonIntersectWithOtherPolygon(Vec2 const* pointsA, int countA, const Vec2& centerA, Vec2 const* pointsB, int countB, const Vec2& centerB);
 Vec2 GetContactNormalOfTwoPolygons(Polygon2D const& polygonA, Polygon2D const& polygonB);
+//GJK and EPA on counter clockwise convex polygons in one pass, nothing is allocated. Returns whether they overlap,
+//outNormal pushes A out of B and outContactEdge lies on B's face, all three stay zero when the shapes only touch
+bool GetPolygonContact(Vec2 const* pointsA, int countA, const Vec2& centerA, Vec2 const* pointsB, int countB, const Vec2& centerB,
+	Vec2& outNormal, float& outDepth, Segment2D& outContactEdge);
 Vec2 GetPointOfTriangleNotOnClosestEdgeOfPoint(const Vec2& pointA, const Vec2& pointB, const Vec2& pointC, const Vec2& point);
 Segment2D ClipSegmentToSegment(Segment2D const& toClip, Segment2D const& refEdge);
 
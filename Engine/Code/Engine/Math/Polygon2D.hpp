@@ -17,7 +17,7 @@ public:
 	void GetEdge(int idx, Vec2& outStart, Vec2& outEnd);
 	Vec2 GetCenter() const { return m_center; }
 	void SetCenter(Vec2 center) { m_center = center; }
-	std::vector<Vec2> GetPoints() const { return m_points; }
+	std::vector<Vec2> const& GetPoints() const { return m_points; }
 	void Translate(Vec2 diff);
 	void TranslateTo(Vec2 dest);
 	void Rotate(float rotationDegrees);
@@ -385,23 +385,26 @@ std::uint16_t ConnectionState::s_sequenceNumber;
 
 ConnectionState::~ConnectionState()
 {
-	m_isQuitting = true;
 	if (m_UDPSocket)
 	{
+		//the writer sends what is still queued before it sees the closed queue, so it stops first while the socket is open
+		m_sendQueue.close();
+		m_writeThread->join();
+		delete m_writeThread;
+		m_writeThread = nullptr;
+
+		m_isQuitting = true;
 		g_theConsole->PrintString(Rgba8::WHITE, Stringf("Closing UDP socket..."));
 		m_UDPSocket->close();
-		delete m_UDPSocket;
-		m_UDPSocket = nullptr;
 
 		m_readThread->join();
 		delete m_readThread;
 		m_readThread = nullptr;
 
-		m_sendQueue.notify_all();
-		m_writeThread->join();
-		delete m_writeThread;
-		m_writeThread = nullptr;
+		delete m_UDPSocket;
+		m_UDPSocket = nullptr;
 	}
+	m_isQuitting = true;
 }
 
 void ConnectionState::ReceiveFromReceiveQueue()
@@ -496,7 +499,7 @@ void ConnectionState::ReceiveFromReceiveQueue()
 
 void ConnectionState::PushToWriteQueue(UDPMessage message)
 {
-	m_sendQueue.push(message);
+	m_sendQueue.push(std::move(message));
 }
 
 void ConnectionState::SendUDPMessage(std::string message, std::uint32_t magicNumber, std::uint16_t id, std::uint16_t numMsg)
@@ -561,8 +564,7 @@ void ConnectionState::ReadThreadMain()
 			if (pMsg->length > 0)
 			{
 				dataStr = &buffer[sizeof(UDPMessageHeader)];
-				UDPMessage message = std::make_tuple(pMsg->id, pMsg->magicNumber, pMsg->length, pMsg->seqNo, pMsg->numMsg, dataStr);
-				m_receiveQueue.push(message);
+				m_receiveQueue.try_emplace(pMsg->id, pMsg->magicNumber, pMsg->length, pMsg->seqNo, pMsg->numMsg, std::move(dataStr));
 			}
 		}
 	}
@@ -570,15 +572,28 @@ void ConnectionState::ReadThreadMain()
 
 void ConnectionState::WriteThreadMain()
 {
+	const size_t maxMessagesPerWake = 64;
+	std::vector<UDPMessage> pendingMessages;
+	pendingMessages.reserve(maxMessagesPerWake);
 	while (!m_isQuitting)
 	{
 		if (!m_UDPSocket)
 		{
 			continue;
 		}
-		UDPMessage message = m_sendQueue.pop();
-		while (std::get<5>(message).size() > 0)
+		//take everything queued since the last wake in one go, returns 0 once the queue is closed
+		pendingMessages.clear();
+		if (m_sendQueue.drain(pendingMessages, maxMessagesPerWake) == 0)
 		{
+			break;
+		}
+		for (int messageIndex = 0; messageIndex < (int)pendingMessages.size(); ++messageIndex)
+		{
+			UDPMessage const& message = pendingMessages[messageIndex];
+			if (std::get<5>(message).size() == 0)
+			{
+				continue;
+			}
 			UDPMessageHeader header;
 			header.id = std::get<0>(message);
 			header.magicNumber = std::get<1>(message);
@@ -594,7 +609,6 @@ void ConnectionState::WriteThreadMain()
 			m_UDPSocket->sendBuffer()[sizeof(UDPMessageHeader) + header.length] = NULL;
 
 			m_UDPSocket->send(sizeof(UDPMessageHeader) + header.length + 1);
-			message = m_sendQueue.pop();
 		}
 	}
 }
\ No newline at end of file
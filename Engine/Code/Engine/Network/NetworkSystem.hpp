@@ -9,7 +9,7 @@
 #include <WinSock2.h>
 #include <WS2tcpip.h>
 #include "Engine/Core/SynchronizedBlockingQueue.hpp"
-#include "Engine/Core/SynchronizedNonBlockingQueue.hpp"
+#include "Engine/Core/SPSCRing.hpp"
 
 class TCPServer;
 class TCPClient;
@@ -54,9 +54,9 @@ public:
 	void WriteThreadMain();
 public:
 	UDPSocket* m_UDPSocket = nullptr;
-	//SNQ for receive
-	SynchronizedNonblockingQueue<UDPMessage> m_receiveQueue;
-	//SBQ for sending
+	//read thread to main thread, datagrams are dropped while it is full
+	SPSCRing<UDPMessage> m_receiveQueue;
+	//SBQ for sending, the write thread sleeps on it while there is nothing to send
 	SynchronizedBlockingQueue<UDPMessage> m_sendQueue;
 
 	std::vector<UDPMessage> m_reliableMap;
@@ -0,0 +1,312 @@
+#include "Engine/Physics/AABBTree2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+
+static AABB2 GetUnion(AABB2 const& boxA, AABB2 const& boxB)
+{
+	AABB2 unionBox;
+	unionBox.mins = Vec2(std::min(boxA.mins.x, boxB.mins.x), std::min(boxA.mins.y, boxB.mins.y));
+	unionBox.maxs = Vec2(std::max(boxA.maxs.x, boxB.maxs.x), std::max(boxA.maxs.y, boxB.maxs.y));
+	return unionBox;
+}
+
+static float GetPerimeter(AABB2 const& box)
+{
+	return 2.f * ((box.maxs.x - box.mins.x) + (box.maxs.y - box.mins.y));
+}
+
+AABBTree2D::AABBTree2D(float fatMargin)
+	: m_fatMargin(fatMargin)
+{}
+
+int AABBTree2D::CreateProxy(AABB2 const& bounds, void* userData)
+{
+	int proxyID = AllocateNode();
+	AABBTreeNode2D& node = m_nodes[proxyID];
+	node.m_bounds.mins = bounds.mins - Vec2(m_fatMargin, m_fatMargin);
+	node.m_bounds.maxs = bounds.maxs + Vec2(m_fatMargin, m_fatMargin);
+	node.m_userData = userData;
+	node.m_height = 0;
+	InsertLeaf(proxyID);
+	++m_proxyCount;
+	return proxyID;
+}
+
+void AABBTree2D::DestroyProxy(int proxyID)
+{
+	RemoveLeaf(proxyID);
+	FreeNode(proxyID);
+	--m_proxyCount;
+}
+
+bool AABBTree2D::MoveProxy(int proxyID, AABB2 const& bounds)
+{
+	if (DoesAABBContainAABB2D(m_nodes[proxyID].m_bounds, bounds))
+	{
+		return false;
+	}
+	RemoveLeaf(proxyID);
+	AABBTreeNode2D& node = m_nodes[proxyID];
+	node.m_bounds.mins = bounds.mins - Vec2(m_fatMargin, m_fatMargin);
+	node.m_bounds.maxs = bounds.maxs + Vec2(m_fatMargin, m_fatMargin);
+	InsertLeaf(proxyID);
+	return true;
+}
+
+int AABBTree2D::GetHeight() const
+{
+	return (m_root == -1) ? 0 : m_nodes[m_root].m_height;
+}
+
+int AABBTree2D::AllocateNode()
+{
+	if (m_freeList == -1)
+	{
+		m_nodes.emplace_back();
+		return (int)m_nodes.size() - 1;
+	}
+	int nodeIndex = m_freeList;
+	m_freeList = m_nodes[nodeIndex].m_parent;
+	m_nodes[nodeIndex] = AABBTreeNode2D();
+	return nodeIndex;
+}
+
+void AABBTree2D::FreeNode(int nodeIndex)
+{
+	AABBTreeNode2D& node = m_nodes[nodeIndex];
+	node.m_parent = m_freeList;
+	node.m_child0 = -1;
+	node.m_child1 = -1;
+	node.m_height = -1;
+	node.m_userData = nullptr;
+	m_freeList = nodeIndex;
+}
+
+void AABBTree2D::InsertLeaf(int leafIndex)
+{
+	if (m_root == -1)
+	{
+		m_root = leafIndex;
+		m_nodes[leafIndex].m_parent = -1;
+		return;
+	}
+
+	//walk down towards the sibling that grows the total perimeter the least
+	AABB2 leafBounds = m_nodes[leafIndex].m_bounds;
+	int nodeIndex = m_root;
+	while (!m_nodes[nodeIndex].IsLeaf())
+	{
+		AABBTreeNode2D const& node = m_nodes[nodeIndex];
+		float perimeter = GetPerimeter(node.m_bounds);
+		float combinedPerimeter = GetPerimeter(GetUnion(node.m_bounds, leafBounds));
+		//cost of making a new parent for this node and the leaf
+		float cost = 2.f * combinedPerimeter;
+		//every ancestor below this point grows by this much if we keep descending
+		float inheritanceCost = 2.f * (combinedPerimeter - perimeter);
+
+		float childCosts[2];
+		int children[2] = { node.m_child0, node.m_child1 };
+		for (int childIndex = 0; childIndex < 2; ++childIndex)
+		{
+			AABBTreeNode2D const& child = m_nodes[children[childIndex]];
+			float childCombinedPerimeter = GetPerimeter(GetUnion(child.m_bounds, leafBounds));
+			if (child.IsLeaf())
+			{
+				childCosts[childIndex] = childCombinedPerimeter + inheritanceCost;
+			}
+			else
+			{
+				childCosts[childIndex] = childCombinedPerimeter - GetPerimeter(child.m_bounds) + inheritanceCost;
+			}
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+		{
+			break;
+		}
+		nodeIndex = (childCosts[0] < childCosts[1]) ? children[0] : children[1];
+	}
+
+	int siblingIndex = nodeIndex;
+	int oldParentIndex = m_nodes[siblingIndex].m_parent;
+	int newParentIndex = AllocateNode();
+	AABBTreeNode2D& newParent = m_nodes[newParentIndex];
+	newParent.m_parent = oldParentIndex;
+	newParent.m_bounds = GetUnion(leafBounds, m_nodes[siblingIndex].m_bounds);
+	newParent.m_height = m_nodes[siblingIndex].m_height + 1;
+	newParent.m_child0 = siblingIndex;
+	newParent.m_child1 = leafIndex;
+	m_nodes[siblingIndex].m_parent = newParentIndex;
+	m_nodes[leafIndex].m_parent = newParentIndex;
+
+	if (oldParentIndex == -1)
+	{
+		m_root = newParentIndex;
+	}
+	else if (m_nodes[oldParentIndex].m_child0 == siblingIndex)
+	{
+		m_nodes[oldParentIndex].m_child0 = newParentIndex;
+	}
+	else
+	{
+		m_nodes[oldParentIndex].m_child1 = newParentIndex;
+	}
+	RefitAncestors(newParentIndex);
+}
+
+void AABBTree2D::RemoveLeaf(int leafIndex)
+{
+	if (leafIndex == m_root)
+	{
+		m_root = -1;
+		return;
+	}
+
+	int parentIndex = m_nodes[leafIndex].m_parent;
+	int grandParentIndex = m_nodes[parentIndex].m_parent;
+	int siblingIndex = (m_nodes[parentIndex].m_child0 == leafIndex) ? m_nodes[parentIndex].m_child1 : m_nodes[parentIndex].m_child0;
+
+	//the sibling takes the parent's place
+	m_nodes[siblingIndex].m_parent = grandParentIndex;
+	if (grandParentIndex == -1)
+	{
+		m_root = siblingIndex;
+	}
+	else if (m_nodes[grandParentIndex].m_child0 == parentIndex)
+	{
+		m_nodes[grandParentIndex].m_child0 = siblingIndex;
+	}
+	else
+	{
+		m_nodes[grandParentIndex].m_child1 = siblingIndex;
+	}
+	FreeNode(parentIndex);
+	m_nodes[leafIndex].m_parent = -1;
+	RefitAncestors(grandParentIndex);
+}
+
+void AABBTree2D::RefitAncestors(int nodeIndex)
+{
+	while (nodeIndex != -1)
+	{
+		nodeIndex = Balance(nodeIndex);
+		AABBTreeNode2D& node = m_nodes[nodeIndex];
+		AABBTreeNode2D const& child0 = m_nodes[node.m_child0];
+		AABBTreeNode2D const& child1 = m_nodes[node.m_child1];
+		node.m_height = 1 + std::max(child0.m_height, child1.m_height);
+		node.m_bounds = GetUnion(child0.m_bounds, child1.m_bounds);
+		nodeIndex = node.m_parent;
+	}
+}
+
+//Rotates the taller grandchild up when one side of nodeA is more than one level deeper than the other.
+//Returns the node now sitting where nodeA was.
+int AABBTree2D::Balance(int indexA)
+{
+	AABBTreeNode2D& nodeA = m_nodes[indexA];
+	if (nodeA.IsLeaf() || nodeA.m_height < 2)
+	{
+		return indexA;
+	}
+
+	int indexB = nodeA.m_child0;
+	int indexC = nodeA.m_child1;
+	AABBTreeNode2D& nodeB = m_nodes[indexB];
+	AABBTreeNode2D& nodeC = m_nodes[indexC];
+	int balance = nodeC.m_height - nodeB.m_height;
+
+	if (balance > 1)
+	{
+		//promote C
+		int indexF = nodeC.m_child0;
+		int indexG = nodeC.m_child1;
+		AABBTreeNode2D& nodeF = m_nodes[indexF];
+		AABBTreeNode2D& nodeG = m_nodes[indexG];
+
+		nodeC.m_child0 = indexA;
+		nodeC.m_parent = nodeA.m_parent;
+		nodeA.m_parent = indexC;
+		if (nodeC.m_parent == -1)
+		{
+			m_root = indexC;
+		}
+		else if (m_nodes[nodeC.m_parent].m_child0 == indexA)
+		{
+			m_nodes[nodeC.m_parent].m_child0 = indexC;
+		}
+		else
+		{
+			m_nodes[nodeC.m_parent].m_child1 = indexC;
+		}
+
+		if (nodeF.m_height > nodeG.m_height)
+		{
+			nodeC.m_child1 = indexF;
+			nodeA.m_child1 = indexG;
+			nodeG.m_parent = indexA;
+			nodeA.m_bounds = GetUnion(nodeB.m_bounds, nodeG.m_bounds);
+			nodeC.m_bounds = GetUnion(nodeA.m_bounds, nodeF.m_bounds);
+			nodeA.m_height = 1 + std::max(nodeB.m_height, nodeG.m_height);
+			nodeC.m_height = 1 + std::max(nodeA.m_height, nodeF.m_height);
+		}
+		else
+		{
+			nodeC.m_child1 = indexG;
+			nodeA.m_child1 = indexF;
+			nodeF.m_parent = indexA;
+			nodeA.m_bounds = GetUnion(nodeB.m_bounds, nodeF.m_bounds);
+			nodeC.m_bounds = GetUnion(nodeA.m_bounds, nodeG.m_bounds);
+			nodeA.m_height = 1 + std::max(nodeB.m_height, nodeF.m_height);
+			nodeC.m_height = 1 + std::max(nodeA.m_height, nodeG.m_height);
+		}
+		return indexC;
+	}
+
+	if (balance < -1)
+	{
+		//promote B
+		int indexD = nodeB.m_child0;
+		int indexE = nodeB.m_child1;
+		AABBTreeNode2D& nodeD = m_nodes[indexD];
+		AABBTreeNode2D& nodeE = m_nodes[indexE];
+
+		nodeB.m_child0 = indexA;
+		nodeB.m_parent = nodeA.m_parent;
+		nodeA.m_parent = indexB;
+		if (nodeB.m_parent == -1)
+		{
+			m_root = indexB;
+		}
+		else if (m_nodes[nodeB.m_parent].m_child0 == indexA)
+		{
+			m_nodes[nodeB.m_parent].m_child0 = indexB;
+		}
+		else
+		{
+			m_nodes[nodeB.m_parent].m_child1 = indexB;
+		}
+
+		if (nodeD.m_height > nodeE.m_height)
+		{
+			nodeB.m_child1 = indexD;
+			nodeA.m_child0 = indexE;
+			nodeE.m_parent = indexA;
+			nodeA.m_bounds = GetUnion(nodeC.m_bounds, nodeE.m_bounds);
+			nodeB.m_bounds = GetUnion(nodeA.m_bounds, nodeD.m_bounds);
+			nodeA.m_height = 1 + std::max(nodeC.m_height, nodeE.m_height);
+			nodeB.m_height = 1 + std::max(nodeA.m_height, nodeD.m_height);
+		}
+		else
+		{
+			nodeB.m_child1 = indexE;
+			nodeA.m_child0 = indexD;
+			nodeD.m_parent = indexA;
+			nodeA.m_bounds = GetUnion(nodeC.m_bounds, nodeD.m_bounds);
+			nodeB.m_bounds = GetUnion(nodeA.m_bounds, nodeE.m_bounds);
+			nodeA.m_height = 1 + std::max(nodeC.m_height, nodeD.m_height);
+			nodeB.m_height = 1 + std::max(nodeA.m_height, nodeE.m_height);
+		}
+		return indexB;
+	}
+	return indexA;
+}
@@ -0,0 +1,202 @@
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <vector>
+
+struct AABBTreeNode2D
+{
+public:
+	bool IsLeaf() const { return m_child0 == -1; }
+public:
+	AABB2 m_bounds;				//fattened for leaves
+	void* m_userData = nullptr;
+	int m_parent = -1;			//next free node while the node is unused
+	int m_child0 = -1;
+	int m_child1 = -1;
+	int m_height = -1;			//0 for leaves, -1 for free nodes
+};
+
+//Dynamic bounding volume tree. Leaves store bounds grown by a margin, so a body only has to be
+//reinserted once it leaves its fat box instead of every time it moves.
+class AABBTree2D
+{
+public:
+	explicit AABBTree2D(float fatMargin = 0.1f);
+	~AABBTree2D() = default;
+
+	int CreateProxy(AABB2 const& bounds, void* userData);
+	void DestroyProxy(int proxyID);
+	//Returns true if the proxy had to be reinserted
+	bool MoveProxy(int proxyID, AABB2 const& bounds);
+
+	void* GetUserData(int proxyID) const { return m_nodes[proxyID].m_userData; }
+	AABB2 const& GetFatBounds(int proxyID) const { return m_nodes[proxyID].m_bounds; }
+	int GetHeight() const;
+	int GetProxyCount() const { return m_proxyCount; }
+	size_t GetMemoryUsage() const { return m_nodes.capacity() * sizeof(AABBTreeNode2D); }
+
+	//Calls callback(proxyID) for every leaf whose fat bounds overlap bounds. Stops early if it returns false.
+	template<typename QUERY_CALLBACK>
+	void Query(AABB2 const& bounds, QUERY_CALLBACK&& callback) const;
+	//Calls callback(proxyID, maxDistance) for every leaf whose fat bounds grown by radius the ray reaches within maxDistance,
+	//callback returns the distance the rest of the traversal is clipped to. direction is normalized.
+	template<typename RAYCAST_CALLBACK>
+	void RayCast(Vec2 const& start, Vec2 const& direction, float maxDistance, float radius, RAYCAST_CALLBACK&& callback) const;
+
+private:
+	int AllocateNode();
+	void FreeNode(int nodeIndex);
+	void InsertLeaf(int leafIndex);
+	void RemoveLeaf(int leafIndex);
+	int Balance(int nodeIndex);
+	void RefitAncestors(int nodeIndex);
+
+private:
+	std::vector<AABBTreeNode2D> m_nodes;
+	int m_root = -1;
+	int m_freeList = -1;
+	int m_proxyCount = 0;
+	float m_fatMargin = 0.1f;
+};
+
+template<typename QUERY_CALLBACK>
+void AABBTree2D::Query(AABB2 const& bounds, QUERY_CALLBACK&& callback) const
+{
+	if (m_root == -1)
+	{
+		return;
+	}
+	//balanced trees stay far below this depth, the vector only takes over for degenerate ones
+	int localStack[256];
+	std::vector<int> overflowStack;
+	int stackSize = 0;
+	localStack[stackSize++] = m_root;
+	while (stackSize > 0 || !overflowStack.empty())
+	{
+		int nodeIndex = 0;
+		if (!overflowStack.empty())
+		{
+			nodeIndex = overflowStack.back();
+			overflowStack.pop_back();
+		}
+		else
+		{
+			nodeIndex = localStack[--stackSize];
+		}
+		AABBTreeNode2D const& node = m_nodes[nodeIndex];
+		if (!DoAABBsOverlap2D(node.m_bounds, bounds))
+		{
+			continue;
+		}
+		if (node.IsLeaf())
+		{
+			if (!callback(nodeIndex))
+			{
+				return;
+			}
+			continue;
+		}
+		if (stackSize + 2 <= 256)
+		{
+			localStack[stackSize++] = node.m_child0;
+			localStack[stackSize++] = node.m_child1;
+		}
+		else
+		{
+			overflowStack.push_back(node.m_child0);
+			overflowStack.push_back(node.m_child1);
+		}
+	}
+}
+
+template<typename RAYCAST_CALLBACK>
+void AABBTree2D::RayCast(Vec2 const& start, Vec2 const& direction, float maxDistance, float radius, RAYCAST_CALLBACK&& callback) const
+{
+	//slab test on plain floats, it runs for every node the ray gets near. An axis the ray runs parallel to gets
+	//a huge inverse instead of infinity, so a start right on a slab still compares instead of turning into NaN
+	float const inverseX = (fabsf(direction.x) > 1e-8f) ? 1.f / direction.x : ((direction.x < 0.f) ? -1e30f : 1e30f);
+	float const inverseY = (fabsf(direction.y) > 1e-8f) ? 1.f / direction.y : ((direction.y < 0.f) ? -1e30f : 1e30f);
+	auto getEntryDistance = [this, &start, inverseX, inverseY, radius](int nodeIndex, float maxDistance, float& outEntryDistance)
+	{
+		AABB2 const& bounds = m_nodes[nodeIndex].m_bounds;
+		float minX = (bounds.mins.x - radius - start.x) * inverseX;
+		float maxX = (bounds.maxs.x + radius - start.x) * inverseX;
+		float minY = (bounds.mins.y - radius - start.y) * inverseY;
+		float maxY = (bounds.maxs.y + radius - start.y) * inverseY;
+		float entryDistance = fmaxf(fmaxf(fminf(minX, maxX), fminf(minY, maxY)), 0.f);
+		float exitDistance = fminf(fminf(fmaxf(minX, maxX), fmaxf(minY, maxY)), maxDistance);
+		outEntryDistance = entryDistance;
+		return entryDistance <= exitDistance;
+	};
+	float entryDistance = 0.f;
+	if (m_root == -1 || !getEntryDistance(m_root, maxDistance, entryDistance))
+	{
+		return;
+	}
+	//nearer child on top, so hits clip the ray before the far side of the tree is visited
+	struct RayCastEntry2D
+	{
+		int m_nodeIndex;
+		float m_entryDistance;
+	};
+	RayCastEntry2D localStack[256];
+	std::vector<RayCastEntry2D> overflowStack;
+	int stackSize = 0;
+	localStack[stackSize++] = { m_root, entryDistance };
+	while (stackSize > 0 || !overflowStack.empty())
+	{
+		RayCastEntry2D entry;
+		if (!overflowStack.empty())
+		{
+			entry = overflowStack.back();
+			overflowStack.pop_back();
+		}
+		else
+		{
+			entry = localStack[--stackSize];
+		}
+		if (entry.m_entryDistance > maxDistance)
+		{
+			continue;
+		}
+		AABBTreeNode2D const& node = m_nodes[entry.m_nodeIndex];
+		if (node.IsLeaf())
+		{
+			maxDistance = callback(entry.m_nodeIndex, maxDistance);
+			continue;
+		}
+		float entryDistance0 = 0.f;
+		float entryDistance1 = 0.f;
+		bool isHit0 = getEntryDistance(node.m_child0, maxDistance, entryDistance0);
+		bool isHit1 = getEntryDistance(node.m_child1, maxDistance, entryDistance1);
+		RayCastEntry2D children[2];
+		int childCount = 0;
+		if (isHit0 && isHit1 && entryDistance0 < entryDistance1)
+		{
+			children[childCount++] = { node.m_child1, entryDistance1 };
+			children[childCount++] = { node.m_child0, entryDistance0 };
+		}
+		else
+		{
+			if (isHit0)
+			{
+				children[childCount++] = { node.m_child0, entryDistance0 };
+			}
+			if (isHit1)
+			{
+				children[childCount++] = { node.m_child1, entryDistance1 };
+			}
+		}
+		for (int childIndex = 0; childIndex < childCount; ++childIndex)
+		{
+			if (stackSize < 256)
+			{
+				localStack[stackSize++] = children[childIndex];
+			}
+			else
+			{
+				overflowStack.push_back(children[childIndex]);
+			}
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#include "Engine/Physics/AABBTreeBroadphase2D.hpp"
+#include "Engine/Physics/Collider2D.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+
+int AABBTreeBroadphase2D::CreateProxy(AABB2 const& bounds, Collider2D* collider)
+{
+	int proxyID = m_tree.CreateProxy(bounds, collider);
+	if (proxyID >= (int)m_proxyColliders.size())
+	{
+		m_proxyColliders.resize(proxyID + 1, nullptr);
+	}
+	m_proxyColliders[proxyID] = collider;
+	return proxyID;
+}
+
+void AABBTreeBroadphase2D::DestroyProxy(int proxyID)
+{
+	ForgetCollider(m_proxyColliders[proxyID]);
+	m_proxyColliders[proxyID] = nullptr;
+	m_tree.DestroyProxy(proxyID);
+}
+
+void AABBTreeBroadphase2D::MoveProxy(int proxyID, AABB2 const& bounds)
+{
+	m_tree.MoveProxy(proxyID, bounds);
+}
+
+size_t AABBTreeBroadphase2D::GetMemoryUsage() const
+{
+	return Broadphase2D::GetMemoryUsage() + m_tree.GetMemoryUsage() + GetCapacityBytes(m_proxyColliders) + GetCapacityBytes(m_previousPairs);
+}
+
+void AABBTreeBroadphase2D::UpdatePairs()
+{
+	m_previousPairs.swap(m_pairs);
+	m_pairs.clear();
+	for (int proxyID = 0; proxyID < (int)m_proxyColliders.size(); ++proxyID)
+	{
+		//static pairs never collide, so static colliders only ever get found by the others
+		Collider2D* collider = m_proxyColliders[proxyID];
+		if (collider == nullptr || collider->m_rigidbody == nullptr || collider->m_rigidbody->GetSimulationMode() == STATIC)
+		{
+			continue;
+		}
+		m_tree.Query(m_tree.GetFatBounds(proxyID), [this, collider, proxyID](int otherProxyID)
+		{
+			Collider2D* other = (Collider2D*)m_tree.GetUserData(otherProxyID);
+			if (other == collider)
+			{
+				return true;
+			}
+			//two moving colliders find each other, keep the pair from one side only
+			if (other->m_rigidbody != nullptr && other->m_rigidbody->GetSimulationMode() != STATIC && otherProxyID < proxyID)
+			{
+				return true;
+			}
+			m_pairs.push_back(MakePair(collider, other));
+			return true;
+		});
+	}
+	SortPairs(m_pairs);
+	ComputePairChanges(m_previousPairs);
+}
+
+void AABBTreeBroadphase2D::QueryBounds(AABB2 const& bounds, query_cb callback, void* context) const
+{
+	m_tree.Query(bounds, [this, callback, context](int proxyID)
+	{
+		return callback(context, (Collider2D*)m_tree.GetUserData(proxyID));
+	});
+}
+
+void AABBTreeBroadphase2D::QueryRay(Vec2 const& start, Vec2 const& direction, float maxDistance, float radius, raycast_cb callback, void* context) const
+{
+	m_tree.RayCast(start, direction, maxDistance, radius, [this, callback, context](int proxyID, float currentMaxDistance)
+	{
+		return callback(context, (Collider2D*)m_tree.GetUserData(proxyID), currentMaxDistance);
+	});
+}
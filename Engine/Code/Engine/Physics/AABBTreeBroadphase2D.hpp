@@ -0,0 +1,29 @@
+#pragma once
+#include "Engine/Physics/Broadphase2D.hpp"
+#include "Engine/Physics/AABBTree2D.hpp"
+
+//Broadphase over a dynamic AABB tree. Every moving collider queries the tree each step, static colliders
+//only show up as the other half of a pair.
+class AABBTreeBroadphase2D : public Broadphase2D
+{
+public:
+	AABBTreeBroadphase2D() = default;
+	virtual ~AABBTreeBroadphase2D() = default;
+
+	virtual int CreateProxy(AABB2 const& bounds, Collider2D* collider) override;
+	virtual void DestroyProxy(int proxyID) override;
+	virtual void MoveProxy(int proxyID, AABB2 const& bounds) override;
+	virtual void UpdatePairs() override;
+	using Broadphase2D::QueryBounds;
+	virtual void QueryBounds(AABB2 const& bounds, query_cb callback, void* context) const override;
+	virtual void QueryRay(Vec2 const& start, Vec2 const& direction, float maxDistance, float radius, raycast_cb callback, void* context) const override;
+
+	virtual size_t GetMemoryUsage() const override;
+
+	AABBTree2D const& GetTree() const { return m_tree; }
+
+private:
+	AABBTree2D m_tree;
+	std::vector<Collider2D*> m_proxyColliders;	//indexed by proxy id, nullptr for unused ids
+	std::vector<ColliderPair2D> m_previousPairs;
+};
@@ -0,0 +1,101 @@
+#include "Engine/Physics/Broadphase2D.hpp"
+#include "Engine/Physics/AABBTreeBroadphase2D.hpp"
+#include "Engine/Physics/SweepAndPruneBroadphase2D.hpp"
+#include "Engine/Physics/Collider2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+
+Broadphase2D* Broadphase2D::CreateBroadphase(eBroadphaseType type)
+{
+	switch (type)
+	{
+	case BROADPHASE_AABB_TREE:			return new AABBTreeBroadphase2D();
+	case BROADPHASE_SWEEP_AND_PRUNE:	return new SweepAndPruneBroadphase2D();
+	default:
+		ERROR_AND_DIE("Unknown broadphase type");
+	}
+}
+
+size_t Broadphase2D::GetMemoryUsage() const
+{
+	return GetCapacityBytes(m_pairs) + GetCapacityBytes(m_addedPairs) + GetCapacityBytes(m_removedPairs) +
+		GetCapacityBytes(m_forgottenColliderIDs);
+}
+
+void Broadphase2D::QueryBounds(AABB2 const& bounds, std::vector<Collider2D*>& outColliders) const
+{
+	QueryBounds(bounds, [](void* context, Collider2D* collider)
+	{
+		((std::vector<Collider2D*>*)context)->push_back(collider);
+		return true;
+	}, &outColliders);
+}
+
+ColliderPair2D Broadphase2D::MakePair(Collider2D* colliderA, Collider2D* colliderB)
+{
+	ColliderPair2D pair;
+	pair.m_colliderA = (colliderA->m_id < colliderB->m_id) ? colliderA : colliderB;
+	pair.m_colliderB = (colliderA->m_id < colliderB->m_id) ? colliderB : colliderA;
+	pair.m_colliderIDA = pair.m_colliderA->m_id;
+	pair.m_colliderIDB = pair.m_colliderB->m_id;
+	return pair;
+}
+
+bool Broadphase2D::IsPairLess(ColliderPair2D const& pairA, ColliderPair2D const& pairB)
+{
+	if (pairA.m_colliderIDA != pairB.m_colliderIDA)
+	{
+		return pairA.m_colliderIDA < pairB.m_colliderIDA;
+	}
+	return pairA.m_colliderIDB < pairB.m_colliderIDB;
+}
+
+void Broadphase2D::SortPairs(std::vector<ColliderPair2D>& pairs)
+{
+	//proxy layout depends on insertion history, id order keeps the narrow phase and events deterministic
+	std::sort(pairs.begin(), pairs.end(), IsPairLess);
+}
+
+void Broadphase2D::ComputePairChanges(std::vector<ColliderPair2D> const& previousPairs)
+{
+	m_addedPairs.clear();
+	m_removedPairs.clear();
+	std::sort(m_forgottenColliderIDs.begin(), m_forgottenColliderIDs.end());
+	size_t previousIndex = 0;
+	size_t currentIndex = 0;
+	while (previousIndex < previousPairs.size() || currentIndex < m_pairs.size())
+	{
+		if (currentIndex == m_pairs.size() ||
+			(previousIndex < previousPairs.size() && IsPairLess(previousPairs[previousIndex], m_pairs[currentIndex])))
+		{
+			//a destroyed collider's pairs all end here, they are not reported
+			if (!IsForgotten(previousPairs[previousIndex]))
+			{
+				m_removedPairs.push_back(previousPairs[previousIndex]);
+			}
+			++previousIndex;
+		}
+		else if (previousIndex == previousPairs.size() || IsPairLess(m_pairs[currentIndex], previousPairs[previousIndex]))
+		{
+			m_addedPairs.push_back(m_pairs[currentIndex++]);
+		}
+		else
+		{
+			++previousIndex;
+			++currentIndex;
+		}
+	}
+	m_forgottenColliderIDs.clear();
+}
+
+void Broadphase2D::ForgetCollider(Collider2D const* collider)
+{
+	m_forgottenColliderIDs.push_back(collider->m_id);
+}
+
+bool Broadphase2D::IsForgotten(ColliderPair2D const& pair) const
+{
+	return std::binary_search(m_forgottenColliderIDs.begin(), m_forgottenColliderIDs.end(), pair.m_colliderIDA) ||
+		std::binary_search(m_forgottenColliderIDs.begin(), m_forgottenColliderIDs.end(), pair.m_colliderIDB);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+class Collider2D;
+
+enum eBroadphaseType
+{
+	BROADPHASE_AABB_TREE,			//best for scenes where most bodies move every step
+	BROADPHASE_SWEEP_AND_PRUNE,		//best for mostly resting scenes, cost follows how much the sort order changes
+	NUM_BROADPHASE_TYPES,
+};
+
+//Candidate from the broadphase, colliderA has the lower id. The ids are copied so pairs sort without
+//touching the colliders, which may already be gone.
+struct ColliderPair2D
+{
+	Collider2D* m_colliderA = nullptr;
+	Collider2D* m_colliderB = nullptr;
+	int m_colliderIDA = 0;
+	int m_colliderIDB = 0;
+};
+
+//Broadphase query callbacks, context is passed through untouched
+typedef bool (*query_cb)(void* context, Collider2D* collider);							//returns false to end the query
+typedef float (*raycast_cb)(void* context, Collider2D* collider, float maxDistance);	//returns the new max distance
+
+//Finds collider pairs whose bounds overlap. Physics2D owns one and keeps its proxies in sync with the colliders.
+class Broadphase2D
+{
+public:
+	virtual ~Broadphase2D() = default;
+
+	virtual int CreateProxy(AABB2 const& bounds, Collider2D* collider) = 0;
+	virtual void DestroyProxy(int proxyID) = 0;
+	virtual void MoveProxy(int proxyID, AABB2 const& bounds) = 0;
+	//Call once per step after every collider moved
+	virtual void UpdatePairs() = 0;
+	//Calls callback for every collider whose proxy bounds overlap bounds, proxies may be looser than the collider
+	virtual void QueryBounds(AABB2 const& bounds, query_cb callback, void* context) const = 0;
+	void QueryBounds(AABB2 const& bounds, std::vector<Collider2D*>& outColliders) const;
+	//Calls callback for every collider whose proxy bounds grown by radius the ray reaches within maxDistance,
+	//direction is normalized. The distance callback returns is what the rest of the query is clipped to.
+	virtual void QueryRay(Vec2 const& start, Vec2 const& direction, float maxDistance, float radius, raycast_cb callback, void* context) const = 0;
+
+	//Overlapping pairs sorted by collider id. Pairs of two static colliders may or may not be included.
+	//Pairs of a destroyed collider are only dropped by the next UpdatePairs, do not read the lists before it.
+	std::vector<ColliderPair2D> const& GetPairs() const { return m_pairs; }
+	//What the last UpdatePairs added to and removed from GetPairs(), also sorted by collider id
+	std::vector<ColliderPair2D> const& GetAddedPairs() const { return m_addedPairs; }
+	std::vector<ColliderPair2D> const& GetRemovedPairs() const { return m_removedPairs; }
+
+	//Bytes reserved for proxies and pairs
+	virtual size_t GetMemoryUsage() const;
+
+	static Broadphase2D* CreateBroadphase(eBroadphaseType type);
+
+protected:
+	static ColliderPair2D MakePair(Collider2D* colliderA, Collider2D* colliderB);
+	static bool IsPairLess(ColliderPair2D const& pairA, ColliderPair2D const& pairB);
+	static void SortPairs(std::vector<ColliderPair2D>& pairs);
+	//Fills the added and removed lists by comparing m_pairs against the sorted pairs from the previous update,
+	//pairs of forgotten colliders are left out of the removed list
+	void ComputePairChanges(std::vector<ColliderPair2D> const& previousPairs);
+	//collider is about to be deleted, its pairs are dropped by the next ComputePairChanges
+	void ForgetCollider(Collider2D const* collider);
+	bool IsForgotten(ColliderPair2D const& pair) const;
+
+protected:
+	std::vector<ColliderPair2D> m_pairs;
+	std::vector<ColliderPair2D> m_addedPairs;
+	std::vector<ColliderPair2D> m_removedPairs;
+	std::vector<int> m_forgottenColliderIDs;	//destroyed since the last ComputePairChanges
+};
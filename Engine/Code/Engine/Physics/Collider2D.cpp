@@ -78,6 +78,16 @@ bool Collider2D::Intersects(Collider2D const* other) const
 	}
 }
 
+AABB2 Collider2D::GetWorldAABB() const
+{
+	//box around the bounding disc, loose for polygons but it only feeds the broadphase
+	Vec2 halfDimensions(m_bound.m_radius, m_bound.m_radius);
+	AABB2 bounds;
+	bounds.mins = m_bound.m_center - halfDimensions;
+	bounds.maxs = m_bound.m_center + halfDimensions;
+	return bounds;
+}
+
 manifold2 Collider2D::GetManifold(Collider2D const* other) const
 {
 	eCollider2DType myType = m_type;
@@ -103,16 +113,36 @@ manifold2 Collider2D::GetManifold(Collider2D const* other) const
 	}
 }
 
+bool Collider2D::GetContact(Collider2D const* other, manifold2& outManifold) const
+{
+	outManifold = manifold2();
+	if (m_type == COLLIDER2D_POLYGON && other->m_type == COLLIDER2D_POLYGON)
+	{
+		Disc2 discOther = other->GetWorldBounds();
+		if (!DoDiscsOverlap(m_bound.m_center, m_bound.m_radius, discOther.m_center, discOther.m_radius))
+		{
+			return false;
+		}
+		return GetPolygonVPolygonContact(this, other, outManifold);
+	}
+	if (!Intersects(other))
+	{
+		return false;
+	}
+	outManifold = GetManifold(other);
+	return true;
+}
+
 void Collider2D::AddVerticesToDebugRender(std::vector<Vertex_PCU>& vertices, Rgba8 const& borderColor, Rgba8 const& fillColor)
 {
 	UNUSED(fillColor);
 	UNUSED(borderColor);
 	Rgba8 xColor = Rgba8(0, 0, 255, 255);
-	if (!m_rigidbody->m_physicsEnabled)
+	if (!m_rigidbody->IsPhysicsEnabled())
 	{
 		xColor = Rgba8(255, 0, 0, 255);
 	}
-	Vec2 worldPosition = m_rigidbody->m_worldPosition;
+	Vec2 worldPosition = m_rigidbody->GetPosition();
 	//ctx->DrawSegment(worldPosition + Vec2(-0.1f, -0.1f), worldPosition + Vec2(0.1f, 0.1f), 0.02f, xColor);
 	//ctx->DrawSegment(worldPosition + Vec2(-0.1f, 0.1f), worldPosition + Vec2(0.1f, -0.1f), 0.02f, xColor);
 	AddVertsForSegment(vertices, worldPosition + Vec2(-0.1f, -0.1f), worldPosition + Vec2(0.1f, 0.1f), 0.02f, xColor);
@@ -128,7 +158,7 @@ bool Collider2D::DiscVDiscCollisionCheck(Collider2D const* col0, Collider2D cons
 	DiscCollider2D const* disc0 = (DiscCollider2D const*)col0;
 	DiscCollider2D const* disc1 = (DiscCollider2D const*)col1;
 	
-	Vec2 closestPoint = disc1->GetClosestPoint(disc0->m_rigidbody->m_worldPosition);
+	Vec2 closestPoint = disc1->GetClosestPoint(disc0->m_rigidbody->GetPosition());
 	if (GetDistance2D(disc0->m_worldPosition, closestPoint) <= disc0->m_radius)
 	{
 		return true;
@@ -145,7 +175,7 @@ bool Collider2D::DiscVPolygonCollisionCheck(Collider2D const* col0, Collider2D c
 	DiscCollider2D const* disc0 = (DiscCollider2D const*)col0;
 	PolygonCollider2D const* poly1 = (PolygonCollider2D const*)col1;
 
-	Vec2 closestPoint = poly1->GetClosestPoint(disc0->m_rigidbody->m_worldPosition);
+	Vec2 closestPoint = poly1->GetClosestPoint(disc0->m_rigidbody->GetPosition());
 	if (GetDistance2D(disc0->m_worldPosition, closestPoint) <= disc0->m_radius)
 	{
 		return true;
@@ -153,6 +183,13 @@ bool Collider2D::DiscVPolygonCollisionCheck(Collider2D const* col0, Collider2D c
 	return false;
 }
 
+//Touching boxes pass, GJK reports polygons that only touch as intersecting and the early out must agree
+static bool DoWorldBoxesTouch(AABB2 const& boxA, AABB2 const& boxB)
+{
+	return boxA.mins.x <= boxB.maxs.x && boxB.mins.x <= boxA.maxs.x &&
+		boxA.mins.y <= boxB.maxs.y && boxB.mins.y <= boxA.maxs.y;
+}
+
 bool Collider2D::PolygonVPolygonCollisionCheck(Collider2D const* col0, Collider2D const* col1)
 {
 	if (col0->m_type != COLLIDER2D_POLYGON || col1->m_type != COLLIDER2D_POLYGON)
@@ -162,14 +199,12 @@ bool Collider2D::PolygonVPolygonCollisionCheck(Collider2D const* col0, Collider2
 	PolygonCollider2D const* poly0 = (PolygonCollider2D const*)col0;
 	PolygonCollider2D const* poly1 = (PolygonCollider2D const*)col1;
 
-	if (IsPolygonIntersectWithOtherPolygon(poly0->GetUpdatedWorldShape(), poly1->GetUpdatedWorldShape()))
-	{
-		return true;
-	}
-	else
+	if (!DoWorldBoxesTouch(poly0->GetWorldBox(), poly1->GetWorldBox()))
 	{
 		return false;
 	}
+	return IsPolygonIntersectWithOtherPolygon(poly0->GetWorldPoints(), poly0->GetVertexCount(), poly0->m_worldPosition,
+		poly1->GetWorldPoints(), poly1->GetVertexCount(), poly1->m_worldPosition);
 }
 
 Collider2D::collision_check_cb Collider2D::gCollisionChecks[NUM_COLLIDER_TYPES * NUM_COLLIDER_TYPES] =
@@ -224,121 +259,27 @@ manifold2 Collider2D::GetDiscVPolygonCollisionManifold(Collider2D const* col0, C
 manifold2 Collider2D::GetPolygonVPolygonCollisionManifold(Collider2D const* col0, Collider2D const* col1)
 {
 	manifold2 manifold;
+	GetPolygonVPolygonContact(col0, col1, manifold);
+	return manifold;
+}
+
+bool Collider2D::GetPolygonVPolygonContact(Collider2D const* col0, Collider2D const* col1, manifold2& outManifold)
+{
 	if (col0->m_type != COLLIDER2D_POLYGON || col1->m_type != COLLIDER2D_POLYGON)
 	{
-		return manifold;
+		return false;
 	}
 	PolygonCollider2D const* poly0 = (PolygonCollider2D const*)col0;
 	PolygonCollider2D const* poly1 = (PolygonCollider2D const*)col1;
 
-	Polygon2D polyA = poly0->GetUpdatedWorldShape();
-	Polygon2D polyB = poly1->GetUpdatedWorldShape();
-	Vec2 contactNormal = -GetContactNormalOfTwoPolygons(polyA, polyB);
-	//DebugAddWorldPoint(Vec3(polyB.GetCenter(), 0.f) + Vec3(20.f, 10.f, 0.f), 1.f, Rgba8(255, 0, 0, 255), 2.f);
-	manifold.penetration = contactNormal.GetLength();
-	contactNormal.Normalize();
-	manifold.contactNormal = contactNormal;
-
-	//Get support of B
-	Vec2 p = polyB.GetSupport(contactNormal);
-	Plane2D R = Plane2D(contactNormal, p);
-	std::vector<Vec2> edgePoints;
-	std::vector<Vec2> polyBPoints = polyB.GetPoints();
-	std::vector<Vec2> polyAPoints = polyA.GetPoints();
-	//Find all points on edge
-	for (int verticesIndex = 0; verticesIndex < polyBPoints.size(); ++verticesIndex)
-	{
-		if (R.GetDistance(polyBPoints[verticesIndex]) < 0.01f)
-		{
-			edgePoints.push_back(polyBPoints[verticesIndex]);
-		}
-	}
-	//Find min and max
-	Vec2 tMax = contactNormal.GetRotated90Degrees();
-	float min = INFINITY;
-	float max = -INFINITY;
-	Vec2 edgeMax = edgePoints[0];
-	Vec2 edgeMin = edgePoints[0];
-	for (int verticesIndex = 0; verticesIndex < edgePoints.size(); ++verticesIndex)
-	{
-		float distanceOnEdge = DotProduct2D(tMax, edgePoints[verticesIndex]);
-		if (distanceOnEdge > max)
-		{
-			max = distanceOnEdge;
-			edgeMax = edgePoints[verticesIndex];
-		}
-
-		if (distanceOnEdge < min)
-		{
-			min = distanceOnEdge;
-			edgeMin = edgePoints[verticesIndex];
-		}
-	}
-	if (edgeMax == edgeMin)
-	{
-		manifold.contactEdge.pointA = edgeMax;
-		manifold.contactEdge.pointB = edgeMin;
-		return manifold;
-	}
-	Segment2D refEdge(edgeMin, edgeMax);
-	Segment2D edgeA(polyAPoints[polyAPoints.size() - 1], polyAPoints[0]);
-	std::vector<Vec2> contactPoints;
-	if (R.GetSignedDistanceFromPlane(edgeA.pointA) < 0.f ||
-		R.GetSignedDistanceFromPlane(edgeA.pointB) < 0.f )
+	if (!DoWorldBoxesTouch(poly0->GetWorldBox(), poly1->GetWorldBox()))
 	{
-		Segment2D clipedEdgeA = ClipSegmentToSegment(edgeA, refEdge);
-		if (R.GetSignedDistanceFromPlane(clipedEdgeA.pointA) < 0.f)
-		{
-			contactPoints.push_back(clipedEdgeA.pointA);
-		}
-
-		if (R.GetSignedDistanceFromPlane(clipedEdgeA.pointB) < 0.f)
-		{
-			contactPoints.push_back(clipedEdgeA.pointB);
-		}
-	}
-
-	for (int edgeIndex = 0; edgeIndex < polyAPoints.size() - 1; ++edgeIndex)
-	{
-		edgeA = Segment2D(polyAPoints[edgeIndex], polyAPoints[edgeIndex + 1]);
-		if (R.GetSignedDistanceFromPlane(edgeA.pointA) < 0.f ||
-			R.GetSignedDistanceFromPlane(edgeA.pointB) < 0.f)
-		{
-			Segment2D clipedEdgeA = ClipSegmentToSegment(edgeA, refEdge);
-			if (R.GetSignedDistanceFromPlane(clipedEdgeA.pointA) < 0.f)
-			{
-				contactPoints.push_back(clipedEdgeA.pointA);
-			}
-
-			if (R.GetSignedDistanceFromPlane(clipedEdgeA.pointB) < 0.f)
-			{
-				contactPoints.push_back(clipedEdgeA.pointB);
-			}
-		}
-	}
-	min = INFINITY;
-	max = -INFINITY;
-	Vec2 contactMax = contactPoints[0];
-	Vec2 contactMin = contactPoints[0];
-	for (int verticesIndex = 0; verticesIndex < contactPoints.size(); ++verticesIndex)
-	{
-		float distanceOnEdge = DotProduct2D(tMax, contactPoints[verticesIndex]);
-		if (distanceOnEdge > max)
-		{
-			max = distanceOnEdge;
-			contactMax = contactPoints[verticesIndex];
-		}
-
-		if (distanceOnEdge < min)
-		{
-			min = distanceOnEdge;
-			contactMin = contactPoints[verticesIndex];
-		}
+		return false;
 	}
-	manifold.contactEdge.pointA = contactMin;
-	manifold.contactEdge.pointB = contactMax;
-
-	return manifold;
+	//shapes that only touch come back with an empty manifold, there is no direction to push along
+	return GetPolygonContact(poly0->GetWorldPoints(), poly0->GetVertexCount(), poly0->m_worldPosition,
+		poly1->GetWorldPoints(), poly1->GetVertexCount(), poly1->m_worldPosition,
+		outManifold.contactNormal, outManifold.penetration, outManifold.contactEdge);
 }
 
 Collider2D::collision_manifold_cb Collider2D::gManifolds[NUM_COLLIDER_TYPES * NUM_COLLIDER_TYPES] =
@@ -1,9 +1,12 @@
 #pragma once
 #include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/ObjectPool.hpp"
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Disc2.hpp"
+#include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/Segment2D.hpp"
+#include <cstdint>
 #include <vector>
 
 class RenderContext;
@@ -47,7 +50,13 @@ public: // Interface
 	virtual bool Contains(Vec2 pos) const = 0;
 	bool Intersects(Collider2D const* other) const;
 	manifold2 GetManifold(Collider2D const* other) const;
+	//Intersects and GetManifold in one call, polygon pairs share a single GJK/EPA pass
+	bool GetContact(Collider2D const* other, manifold2& outManifold) const;
 	virtual bool IntersectsPlane(Plane2D const& plane) const = 0;
+	virtual bool IntersectsAABB(AABB2 const& box) const = 0;
+	//Moves a disc of radius from start along the normalized direction until it touches the collider, radius 0 casts a ray.
+	//A cast that starts touching hits at distance 0 with the normal facing back along direction.
+	virtual bool CastDisc(Vec2 const& start, float radius, Vec2 const& direction, float maxDistance, float& outDistance, Vec2& outNormal) const = 0;
 	virtual float GetRadius() const = 0;
 	// debug helpers
 	virtual void AddVerticesToDebugRender(std::vector<Vertex_PCU>& vertices, Rgba8 const& borderColor, Rgba8 const& fillColor);
@@ -61,6 +70,7 @@ public: // Interface
 	float GetBounceWith(Collider2D const* other);
 	float GetFrictionWith(Collider2D const* other);
 	Disc2 GetWorldBounds() const { return m_bound; }
+	AABB2 GetWorldAABB() const;
 
 	virtual float CalculateMoment(float mass) = 0;
 protected:
@@ -80,6 +90,10 @@ public:
 	bool m_isIntersecting = false;
 	bool m_isTrigger = false;
 	int m_id = 0;
+	int m_proxyID = -1;							// handle in the system's broadphase
+	PoolHandle m_poolHandle;					// slot in the system's pool for m_type, see Physics2D::GetCollider
+	int m_colliderIndex = -1;					// position in the system's m_colliders, changes as others are removed
+	std::vector<uint64_t> m_contactKeys;		// contacts in the system's cache that include this collider
 private:
 //Collision matrix
 	typedef bool (*collision_check_cb)(Collider2D const*, Collider2D const*);
@@ -94,5 +108,6 @@ private:
 	static manifold2 GetDiscVDiscCollisionManifold(Collider2D const* col0, Collider2D const* col1);
 	static manifold2 GetDiscVPolygonCollisionManifold(Collider2D const* col0, Collider2D const* col1);
 	static manifold2 GetPolygonVPolygonCollisionManifold(Collider2D const* col0, Collider2D const* col1);
+	static bool GetPolygonVPolygonContact(Collider2D const* col0, Collider2D const* col1, manifold2& outManifold);
 	static collision_manifold_cb gManifolds[NUM_COLLIDER_TYPES * NUM_COLLIDER_TYPES];
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "Engine/Physics/Collision2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+Collision2D Collision2D::GetInversed()
+{
+	Collision2D invCollision;
+	invCollision.manifold.contactNormal = -manifold.contactNormal;
+	invCollision.me = them;
+	invCollision.them = me;
+	invCollision.m_colliderID = m_colliderID;
+	invCollision.m_frameId = m_frameId;
+	return invCollision;
+}
+
+Vec2 Collision2D::GetNormal() const
+{
+	return manifold.contactNormal;
+}
+
+float Collision2D::GetPenetration() const
+{
+	return manifold.penetration;
+}
+
+void Collision2D::InheritImpulses(Collision2D const& previous)
+{
+	//edge points are ordered along the tangent, so they only line up while the normal barely moved
+	if (DotProduct2D(manifold.contactNormal, previous.manifold.contactNormal) < 0.95f)
+	{
+		return;
+	}
+	for (int pointIndex = 0; pointIndex < MAX_CONTACT_POINTS; ++pointIndex)
+	{
+		m_normalImpulses[pointIndex] = previous.m_normalImpulses[pointIndex];
+		m_tangentImpulses[pointIndex] = previous.m_tangentImpulses[pointIndex];
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Physics/Collider2D.hpp"
+
+struct Collision2D
+{
+	manifold2 manifold;
+	Collider2D* me = nullptr;
+	Collider2D* them = nullptr;
+	Vec2 GetNormal() const;
+	float GetPenetration() const;
+	IntVec2 m_colliderID;
+	int m_frameId = 0;
+	//solver impulses per contact edge end point, kept in the contact cache to warm start the next step
+	static constexpr int MAX_CONTACT_POINTS = 2;
+	float m_normalImpulses[MAX_CONTACT_POINTS] = { 0.f, 0.f };
+	float m_tangentImpulses[MAX_CONTACT_POINTS] = { 0.f, 0.f };
+public:
+	Collision2D GetInversed();
+	//Takes the previous step's impulses if the contact still faces the same way
+	void InheritImpulses(Collision2D const& previous);
+};
@@ -0,0 +1,128 @@
+#include "Engine/Physics/ContactCache2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+
+ContactCache2D::ContactCache2D()
+{
+	m_slots.assign(64, EMPTY_SLOT);
+}
+
+uint64_t ContactCache2D::GetContactKey(int colliderIDA, int colliderIDB)
+{
+	uint32_t lowID = (uint32_t)((colliderIDA < colliderIDB) ? colliderIDA : colliderIDB);
+	uint32_t highID = (uint32_t)((colliderIDA < colliderIDB) ? colliderIDB : colliderIDA);
+	return ((uint64_t)lowID << 32) | highID;
+}
+
+Collision2D* ContactCache2D::Find(uint64_t key)
+{
+	size_t slot = FindSlot(key);
+	if (slot == m_slots.size())
+	{
+		return nullptr;
+	}
+	return &m_contacts[m_slots[slot]];
+}
+
+Collision2D& ContactCache2D::Add(uint64_t key, Collision2D const& contact)
+{
+	//keep the table at most half full so probe runs stay short
+	if ((m_contacts.size() + 1) * 2 > m_slots.size())
+	{
+		Grow();
+	}
+	size_t mask = m_slots.size() - 1;
+	size_t slot = GetHomeSlot(key);
+	while (m_slots[slot] != EMPTY_SLOT)
+	{
+		slot = (slot + 1) & mask;
+	}
+	m_slots[slot] = (int)m_contacts.size();
+	m_keys.push_back(key);
+	m_contacts.push_back(contact);
+	return m_contacts.back();
+}
+
+void ContactCache2D::Remove(uint64_t key)
+{
+	size_t slot = FindSlot(key);
+	if (slot == m_slots.size())
+	{
+		return;
+	}
+
+	//fill the hole in the dense arrays with the last contact and point its slot at the new index
+	int denseIndex = m_slots[slot];
+	int lastIndex = (int)m_contacts.size() - 1;
+	if (denseIndex != lastIndex)
+	{
+		m_slots[FindSlot(m_keys[lastIndex])] = denseIndex;
+		m_keys[denseIndex] = m_keys[lastIndex];
+		m_contacts[denseIndex] = m_contacts[lastIndex];
+	}
+	m_keys.pop_back();
+	m_contacts.pop_back();
+
+	//backward shift deletion: pull later entries of the probe run into the hole so lookups never need tombstones
+	size_t mask = m_slots.size() - 1;
+	size_t hole = slot;
+	size_t next = (hole + 1) & mask;
+	while (m_slots[next] != EMPTY_SLOT)
+	{
+		size_t home = GetHomeSlot(m_keys[m_slots[next]]);
+		if (((next - home) & mask) >= ((next - hole) & mask))
+		{
+			m_slots[hole] = m_slots[next];
+			hole = next;
+		}
+		next = (next + 1) & mask;
+	}
+	m_slots[hole] = EMPTY_SLOT;
+}
+
+void ContactCache2D::Clear()
+{
+	m_slots.assign(m_slots.size(), EMPTY_SLOT);
+	m_keys.clear();
+	m_contacts.clear();
+}
+
+size_t ContactCache2D::GetMemoryUsage() const
+{
+	return GetCapacityBytes(m_slots) + GetCapacityBytes(m_keys) + GetCapacityBytes(m_contacts);
+}
+
+size_t ContactCache2D::GetHomeSlot(uint64_t key) const
+{
+	//fibonacci hashing, consecutive ids would otherwise land in consecutive slots
+	return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (m_slots.size() - 1);
+}
+
+size_t ContactCache2D::FindSlot(uint64_t key) const
+{
+	size_t mask = m_slots.size() - 1;
+	size_t slot = GetHomeSlot(key);
+	while (m_slots[slot] != EMPTY_SLOT)
+	{
+		if (m_keys[m_slots[slot]] == key)
+		{
+			return slot;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return m_slots.size();
+}
+
+void ContactCache2D::Grow()
+{
+	m_slots.assign(m_slots.size() * 2, EMPTY_SLOT);
+	size_t mask = m_slots.size() - 1;
+	for (int denseIndex = 0; denseIndex < (int)m_keys.size(); ++denseIndex)
+	{
+		size_t slot = GetHomeSlot(m_keys[denseIndex]);
+		while (m_slots[slot] != EMPTY_SLOT)
+		{
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = denseIndex;
+	}
+}
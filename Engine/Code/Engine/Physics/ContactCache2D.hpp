@@ -0,0 +1,39 @@
+#pragma once
+#include "Engine/Physics/Collision2D.hpp"
+#include <cstdint>
+#include <vector>
+
+//Contacts from previous steps keyed by collider pair, used to tell Begin from Stay from End.
+//Contacts live in a dense array (swap-remove) indexed by an open addressing table with linear probing.
+class ContactCache2D
+{
+public:
+	ContactCache2D();
+	~ContactCache2D() = default;
+
+	static uint64_t GetContactKey(int colliderIDA, int colliderIDB);
+
+	Collision2D* Find(uint64_t key);
+	//key must not be in the cache yet
+	Collision2D& Add(uint64_t key, Collision2D const& contact);
+	void Remove(uint64_t key);
+	void Clear();
+
+	//Dense access, an index stays valid until the next Add or Remove
+	int GetCount() const { return (int)m_contacts.size(); }
+	Collision2D& GetContact(int index) { return m_contacts[index]; }
+	Collision2D const& GetContact(int index) const { return m_contacts[index]; }
+	uint64_t GetKey(int index) const { return m_keys[index]; }
+	size_t GetMemoryUsage() const;
+
+private:
+	size_t GetHomeSlot(uint64_t key) const;
+	size_t FindSlot(uint64_t key) const;
+	void Grow();
+
+private:
+	static constexpr int EMPTY_SLOT = -1;
+	std::vector<int> m_slots;				//index into the dense arrays, power of two size
+	std::vector<uint64_t> m_keys;
+	std::vector<Collision2D> m_contacts;
+};
@@ -0,0 +1,395 @@
+#include "Engine/Physics/ContactSolver2D.hpp"
+#include "Engine/Physics/ContactCache2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+#include "Engine/Physics/IslandBuilder2D.hpp"
+#include "Engine/Physics/RigidbodyStorage2D.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+#include "Engine/Physics/Collider2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+static Vec2 GetPointVelocity(RigidbodyStorage2D const& storage, int bodyIndex, Vec2 const& offset)
+{
+	Vec2 linearVelocity(storage.m_velocityX[bodyIndex], storage.m_velocityY[bodyIndex]);
+	return linearVelocity + offset.GetRotated90Degrees() * storage.m_angularVelocity[bodyIndex];
+}
+
+static void ApplyImpulseAtOffset(RigidbodyStorage2D& storage, int bodyIndex, float inverseMass, float inverseMoment,
+	Vec2 const& offset, Vec2 const& impulse)
+{
+	//bodies that do not respond are shared between islands, writing them even unchanged would race
+	if (inverseMass == 0.f && inverseMoment == 0.f)
+	{
+		return;
+	}
+	storage.m_velocityX[bodyIndex] += impulse.x * inverseMass;
+	storage.m_velocityY[bodyIndex] += impulse.y * inverseMass;
+	storage.m_angularVelocity[bodyIndex] += CrossProduct2D(offset, impulse) * inverseMoment;
+}
+
+static float GetEffectiveMass(ContactConstraint2D const& constraint, Vec2 const& offsetA, Vec2 const& offsetB, Vec2 const& direction)
+{
+	float armA = CrossProduct2D(offsetA, direction);
+	float armB = CrossProduct2D(offsetB, direction);
+	float inverseEffectiveMass = constraint.m_inverseMassA + constraint.m_inverseMassB +
+		constraint.m_inverseMomentA * armA * armA + constraint.m_inverseMomentB * armB * armB;
+	return (inverseEffectiveMass > 0.f) ? 1.f / inverseEffectiveMass : 0.f;
+}
+
+static void SolveNormalPoint(ContactConstraint2D& constraint, ContactPoint2D& point, RigidbodyStorage2D& storage)
+{
+	int indexA = constraint.m_bodyIndexA;
+	int indexB = constraint.m_bodyIndexB;
+	Vec2 relativeVelocity = GetPointVelocity(storage, indexA, point.m_offsetA) - GetPointVelocity(storage, indexB, point.m_offsetB);
+	float lambda = (point.m_velocityBias - DotProduct2D(relativeVelocity, constraint.m_normal)) * point.m_normalMass;
+	//clamp the accumulated impulse, a single iteration may pull as long as the total still pushes
+	float newImpulse = (point.m_normalImpulse + lambda > 0.f) ? point.m_normalImpulse + lambda : 0.f;
+	lambda = newImpulse - point.m_normalImpulse;
+	point.m_normalImpulse = newImpulse;
+
+	Vec2 impulse = lambda * constraint.m_normal;
+	ApplyImpulseAtOffset(storage, indexA, constraint.m_inverseMassA, constraint.m_inverseMomentA, point.m_offsetA, impulse);
+	ApplyImpulseAtOffset(storage, indexB, constraint.m_inverseMassB, constraint.m_inverseMomentB, point.m_offsetB, -impulse);
+}
+
+//Solves both normal impulses of a two point manifold together (a 2x2 LCP) so a resting face shares its load
+//evenly, solving the points one after the other leaves a torque every iteration and stacks rock.
+//Tries the four cases (both, first only, second only, none pushing) and keeps the first valid one.
+static void SolveNormalBlock(ContactConstraint2D& constraint, RigidbodyStorage2D& storage)
+{
+	int indexA = constraint.m_bodyIndexA;
+	int indexB = constraint.m_bodyIndexB;
+	ContactPoint2D& point1 = constraint.m_points[0];
+	ContactPoint2D& point2 = constraint.m_points[1];
+	float oldImpulse1 = point1.m_normalImpulse;
+	float oldImpulse2 = point2.m_normalImpulse;
+
+	Vec2 relativeVelocity1 = GetPointVelocity(storage, indexA, point1.m_offsetA) - GetPointVelocity(storage, indexB, point1.m_offsetB);
+	Vec2 relativeVelocity2 = GetPointVelocity(storage, indexA, point2.m_offsetA) - GetPointVelocity(storage, indexB, point2.m_offsetB);
+	//velocities the accumulated impulses have to produce, with the current impulses taken back out
+	float b1 = DotProduct2D(relativeVelocity1, constraint.m_normal) - point1.m_velocityBias - (constraint.m_k11 * oldImpulse1 + constraint.m_k12 * oldImpulse2);
+	float b2 = DotProduct2D(relativeVelocity2, constraint.m_normal) - point2.m_velocityBias - (constraint.m_k12 * oldImpulse1 + constraint.m_k22 * oldImpulse2);
+
+	float newImpulse1 = -(constraint.m_inverseK11 * b1 + constraint.m_inverseK12 * b2);
+	float newImpulse2 = -(constraint.m_inverseK12 * b1 + constraint.m_inverseK22 * b2);
+	if (newImpulse1 < 0.f || newImpulse2 < 0.f)
+	{
+		newImpulse1 = -b1 / constraint.m_k11;
+		newImpulse2 = 0.f;
+		if (newImpulse1 < 0.f || constraint.m_k12 * newImpulse1 + b2 < 0.f)
+		{
+			newImpulse1 = 0.f;
+			newImpulse2 = -b2 / constraint.m_k22;
+			if (newImpulse2 < 0.f || constraint.m_k12 * newImpulse2 + b1 < 0.f)
+			{
+				newImpulse2 = 0.f;
+				if (b1 < 0.f || b2 < 0.f)
+				{
+					//no case fits, keep last iteration's impulses
+					return;
+				}
+			}
+		}
+	}
+
+	Vec2 impulse1 = (newImpulse1 - oldImpulse1) * constraint.m_normal;
+	Vec2 impulse2 = (newImpulse2 - oldImpulse2) * constraint.m_normal;
+	point1.m_normalImpulse = newImpulse1;
+	point2.m_normalImpulse = newImpulse2;
+	ApplyImpulseAtOffset(storage, indexA, constraint.m_inverseMassA, constraint.m_inverseMomentA, point1.m_offsetA, impulse1);
+	ApplyImpulseAtOffset(storage, indexA, constraint.m_inverseMassA, constraint.m_inverseMomentA, point2.m_offsetA, impulse2);
+	ApplyImpulseAtOffset(storage, indexB, constraint.m_inverseMassB, constraint.m_inverseMomentB, point1.m_offsetB, -impulse1);
+	ApplyImpulseAtOffset(storage, indexB, constraint.m_inverseMassB, constraint.m_inverseMomentB, point2.m_offsetB, -impulse2);
+}
+
+void ContactSolver2D::Clear()
+{
+	m_constraints.clear();
+	m_islandStarts.assign(1, 0);
+}
+
+size_t ContactSolver2D::GetMemoryUsage() const
+{
+	return GetCapacityBytes(m_constraints) + GetCapacityBytes(m_sortedConstraints) + GetCapacityBytes(m_constraintIslands) +
+		GetCapacityBytes(m_islandOfRoot) + GetCapacityBytes(m_islandStarts);
+}
+
+void ContactSolver2D::AddContact(Collision2D const& contact, RigidbodyStorage2D const& storage)
+{
+	Vec2 normal = contact.GetNormal();
+	if (normal.GetLengthSquared() < 0.5f)
+	{
+		//degenerate manifold, the shapes only touch
+		return;
+	}
+
+	ContactConstraint2D constraint;
+	constraint.m_key = ContactCache2D::GetContactKey(contact.me->m_id, contact.them->m_id);
+	constraint.m_bodyIndexA = storage.GetIndex(contact.me->m_rigidbody->m_handle);
+	constraint.m_bodyIndexB = storage.GetIndex(contact.them->m_rigidbody->m_handle);
+	int indexA = constraint.m_bodyIndexA;
+	int indexB = constraint.m_bodyIndexB;
+
+	//only awake dynamic bodies respond, everything else acts as infinite mass
+	if (storage.IsMovable(indexA) && storage.m_mode[indexA] == DYNAMIC)
+	{
+		constraint.m_inverseMassA = (storage.m_mass[indexA] > 0.f) ? 1.f / storage.m_mass[indexA] : 0.f;
+		constraint.m_inverseMomentA = (storage.m_moment[indexA] > 0.f) ? 1.f / storage.m_moment[indexA] : 0.f;
+	}
+	if (storage.IsMovable(indexB) && storage.m_mode[indexB] == DYNAMIC)
+	{
+		constraint.m_inverseMassB = (storage.m_mass[indexB] > 0.f) ? 1.f / storage.m_mass[indexB] : 0.f;
+		constraint.m_inverseMomentB = (storage.m_moment[indexB] > 0.f) ? 1.f / storage.m_moment[indexB] : 0.f;
+	}
+	if (constraint.m_inverseMassA + constraint.m_inverseMassB + constraint.m_inverseMomentA + constraint.m_inverseMomentB <= 0.f)
+	{
+		return;
+	}
+
+	constraint.m_normal = normal;
+	constraint.m_friction = contact.me->GetFrictionWith(contact.them);
+	constraint.m_penetration = contact.GetPenetration();
+	constraint.m_startPositionA = Vec2(storage.m_positionX[indexA], storage.m_positionY[indexA]);
+	constraint.m_startPositionB = Vec2(storage.m_positionX[indexB], storage.m_positionY[indexB]);
+	float restitution = contact.me->GetBounceWith(contact.them);
+
+	Vec2 contactPoints[Collision2D::MAX_CONTACT_POINTS] = { contact.manifold.contactEdge.pointA, contact.manifold.contactEdge.pointB };
+	constraint.m_pointCount = (GetDistanceSquared2D(contactPoints[0], contactPoints[1]) > 1e-6f) ? 2 : 1;
+	Vec2 tangent = normal.GetRotated90Degrees();
+	for (int pointIndex = 0; pointIndex < constraint.m_pointCount; ++pointIndex)
+	{
+		ContactPoint2D& point = constraint.m_points[pointIndex];
+		point.m_offsetA = contactPoints[pointIndex] - constraint.m_startPositionA;
+		point.m_offsetB = contactPoints[pointIndex] - constraint.m_startPositionB;
+		point.m_normalMass = GetEffectiveMass(constraint, point.m_offsetA, point.m_offsetB, normal);
+		point.m_tangentMass = GetEffectiveMass(constraint, point.m_offsetA, point.m_offsetB, tangent);
+		point.m_normalImpulse = contact.m_normalImpulses[pointIndex];
+		point.m_tangentImpulse = contact.m_tangentImpulses[pointIndex];
+
+		//bounce target comes from the approach speed before any impulse of this step
+		Vec2 relativeVelocity = GetPointVelocity(storage, indexA, point.m_offsetA) - GetPointVelocity(storage, indexB, point.m_offsetB);
+		float normalVelocity = DotProduct2D(relativeVelocity, normal);
+		if (normalVelocity < -RESTITUTION_VELOCITY_THRESHOLD)
+		{
+			point.m_velocityBias = -restitution * normalVelocity;
+		}
+	}
+
+	if (constraint.m_pointCount == 2)
+	{
+		ContactPoint2D& point1 = constraint.m_points[0];
+		ContactPoint2D& point2 = constraint.m_points[1];
+		float armA1 = CrossProduct2D(point1.m_offsetA, normal);
+		float armB1 = CrossProduct2D(point1.m_offsetB, normal);
+		float armA2 = CrossProduct2D(point2.m_offsetA, normal);
+		float armB2 = CrossProduct2D(point2.m_offsetB, normal);
+		float inverseMassSum = constraint.m_inverseMassA + constraint.m_inverseMassB;
+		constraint.m_k11 = inverseMassSum + constraint.m_inverseMomentA * armA1 * armA1 + constraint.m_inverseMomentB * armB1 * armB1;
+		constraint.m_k22 = inverseMassSum + constraint.m_inverseMomentA * armA2 * armA2 + constraint.m_inverseMomentB * armB2 * armB2;
+		constraint.m_k12 = inverseMassSum + constraint.m_inverseMomentA * armA1 * armA2 + constraint.m_inverseMomentB * armB1 * armB2;
+		float determinant = constraint.m_k11 * constraint.m_k22 - constraint.m_k12 * constraint.m_k12;
+		if (constraint.m_k11 * constraint.m_k11 < MAX_BLOCK_CONDITION * determinant)
+		{
+			constraint.m_inverseK11 = constraint.m_k22 / determinant;
+			constraint.m_inverseK22 = constraint.m_k11 / determinant;
+			constraint.m_inverseK12 = -constraint.m_k12 / determinant;
+		}
+		else
+		{
+			//points too close together (or no rotation) for a well conditioned block, one point does the job
+			constraint.m_pointCount = 1;
+		}
+	}
+	m_constraints.push_back(constraint);
+}
+
+static bool IsRespondingA(ContactConstraint2D const& constraint)
+{
+	return constraint.m_inverseMassA > 0.f || constraint.m_inverseMomentA > 0.f;
+}
+
+static bool IsRespondingB(ContactConstraint2D const& constraint)
+{
+	return constraint.m_inverseMassB > 0.f || constraint.m_inverseMomentB > 0.f;
+}
+
+void ContactSolver2D::BuildIslands(IslandBuilder2D& islands, int awakeCount)
+{
+	islands.Reset(awakeCount);
+	for (ContactConstraint2D const& constraint : m_constraints)
+	{
+		if (IsRespondingA(constraint) && IsRespondingB(constraint))
+		{
+			islands.Link(constraint.m_bodyIndexA, constraint.m_bodyIndexB);
+		}
+	}
+
+	//islands are numbered in order of their first contact and the contacts are counting sorted,
+	//so the order within an island is the order the contacts were added in
+	int constraintCount = (int)m_constraints.size();
+	int islandCount = 0;
+	m_islandOfRoot.assign(awakeCount, -1);
+	m_constraintIslands.resize(constraintCount);
+	for (int constraintIndex = 0; constraintIndex < constraintCount; ++constraintIndex)
+	{
+		ContactConstraint2D const& constraint = m_constraints[constraintIndex];
+		int body = IsRespondingA(constraint) ? constraint.m_bodyIndexA : constraint.m_bodyIndexB;
+		int root = islands.FindRoot(body);
+		if (m_islandOfRoot[root] == -1)
+		{
+			m_islandOfRoot[root] = islandCount;
+			++islandCount;
+		}
+		m_constraintIslands[constraintIndex] = m_islandOfRoot[root];
+	}
+
+	m_islandStarts.assign(islandCount + 1, 0);
+	for (int constraintIndex = 0; constraintIndex < constraintCount; ++constraintIndex)
+	{
+		++m_islandStarts[m_constraintIslands[constraintIndex] + 1];
+	}
+	for (int islandIndex = 0; islandIndex < islandCount; ++islandIndex)
+	{
+		m_islandStarts[islandIndex + 1] += m_islandStarts[islandIndex];
+	}
+	m_sortedConstraints.resize(constraintCount);
+	//m_islandOfRoot is done with, reused as the next free slot of every island
+	std::vector<int>& nextSlots = m_islandOfRoot;
+	nextSlots.assign(m_islandStarts.begin(), m_islandStarts.end() - 1);
+	for (int constraintIndex = 0; constraintIndex < constraintCount; ++constraintIndex)
+	{
+		int island = m_constraintIslands[constraintIndex];
+		m_sortedConstraints[nextSlots[island]] = m_constraints[constraintIndex];
+		++nextSlots[island];
+	}
+	m_constraints.swap(m_sortedConstraints);
+}
+
+void ContactSolver2D::SolveIslandVelocities(int islandIndex, RigidbodyStorage2D& storage, int iterations)
+{
+	int begin = m_islandStarts[islandIndex];
+	int end = m_islandStarts[islandIndex + 1];
+	WarmStart(storage, begin, end);
+	for (int iteration = 0; iteration < iterations; ++iteration)
+	{
+		SolveVelocities(storage, begin, end);
+	}
+}
+
+void ContactSolver2D::SolveIslandPositions(int islandIndex, RigidbodyStorage2D& storage, int iterations)
+{
+	int begin = m_islandStarts[islandIndex];
+	int end = m_islandStarts[islandIndex + 1];
+	for (int iteration = 0; iteration < iterations; ++iteration)
+	{
+		if (SolvePositions(storage, begin, end))
+		{
+			return;
+		}
+	}
+}
+
+void ContactSolver2D::WarmStart(RigidbodyStorage2D& storage, int begin, int end)
+{
+	for (int constraintIndex = begin; constraintIndex < end; ++constraintIndex)
+	{
+		ContactConstraint2D const& constraint = m_constraints[constraintIndex];
+		Vec2 tangent = constraint.m_normal.GetRotated90Degrees();
+		for (int pointIndex = 0; pointIndex < constraint.m_pointCount; ++pointIndex)
+		{
+			ContactPoint2D const& point = constraint.m_points[pointIndex];
+			Vec2 impulse = point.m_normalImpulse * constraint.m_normal + point.m_tangentImpulse * tangent;
+			ApplyImpulseAtOffset(storage, constraint.m_bodyIndexA, constraint.m_inverseMassA, constraint.m_inverseMomentA, point.m_offsetA, impulse);
+			ApplyImpulseAtOffset(storage, constraint.m_bodyIndexB, constraint.m_inverseMassB, constraint.m_inverseMomentB, point.m_offsetB, -impulse);
+		}
+	}
+}
+
+void ContactSolver2D::SolveVelocities(RigidbodyStorage2D& storage, int begin, int end)
+{
+	for (int constraintIndex = begin; constraintIndex < end; ++constraintIndex)
+	{
+		ContactConstraint2D& constraint = m_constraints[constraintIndex];
+		int indexA = constraint.m_bodyIndexA;
+		int indexB = constraint.m_bodyIndexB;
+		Vec2 tangent = constraint.m_normal.GetRotated90Degrees();
+
+		//friction first, its limit depends on the normal impulse from the previous iteration
+		for (int pointIndex = 0; pointIndex < constraint.m_pointCount; ++pointIndex)
+		{
+			ContactPoint2D& point = constraint.m_points[pointIndex];
+			Vec2 relativeVelocity = GetPointVelocity(storage, indexA, point.m_offsetA) - GetPointVelocity(storage, indexB, point.m_offsetB);
+			float lambda = -DotProduct2D(relativeVelocity, tangent) * point.m_tangentMass;
+			float maxFriction = constraint.m_friction * point.m_normalImpulse;
+			float newImpulse = Clamp(point.m_tangentImpulse + lambda, -maxFriction, maxFriction);
+			lambda = newImpulse - point.m_tangentImpulse;
+			point.m_tangentImpulse = newImpulse;
+
+			Vec2 impulse = lambda * tangent;
+			ApplyImpulseAtOffset(storage, indexA, constraint.m_inverseMassA, constraint.m_inverseMomentA, point.m_offsetA, impulse);
+			ApplyImpulseAtOffset(storage, indexB, constraint.m_inverseMassB, constraint.m_inverseMomentB, point.m_offsetB, -impulse);
+		}
+
+		if (constraint.m_pointCount == 2)
+		{
+			SolveNormalBlock(constraint, storage);
+		}
+		else
+		{
+			SolveNormalPoint(constraint, constraint.m_points[0], storage);
+		}
+	}
+}
+
+bool ContactSolver2D::SolvePositions(RigidbodyStorage2D& storage, int begin, int end)
+{
+	//linear only: separation is estimated from how far the bodies moved along the normal since the contact was found
+	float maxPenetration = 0.f;
+	for (int constraintIndex = begin; constraintIndex < end; ++constraintIndex)
+	{
+		ContactConstraint2D const& constraint = m_constraints[constraintIndex];
+		int indexA = constraint.m_bodyIndexA;
+		int indexB = constraint.m_bodyIndexB;
+		Vec2 positionA(storage.m_positionX[indexA], storage.m_positionY[indexA]);
+		Vec2 positionB(storage.m_positionX[indexB], storage.m_positionY[indexB]);
+		Vec2 relativeMove = (positionA - constraint.m_startPositionA) - (positionB - constraint.m_startPositionB);
+		float penetration = constraint.m_penetration - DotProduct2D(relativeMove, constraint.m_normal);
+		maxPenetration = (penetration > maxPenetration) ? penetration : maxPenetration;
+
+		float inverseMassSum = constraint.m_inverseMassA + constraint.m_inverseMassB;
+		if (inverseMassSum <= 0.f)
+		{
+			continue;
+		}
+		float correction = Clamp(POSITION_CORRECTION_RATE * (penetration - LINEAR_SLOP), 0.f, MAX_POSITION_CORRECTION);
+		Vec2 push = constraint.m_normal * (correction / inverseMassSum);
+		if (constraint.m_inverseMassA > 0.f)
+		{
+			storage.m_positionX[indexA] += push.x * constraint.m_inverseMassA;
+			storage.m_positionY[indexA] += push.y * constraint.m_inverseMassA;
+		}
+		if (constraint.m_inverseMassB > 0.f)
+		{
+			storage.m_positionX[indexB] -= push.x * constraint.m_inverseMassB;
+			storage.m_positionY[indexB] -= push.y * constraint.m_inverseMassB;
+		}
+	}
+	return maxPenetration <= 3.f * LINEAR_SLOP;
+}
+
+void ContactSolver2D::StoreImpulses(ContactCache2D& cache) const
+{
+	for (ContactConstraint2D const& constraint : m_constraints)
+	{
+		Collision2D* cachedContact = cache.Find(constraint.m_key);
+		if (cachedContact == nullptr)
+		{
+			continue;
+		}
+		for (int pointIndex = 0; pointIndex < Collision2D::MAX_CONTACT_POINTS; ++pointIndex)
+		{
+			bool isUsed = pointIndex < constraint.m_pointCount;
+			cachedContact->m_normalImpulses[pointIndex] = isUsed ? constraint.m_points[pointIndex].m_normalImpulse : 0.f;
+			cachedContact->m_tangentImpulses[pointIndex] = isUsed ? constraint.m_points[pointIndex].m_tangentImpulse : 0.f;
+		}
+	}
+}
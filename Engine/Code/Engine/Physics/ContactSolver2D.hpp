@@ -0,0 +1,100 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Physics/Collision2D.hpp"
+#include <cstdint>
+#include <vector>
+
+class RigidbodyStorage2D;
+class ContactCache2D;
+class IslandBuilder2D;
+
+struct ContactPoint2D
+{
+	Vec2 m_offsetA;					//contact point relative to body A's position
+	Vec2 m_offsetB;
+	float m_normalMass = 0.f;
+	float m_tangentMass = 0.f;
+	float m_normalImpulse = 0.f;	//accumulated over the step, carried to the next step for warm starting
+	float m_tangentImpulse = 0.f;
+	float m_velocityBias = 0.f;		//restitution target
+};
+
+//A is the contact's "me" collider, the normal points from B towards A
+struct ContactConstraint2D
+{
+	uint64_t m_key = 0;
+	int m_bodyIndexA = 0;
+	int m_bodyIndexB = 0;
+	float m_inverseMassA = 0.f;
+	float m_inverseMassB = 0.f;
+	float m_inverseMomentA = 0.f;
+	float m_inverseMomentB = 0.f;
+	Vec2 m_normal;
+	float m_friction = 0.f;
+	float m_penetration = 0.f;
+	Vec2 m_startPositionA;			//positions when the contact was found, the position pass measures separation from them
+	Vec2 m_startPositionB;
+	int m_pointCount = 0;
+	ContactPoint2D m_points[Collision2D::MAX_CONTACT_POINTS];
+	//two point manifolds solve both normal impulses together, K is the symmetric 2x2 effective mass matrix
+	float m_k11 = 0.f;
+	float m_k12 = 0.f;
+	float m_k22 = 0.f;
+	float m_inverseK11 = 0.f;
+	float m_inverseK12 = 0.f;
+	float m_inverseK22 = 0.f;
+};
+
+//Sequential impulse solver: every contact point keeps an accumulated normal and friction impulse that is
+//clamped as a whole rather than per iteration, starts from last step's impulses (warm starting) and is
+//refined over a number of velocity iterations. Penetration is then removed by a few position iterations
+//instead of a velocity bias so the correction does not add energy.
+//Contacts are grouped by island, islands share no body that responds to impulses so they can be solved in any
+//order or at the same time and still give the same result.
+class ContactSolver2D
+{
+public:
+	ContactSolver2D() = default;
+	~ContactSolver2D() = default;
+
+	void Clear();
+	//Bodies are looked up through the contact's rigidbodies, only awake dynamic bodies respond and
+	//contacts between two bodies that do not are dropped
+	void AddContact(Collision2D const& contact, RigidbodyStorage2D const& storage);
+	int GetConstraintCount() const { return (int)m_constraints.size(); }
+	ContactConstraint2D const& GetConstraint(int index) const { return m_constraints[index]; }
+
+	//Links the responding bodies of every contact and reorders the contacts island by island,
+	//islands keeps the links afterwards. Call once after the last AddContact.
+	void BuildIslands(IslandBuilder2D& islands, int awakeCount);
+	int GetIslandCount() const { return (int)m_islandStarts.size() - 1; }
+	//Warm start followed by the velocity iterations
+	void SolveIslandVelocities(int islandIndex, RigidbodyStorage2D& storage, int iterations);
+	//Run after positions are integrated, stops early once every contact is within the allowed slop
+	void SolveIslandPositions(int islandIndex, RigidbodyStorage2D& storage, int iterations);
+	//Writes the accumulated impulses back to the cached contacts for the next step
+	void StoreImpulses(ContactCache2D& cache) const;
+
+public:
+	static constexpr float LINEAR_SLOP = 0.005f;				//penetration left alone so resting contacts stay touching
+	static constexpr float POSITION_CORRECTION_RATE = 0.2f;		//fraction of the remaining penetration removed per iteration
+	static constexpr float MAX_POSITION_CORRECTION = 0.2f;
+	static constexpr float RESTITUTION_VELOCITY_THRESHOLD = 1.f;	//slower impacts do not bounce, keeps stacks from jittering
+	static constexpr float MAX_BLOCK_CONDITION = 1000.f;			//above this the two points are nearly redundant and only one is kept
+
+public:
+	size_t GetMemoryUsage() const;
+
+private:
+	void WarmStart(RigidbodyStorage2D& storage, int begin, int end);
+	void SolveVelocities(RigidbodyStorage2D& storage, int begin, int end);
+	//returns true once every contact in the range is within the allowed slop
+	bool SolvePositions(RigidbodyStorage2D& storage, int begin, int end);
+
+private:
+	std::vector<ContactConstraint2D> m_constraints;
+	std::vector<ContactConstraint2D> m_sortedConstraints;	//scratch for BuildIslands
+	std::vector<int> m_constraintIslands;
+	std::vector<int> m_islandOfRoot;
+	std::vector<int> m_islandStarts = { 0 };					//island i owns constraints [start i, start i + 1)
+};
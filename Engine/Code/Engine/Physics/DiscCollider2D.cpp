@@ -22,8 +22,8 @@ void DiscCollider2D::UpdateWorldShape()
 	}
 	else
 	{
-		m_worldPosition = m_localPosition + m_rigidbody->m_worldPosition;
-		m_worldRotation = m_localRotation + m_rigidbody->m_RotationInRadians;
+		m_worldPosition = m_localPosition + m_rigidbody->GetPosition();
+		m_worldRotation = m_localRotation + m_rigidbody->GetRotation();
 	}
 	m_bound.m_center = m_worldPosition;
 }
@@ -43,6 +43,16 @@ bool DiscCollider2D::IntersectsPlane(Plane2D const& plane) const
 	return DoDiscPlaneOverlap(m_worldPosition, m_radius, plane);
 }
 
+bool DiscCollider2D::IntersectsAABB(AABB2 const& box) const
+{
+	return GetDistanceSquared2D(GetNearestPointOnAABB2D(m_worldPosition, box), m_worldPosition) < m_radius * m_radius;
+}
+
+bool DiscCollider2D::CastDisc(Vec2 const& start, float radius, Vec2 const& direction, float maxDistance, float& outDistance, Vec2& outNormal) const
+{
+	return RaycastVsDisc2D(start, direction, maxDistance, m_worldPosition, m_radius + radius, outDistance, outNormal);
+}
+
 void DiscCollider2D::AddVerticesToDebugRender(std::vector<Vertex_PCU>& vertices, Rgba8 const& borderColor, Rgba8 const& fillColor)
 {
 	std::vector<Vertex_PCU> discVertices;
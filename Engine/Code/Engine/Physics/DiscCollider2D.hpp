@@ -12,6 +12,8 @@ public: // implement the interface of Collider2D
 	//virtual bool Intersects(Collider2D const* other) const override;
 	virtual void AddVerticesToDebugRender(std::vector<Vertex_PCU>& vertices, Rgba8 const& borderColor, Rgba8 const& fillColor) override;
 	virtual bool IntersectsPlane(Plane2D const& plane) const override;
+	virtual bool IntersectsAABB(AABB2 const& box) const override;
+	virtual bool CastDisc(Vec2 const& start, float radius, Vec2 const& direction, float maxDistance, float& outDistance, Vec2& outNormal) const override;
 	virtual float GetRadius() const override { return m_radius; };
 	virtual float CalculateMoment(float mass) override;
 public:
@@ -0,0 +1,36 @@
+#include "Engine/Physics/IslandBuilder2D.hpp"
+
+void IslandBuilder2D::Reset(int bodyCount)
+{
+	m_parents.resize(bodyCount);
+	for (int body = 0; body < bodyCount; ++body)
+	{
+		m_parents[body] = body;
+	}
+}
+
+void IslandBuilder2D::Link(int bodyA, int bodyB)
+{
+	int rootA = FindRoot(bodyA);
+	int rootB = FindRoot(bodyB);
+	//lower index wins so the root does not depend on contact order
+	if (rootA < rootB)
+	{
+		m_parents[rootB] = rootA;
+	}
+	else if (rootB < rootA)
+	{
+		m_parents[rootA] = rootB;
+	}
+}
+
+int IslandBuilder2D::FindRoot(int body)
+{
+	//path halving, every other node on the way skips to its grandparent
+	while (m_parents[body] != body)
+	{
+		m_parents[body] = m_parents[m_parents[body]];
+		body = m_parents[body];
+	}
+	return body;
+}
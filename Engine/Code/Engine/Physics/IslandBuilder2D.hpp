@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+//Groups bodies that touch into islands with a union-find over body indices. Rebuilt every step from the
+//solver's contacts, bodies that touch only through static or kinematic bodies stay in separate islands.
+class IslandBuilder2D
+{
+public:
+	IslandBuilder2D() = default;
+	~IslandBuilder2D() = default;
+
+	//Every body starts as its own island
+	void Reset(int bodyCount);
+	void Link(int bodyA, int bodyB);
+	//The same root for every body in an island, compresses the path on the way
+	int FindRoot(int body);
+	size_t GetMemoryUsage() const { return m_parents.capacity() * sizeof(int); }
+
+private:
+	std::vector<int> m_parents;
+};
@@ -3,26 +3,22 @@
 #include "Engine/Physics/Collider2D.hpp"
 #include "Engine/Physics/DiscCollider2D.hpp"
 #include "Engine/Physics/PolygonCollider2D.hpp"
+#include "Engine/Physics/TimeOfImpact2D.hpp"
+#include "Engine/Physics/PhysicsSnapshot2D.hpp"
 #include "Engine/Math/Plane2D.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Renderer/DebugRender.hpp"
 #include "Engine/Math/Vec3.hpp"
+#include <algorithm>
 
-Collision2D Collision2D::GetInversed()
-{
-	Collision2D invCollision;
-	invCollision.manifold.contactNormal = -manifold.contactNormal;
-	invCollision.me = them;
-	invCollision.them = me;
-	invCollision.m_colliderID = m_colliderID;
-	invCollision.m_frameId = m_frameId;
-	return invCollision;
-}
-
-Physics2D::Physics2D()
+Physics2D::Physics2D(eBroadphaseType broadphaseType, JobSystem* jobSystem)
+	: m_jobSystem(jobSystem)
 {
 	m_ground = new Plane2D(Vec2(0.f, 1.f), 0.f);
+	m_broadphase = Broadphase2D::CreateBroadphase(broadphaseType);
 	for (int i = 0; i < 32; ++i)
 	{
 		m_layerInteractions[i] = 0xffffffff;
@@ -32,17 +28,19 @@ Physics2D::~Physics2D()
 {
 	delete m_ground;
 	m_ground = nullptr;
-	for (int rigidbodyIndex = 0; rigidbodyIndex < m_rigidbodies.size(); rigidbodyIndex++)
+	//the pools only give back their blocks, the objects still in them are destroyed here
+	for (int bodyIndex = 0; bodyIndex < m_bodyStorage.GetCount(); bodyIndex++)
 	{
-		delete m_rigidbodies[rigidbodyIndex];
+		FreeRigidbody(m_bodyStorage.GetOwner(bodyIndex));
 	}
 
 	for (int colliderIndex = 0; colliderIndex < m_colliders.size(); colliderIndex++)
 	{
-		delete m_colliders[colliderIndex];
+		FreeCollider(m_colliders[colliderIndex]);
 	}
-	m_rigidbodies.clear();
 	m_colliders.clear();
+	delete m_broadphase;
+	m_broadphase = nullptr;
 }
 
 void Physics2D::BeginFrame()
@@ -51,83 +49,330 @@ void Physics2D::BeginFrame()
 void Physics2D::Update()
 {
 	while (m_stepTimer.CheckAndDecrement()) {
-		AdvanceSimulation((float)m_fixedDeltaTime);
-		++m_frameId;
+		Step();
 	}
 }
 
+void Physics2D::Step()
+{
+	AdvanceSimulation((float)m_fixedDeltaTime);
+	++m_frameId;
+}
+
 void Physics2D::AdvanceSimulation(float deltaSeconds)
 {
+	//contacts are found before moving so the solver can stop approaching bodies before they sink in
+	double effectorStart = GetCurrentTimeSeconds();
 	ApplyEffectors(deltaSeconds);
-	MoveRigidbodies(deltaSeconds);
+	double detectStart = GetCurrentTimeSeconds();
 	DetectCollisions();
+	double resolveStart = GetCurrentTimeSeconds();
 	ResolveCollisions();
+	double moveStart = GetCurrentTimeSeconds();
+	MoveRigidbodies(deltaSeconds);
+	double sleepStart = GetCurrentTimeSeconds();
+	UpdateSleep(deltaSeconds);
+	//whatever a continuous sweep hit while it slept
+	WakeQueuedIslands();
+	double cleanupStart = GetCurrentTimeSeconds();
 	CleanupDestroyedObjects();
+	double stepEnd = GetCurrentTimeSeconds();
+
+	++m_stats.m_stepCount;
+	m_stats.m_effectorSeconds += detectStart - effectorStart;
+	m_stats.m_detectSeconds += resolveStart - detectStart;
+	m_stats.m_resolveSeconds += moveStart - resolveStart;
+	m_stats.m_moveSeconds += sleepStart - moveStart;
+	m_stats.m_sleepSeconds += cleanupStart - sleepStart;
+	m_stats.m_cleanupSeconds += stepEnd - cleanupStart;
+	m_stats.m_peakMemoryBytes = std::max(m_stats.m_peakMemoryBytes, GetMemoryUsage());
+}
+
+size_t Physics2D::GetMemoryUsage() const
+{
+	size_t scratchBytes = GetCapacityBytes(m_unresolvedCollisions) + GetCapacityBytes(m_islandSleepTimes) +
+		GetCapacityBytes(m_bodiesToSleep) + GetCapacityBytes(m_islandsToWake) + GetCapacityBytes(m_sleepingPairs) +
+		GetCapacityBytes(m_activePairs) + GetCapacityBytes(m_activeManifolds) + GetCapacityBytes(m_activeTouching) +
+		GetCapacityBytes(m_sweepCandidates) + GetCapacityBytes(m_sweepPoints) + GetCapacityBytes(m_beginContacts) +
+		GetCapacityBytes(m_stayContacts) + GetCapacityBytes(m_endContacts) + GetCapacityBytes(m_destroyedRigidbodies) +
+		GetCapacityBytes(m_destroyedColliders);
+	//each cached contact is listed by both of its colliders
+	size_t contactKeyBytes = (size_t)m_contactCache.GetCount() * 2 * sizeof(uint64_t);
+	return m_rigidbodyPool.GetMemoryUsage() + m_discColliderPool.GetMemoryUsage() + m_polygonColliderPool.GetMemoryUsage() +
+		GetCapacityBytes(m_colliders) + m_bodyStorage.GetMemoryUsage() + m_shapeArena.GetMemoryUsage() +
+		m_contactCache.GetMemoryUsage() + m_contactSolver.GetMemoryUsage() + m_islandBuilder.GetMemoryUsage() + m_broadphase->GetMemoryUsage() + contactKeyBytes + scratchBytes;
 }
 
 void Physics2D::ApplyEffectors(float deltaSeconds)
 {
-	Vec2 frameGravityAcceleration = m_gravity * deltaSeconds;
-	for (int rigidbodyIndex = 0; rigidbodyIndex < m_rigidbodies.size(); ++rigidbodyIndex)
+	m_bodyStorage.IntegrateVelocities(m_gravity, deltaSeconds);
+}
+
+void Physics2D::MoveRigidbodies(float deltaSeconds)
+{
+	m_bodyStorage.IntegratePositions(deltaSeconds);
+	SweepContinuousBodies(deltaSeconds);
+	//push apart what the velocity pass left overlapping, before colliders are refit to the final positions
+	auto solveIslandPositions = [this](int islandIndex)
+	{
+		m_contactSolver.SolveIslandPositions(islandIndex, m_bodyStorage, m_positionIterations);
+	};
+	if (m_jobSystem != nullptr)
+	{
+		m_jobSystem->ParallelFor(0, m_contactSolver.GetIslandCount(), ISLANDS_PER_JOB, solveIslandPositions);
+	}
+	else
+	{
+		for (int islandIndex = 0; islandIndex < m_contactSolver.GetIslandCount(); ++islandIndex)
+		{
+			solveIslandPositions(islandIndex);
+		}
+	}
+	for (int bodyIndex = 0; bodyIndex < m_bodyStorage.GetAwakeCount(); ++bodyIndex)
+	{
+		if (!m_bodyStorage.IsMovable(bodyIndex))
+		{
+			continue;
+		}
+		++m_bodyStorage.m_transformVersions[bodyIndex];
+		Collider2D* collider = m_bodyStorage.m_colliders[bodyIndex];
+		if (collider != nullptr)
+		{
+			collider->UpdateWorldShape();
+			RefitCollider(collider);
+		}
+	}
+}
+
+void Physics2D::SweepContinuousBodies(float deltaSeconds)
+{
+	//bodies hit while asleep are only queued, the islands built this step still index the awake range
+	for (int bodyIndex = 0; bodyIndex < m_bodyStorage.GetAwakeCount(); ++bodyIndex)
 	{
-		Rigidbody2D* rigidbody = m_rigidbodies[rigidbodyIndex];
-		//update start position here
-		rigidbody->m_startPosition = rigidbody->m_worldPosition;
-		if (rigidbody->m_physicsEnabled)
+		Collider2D* collider = m_bodyStorage.m_colliders[bodyIndex];
+		if (m_bodyStorage.m_continuousEnabled[bodyIndex] == 0 || !m_bodyStorage.IsMovable(bodyIndex) ||
+			m_bodyStorage.m_mode[bodyIndex] != DYNAMIC || collider == nullptr || collider->m_isTrigger)
 		{
-			if (rigidbody->m_mode == DYNAMIC)
+			continue;
+		}
+		SweepContinuousBody(bodyIndex, deltaSeconds);
+	}
+}
+
+void Physics2D::SweepContinuousBody(int bodyIndex, float deltaSeconds)
+{
+	Collider2D* collider = m_bodyStorage.m_colliders[bodyIndex];
+	Rigidbody2D* rigidbody = m_bodyStorage.GetOwner(bodyIndex);
+	Vec2 velocity(m_bodyStorage.m_velocityX[bodyIndex], m_bodyStorage.m_velocityY[bodyIndex]);
+	float angularVelocity = m_bodyStorage.m_angularVelocity[bodyIndex];
+	float radius = collider->GetRadius();
+	float travel = (velocity * deltaSeconds).GetLength() + fabsf(angularVelocity * deltaSeconds) * radius;
+	if (travel < radius * CONTINUOUS_MOTION_FRACTION)
+	{
+		//too slow to pass through anything, the integrated pose stands
+		return;
+	}
+
+	//the collider has not been refit yet, so it still sits where the body started the step
+	ColliderSweep2D const startSweep = GetColliderSweep(collider);
+	ColliderSweep2D sweep = startSweep;
+	float remainingSeconds = deltaSeconds;
+	bool isHit = false;
+	for (int substep = 0; substep < MAX_CONTINUOUS_SUBSTEPS && remainingSeconds > 0.f; ++substep)
+	{
+		sweep.m_translation = velocity * remainingSeconds;
+		sweep.m_rotationRadians = angularVelocity * remainingSeconds;
+
+		Vec2 sweepEnd = sweep.m_startPosition + sweep.m_translation;
+		AABB2 sweepBounds;
+		sweepBounds.mins = Vec2(fminf(sweep.m_startPosition.x, sweepEnd.x) - radius, fminf(sweep.m_startPosition.y, sweepEnd.y) - radius);
+		sweepBounds.maxs = Vec2(fmaxf(sweep.m_startPosition.x, sweepEnd.x) + radius, fmaxf(sweep.m_startPosition.y, sweepEnd.y) + radius);
+		m_sweepCandidates.clear();
+		m_broadphase->QueryBounds(sweepBounds, m_sweepCandidates);
+
+		TimeOfImpact2D impact;
+		Collider2D* impactCollider = nullptr;
+		for (Collider2D* other : m_sweepCandidates)
+		{
+			if (other == collider || other->m_isDestroyed || other->m_isTrigger || other->m_rigidbody == nullptr ||
+				!DoLayersInteract(rigidbody->m_layer, other->m_rigidbody->m_layer))
 			{
-				rigidbody->ApplyDragForce();
-				Vec2 frameOtherAcceleration = (rigidbody->m_nonGravityForces / rigidbody->m_mass) * deltaSeconds;
-				rigidbody->SetVelocity(rigidbody->m_velocity + frameGravityAcceleration + frameOtherAcceleration);
+				continue;
 			}
-			else if (rigidbody->m_mode == STATIC)
+			TimeOfImpact2D toi = GetTimeOfImpact(collider, sweep, other, ContactSolver2D::LINEAR_SLOP, m_sweepPoints);
+			if (toi.m_fraction < impact.m_fraction)
 			{
-				rigidbody->SetVelocity(Vec2::ZERO);
+				impact = toi;
+				impactCollider = other;
 			}
 		}
-		else
+		if (impactCollider == nullptr)
+		{
+			sweep.m_startPosition += sweep.m_translation;
+			sweep.m_startRadians += sweep.m_rotationRadians;
+			break;
+		}
+
+		isHit = true;
+		sweep.m_startPosition += sweep.m_translation * impact.m_fraction;
+		sweep.m_startRadians += sweep.m_rotationRadians * impact.m_fraction;
+		remainingSeconds *= 1.f - impact.m_fraction;
+
+		//linear impulse along the normal only, whatever spin the impact should add is left to the discrete contact next step
+		Rigidbody2D* otherRigidbody = impactCollider->m_rigidbody;
+		bool isOtherMoving = otherRigidbody->IsPhysicsEnabled() && otherRigidbody->GetSimulationMode() != STATIC;
+		bool isOtherDynamic = isOtherMoving && otherRigidbody->GetSimulationMode() == DYNAMIC;
+		Vec2 otherVelocity = isOtherMoving ? otherRigidbody->GetVelocity() : Vec2::ZERO;
+		float normalSpeed = DotProduct2D(velocity - otherVelocity, impact.m_normal);
+		if (normalSpeed >= 0.f)
+		{
+			continue;
+		}
+		float restitution = (-normalSpeed > ContactSolver2D::RESTITUTION_VELOCITY_THRESHOLD) ? collider->GetBounceWith(impactCollider) : 0.f;
+		float inverseMass = 1.f / m_bodyStorage.m_mass[bodyIndex];
+		float otherInverseMass = isOtherDynamic ? 1.f / otherRigidbody->GetMass() : 0.f;
+		float impulse = -(1.f + restitution) * normalSpeed / (inverseMass + otherInverseMass);
+		velocity += impact.m_normal * (impulse * inverseMass);
+		if (isOtherDynamic)
 		{
-			rigidbody->SetVelocity(Vec2::ZERO);
+			//written in place, a sleeper keeps its index until its island wakes after UpdateSleep
+			int otherIndex = otherRigidbody->GetIndex();
+			Vec2 otherNewVelocity = otherVelocity - impact.m_normal * (impulse * otherInverseMass);
+			m_bodyStorage.m_velocityX[otherIndex] = otherNewVelocity.x;
+			m_bodyStorage.m_velocityY[otherIndex] = otherNewVelocity.y;
+			if (!m_bodyStorage.IsAwake(otherIndex) && m_bodyStorage.m_islandIDs[otherIndex] != -1)
+			{
+				m_islandsToWake.push_back(m_bodyStorage.m_islandIDs[otherIndex]);
+			}
 		}
 	}
+	if (!isHit)
+	{
+		return;
+	}
+
+	Vec2 startPosition(m_bodyStorage.m_startPositionX[bodyIndex], m_bodyStorage.m_startPositionY[bodyIndex]);
+	Vec2 position = startPosition + (sweep.m_startPosition - startSweep.m_startPosition);
+	float rotation = m_bodyStorage.m_rotation[bodyIndex] - m_bodyStorage.m_angularVelocity[bodyIndex] * deltaSeconds +
+		(sweep.m_startRadians - startSweep.m_startRadians);
+	float const twoPi = 2 * 3.14159f;
+	while (rotation < 0.f)
+	{
+		rotation += twoPi;
+	}
+	while (rotation > twoPi)
+	{
+		rotation -= twoPi;
+	}
+	m_bodyStorage.m_positionX[bodyIndex] = position.x;
+	m_bodyStorage.m_positionY[bodyIndex] = position.y;
+	m_bodyStorage.m_rotation[bodyIndex] = rotation;
+	m_bodyStorage.m_velocityX[bodyIndex] = velocity.x;
+	m_bodyStorage.m_velocityY[bodyIndex] = velocity.y;
 }
 
-void Physics2D::MoveRigidbodies(float deltaSeconds)
+void Physics2D::UpdateSleep(float deltaSeconds)
 {
-	for (int rigidbodyIndex = 0; rigidbodyIndex < m_rigidbodies.size(); ++rigidbodyIndex)
+	if (!m_isSleepEnabled)
 	{
-		Rigidbody2D* rigidbody = m_rigidbodies[rigidbodyIndex];
-		if (rigidbody->m_mode == STATIC || !rigidbody->m_physicsEnabled)
+		return;
+	}
+	m_bodyStorage.UpdateSleepTimers(deltaSeconds);
+
+	//islands were linked by the solver this step, nothing woke or slept since so the indices still match
+	int awakeCount = m_bodyStorage.GetAwakeCount();
+
+	//an island sleeps only once its most recently moving body has been still long enough
+	m_islandSleepTimes.assign(awakeCount, RigidbodyStorage2D::TIME_TO_SLEEP);
+	for (int bodyIndex = 0; bodyIndex < awakeCount; ++bodyIndex)
+	{
+		float& islandSleepTime = m_islandSleepTimes[m_islandBuilder.FindRoot(bodyIndex)];
+		islandSleepTime = std::min(islandSleepTime, m_bodyStorage.m_sleepTime[bodyIndex]);
+	}
+
+	//sleeping moves bodies around, so everything is picked by handle before the first one goes
+	m_bodiesToSleep.clear();
+	for (int bodyIndex = 0; bodyIndex < awakeCount; ++bodyIndex)
+	{
+		int root = m_islandBuilder.FindRoot(bodyIndex);
+		if (m_islandSleepTimes[root] >= RigidbodyStorage2D::TIME_TO_SLEEP)
 		{
-			continue;
+			m_bodiesToSleep.push_back(IntVec2(m_bodyStorage.GetOwner(bodyIndex)->m_handle, m_bodyStorage.GetOwner(root)->m_handle));
 		}
-		rigidbody->SetPosition(rigidbody->m_worldPosition + rigidbody->m_velocity * deltaSeconds);
-		rigidbody->SetRotation(rigidbody->m_RotationInRadians + rigidbody->m_angularVelocity * deltaSeconds);
+	}
+	for (IntVec2 const& body : m_bodiesToSleep)
+	{
+		m_bodyStorage.Sleep(m_bodyStorage.GetIndex(body.x), body.y);
 	}
 }
 
 void Physics2D::CleanupDestroyedObjects()
 {
-	for (int rigidbodyIndex = 0; rigidbodyIndex < m_rigidbodies.size(); rigidbodyIndex++)
+	if (m_destroyedColliders.empty() && m_destroyedRigidbodies.empty())
+	{
+		return;
+	}
+
+	//cached contacts must not outlive their colliders, each destroyed collider knows its own
+	for (Collider2D* collider : m_destroyedColliders)
 	{
-		if (m_rigidbodies[rigidbodyIndex]->m_isDestroyed)
+		while (!collider->m_contactKeys.empty())
 		{
-			delete m_rigidbodies[rigidbodyIndex];
-			m_rigidbodies.erase(m_rigidbodies.begin() + rigidbodyIndex);
-			rigidbodyIndex--;
+			uint64_t contactKey = collider->m_contactKeys.back();
+			Collision2D const* contact = m_contactCache.Find(contactKey);
+			//whatever rested on the destroyed collider has to fall again
+			Collider2D* survivor = (contact->me == collider) ? contact->them : contact->me;
+			if (!survivor->m_isDestroyed && !survivor->m_rigidbody->m_isDestroyed && !survivor->m_rigidbody->IsAwake())
+			{
+				int islandID = m_bodyStorage.m_islandIDs[survivor->m_rigidbody->GetIndex()];
+				if (islandID != -1)
+				{
+					m_islandsToWake.push_back(islandID);
+				}
+			}
+			UncacheContact(contactKey);
 		}
 	}
+	WakeQueuedIslands();
+	//swap and pop, the last collider takes the freed spot
+	for (Collider2D* collider : m_destroyedColliders)
+	{
+		if (collider->m_proxyID != -1)
+		{
+			m_broadphase->DestroyProxy(collider->m_proxyID);
+		}
+		Collider2D* last = m_colliders.back();
+		m_colliders[collider->m_colliderIndex] = last;
+		last->m_colliderIndex = collider->m_colliderIndex;
+		m_colliders.pop_back();
+		FreeCollider(collider);
+	}
+	m_destroyedColliders.clear();
+	//after the contacts, the survivor check above still reads the destroyed bodies
+	for (Rigidbody2D* rigidbody : m_destroyedRigidbodies)
+	{
+		m_bodyStorage.Remove(rigidbody->m_handle);
+		FreeRigidbody(rigidbody);
+	}
+	m_destroyedRigidbodies.clear();
+	if (m_shapeArena.NeedsCompact())
+	{
+		CompactShapeArena();
+	}
+}
 
-	for (int colliderIndex = 0; colliderIndex < m_colliders.size(); colliderIndex++)
+void Physics2D::CompactShapeArena()
+{
+	m_shapeArena.BeginCompact();
+	for (int colliderIndex = 0; colliderIndex < (int)m_colliders.size(); ++colliderIndex)
 	{
-		if (m_colliders[colliderIndex]->m_isDestroyed)
+		if (m_colliders[colliderIndex]->m_type == COLLIDER2D_POLYGON)
 		{
-			delete m_colliders[colliderIndex];
-			m_colliders.erase(m_colliders.begin() + colliderIndex);
-			colliderIndex--;
+			PolygonCollider2D* polygon = (PolygonCollider2D*)m_colliders[colliderIndex];
+			polygon->m_shapeOffset = m_shapeArena.Keep(polygon->m_shapeOffset, polygon->GetVertexCount());
 		}
 	}
+	m_shapeArena.EndCompact();
 }
 
 void Physics2D::EndFrame()
@@ -140,58 +385,472 @@ void Physics2D::SetGroundHeight(float height)
 
 Rigidbody2D* Physics2D::CreateRigidbody()
 {
-	Rigidbody2D* rigidbody = new Rigidbody2D(this);
-	m_rigidbodies.push_back(rigidbody);
+	PoolHandle poolHandle;
+	Rigidbody2D* rigidbody = new (m_rigidbodyPool.Allocate(poolHandle)) Rigidbody2D(this);
+	rigidbody->m_poolHandle = poolHandle;
+	rigidbody->m_handle = m_bodyStorage.Add(rigidbody);
 	return rigidbody;
 }
 
 void Physics2D::DestroyRigidbody(Rigidbody2D* rb)
 {
-	rb->MarkAsDestroyed();
+	if (!rb->m_isDestroyed)
+	{
+		rb->MarkAsDestroyed();
+		m_destroyedRigidbodies.push_back(rb);
+	}
+}
+
+Rigidbody2D* Physics2D::GetRigidbody(PoolHandle const& handle) const
+{
+	Rigidbody2D* rigidbody = m_rigidbodyPool.Get(handle);
+	return (rigidbody != nullptr && !rigidbody->m_isDestroyed) ? rigidbody : nullptr;
 }
 
 DiscCollider2D* Physics2D::CreateDiscCollider(Vec2 localPosition, float radius)
 {
-	DiscCollider2D* collider = new DiscCollider2D(this, localPosition, radius);
-	collider->m_id = m_colliderId;
-	++m_colliderId;
-	m_colliders.push_back(collider);
+	PoolHandle poolHandle;
+	DiscCollider2D* collider = new (m_discColliderPool.Allocate(poolHandle)) DiscCollider2D(this, localPosition, radius);
+	collider->m_poolHandle = poolHandle;
+	AddCollider(collider);
 	return collider;
 }
 
 PolygonCollider2D* Physics2D::CreatePolygonCollider(Vec2 localPosition, std::vector<Vec2> const& points, bool isGiftWrapping)
 {
-	PolygonCollider2D* collider = new PolygonCollider2D(this, localPosition, points, isGiftWrapping);
+	PoolHandle poolHandle;
+	PolygonCollider2D* collider = new (m_polygonColliderPool.Allocate(poolHandle)) PolygonCollider2D(this, localPosition, points, isGiftWrapping);
+	collider->m_poolHandle = poolHandle;
+	AddCollider(collider);
+	return collider;
+}
+
+void Physics2D::DestroyCollider(Collider2D* collider)
+{
+	if (!collider->m_isDestroyed)
+	{
+		collider->MarkAsDestroyed();
+		m_destroyedColliders.push_back(collider);
+	}
+}
+
+Collider2D* Physics2D::GetCollider(eCollider2DType type, PoolHandle const& handle) const
+{
+	Collider2D* collider = nullptr;
+	if (type == COLLIDER2D_DISC)
+	{
+		collider = m_discColliderPool.Get(handle);
+	}
+	else
+	{
+		collider = m_polygonColliderPool.Get(handle);
+	}
+	return (collider != nullptr && !collider->m_isDestroyed) ? collider : nullptr;
+}
+
+void Physics2D::AddCollider(Collider2D* collider)
+{
 	collider->m_id = m_colliderId;
 	++m_colliderId;
+	collider->m_colliderIndex = (int)m_colliders.size();
 	m_colliders.push_back(collider);
-	return collider;
+	RefitCollider(collider);
 }
 
-void Physics2D::DestroyCollider(Collider2D* collider)
+void Physics2D::FreeCollider(Collider2D* collider)
 {
-	collider->MarkAsDestroyed();
+	PoolHandle poolHandle = collider->m_poolHandle;
+	eCollider2DType type = collider->m_type;
+	collider->~Collider2D();
+	if (type == COLLIDER2D_DISC)
+	{
+		m_discColliderPool.Free(poolHandle);
+	}
+	else
+	{
+		m_polygonColliderPool.Free(poolHandle);
+	}
+}
+
+void Physics2D::FreeRigidbody(Rigidbody2D* rigidbody)
+{
+	PoolHandle poolHandle = rigidbody->m_poolHandle;
+	rigidbody->~Rigidbody2D();
+	m_rigidbodyPool.Free(poolHandle);
+}
+
+void Physics2D::RefitCollider(Collider2D* collider)
+{
+	if (collider->m_proxyID == -1)
+	{
+		collider->m_proxyID = m_broadphase->CreateProxy(collider->GetWorldAABB(), collider);
+	}
+	else
+	{
+		m_broadphase->MoveProxy(collider->m_proxyID, collider->GetWorldAABB());
+	}
 }
 
 void Physics2D::DetectAllCollisionsFor(Collider2D* collider)
 {
-	if (collider->m_rigidbody->m_mode == STATIC)
+	if (collider->m_rigidbody->GetSimulationMode() == STATIC)
 	{
 		return;
 	}
 	for (int colliderIndex = 0; colliderIndex < m_colliders.size(); ++colliderIndex)
 	{
-		if (collider != m_colliders[colliderIndex] && collider->Intersects(m_colliders[colliderIndex]))
+		manifold2 manifold;
+		if (collider != m_colliders[colliderIndex] && collider->GetContact(m_colliders[colliderIndex], manifold))
 		{
 			Collision2D collision;
-			manifold2 manifold = collider->GetManifold(m_colliders[colliderIndex]);
 			collision.me = collider;
 			collision.them = m_colliders[colliderIndex];
-			m_unresolvedCollisions.push(collision);
+			m_unresolvedCollisions.push_back(collision);
 		}
 	}
 }
 
+static void RefreshCachedShape(Collider2D const* collider)
+{
+	if (collider->m_type == COLLIDER2D_POLYGON)
+	{
+		((PolygonCollider2D const*)collider)->RefreshWorldShape();
+	}
+}
+
+static bool IsInLayerMask(Collider2D const* collider, unsigned int layerMask)
+{
+	unsigned int layer = (collider->m_rigidbody != nullptr) ? collider->m_rigidbody->m_layer : 0;
+	return (layerMask & (1u << layer)) != 0;
+}
+
+//What a cast carries through the broadphase callback
+struct CastQuery2D
+{
+	Vec2 m_start;
+	Vec2 m_direction;
+	float m_radius = 0.f;
+	unsigned int m_layerMask = 0;
+	RaycastHit2D* m_hit = nullptr;
+};
+
+static float CastAgainstCollider(void* context, Collider2D* collider, float maxDistance)
+{
+	CastQuery2D const* query = (CastQuery2D const*)context;
+	float distance = 0.f;
+	Vec2 normal;
+	if (collider->m_isDestroyed || collider->m_isTrigger || !IsInLayerMask(collider, query->m_layerMask) ||
+		!collider->CastDisc(query->m_start, query->m_radius, query->m_direction, maxDistance, distance, normal))
+	{
+		return maxDistance;
+	}
+	query->m_hit->m_collider = collider;
+	query->m_hit->m_distance = distance;
+	query->m_hit->m_normal = normal;
+	query->m_hit->m_point = (distance == 0.f) ? query->m_start : query->m_start + query->m_direction * distance - normal * query->m_radius;
+	return distance;
+}
+
+struct OverlapQuery2D
+{
+	AABB2 m_bounds;
+	Vec2 m_point;
+	bool m_isPoint = false;
+	unsigned int m_layerMask = 0;
+	Collider2D** m_colliders = nullptr;
+	int m_maxColliders = 0;
+	int m_colliderCount = 0;
+};
+
+static bool OverlapCollider(void* context, Collider2D* collider)
+{
+	OverlapQuery2D* query = (OverlapQuery2D*)context;
+	if (collider->m_isDestroyed || !IsInLayerMask(collider, query->m_layerMask))
+	{
+		return true;
+	}
+	if (query->m_isPoint ? collider->Contains(query->m_point) : collider->IntersectsAABB(query->m_bounds))
+	{
+		query->m_colliders[query->m_colliderCount++] = collider;
+	}
+	return query->m_colliderCount < query->m_maxColliders;
+}
+
+bool Physics2D::Raycast(Vec2 const& start, Vec2 const& direction, float maxDistance, RaycastHit2D& outHit, unsigned int layerMask) const
+{
+	return CastDisc(start, 0.f, direction, maxDistance, outHit, layerMask);
+}
+
+bool Physics2D::CastDisc(Vec2 const& start, float radius, Vec2 const& direction, float maxDistance, RaycastHit2D& outHit, unsigned int layerMask) const
+{
+	CastQuery2D query;
+	query.m_start = start;
+	query.m_direction = direction.GetNormalized();
+	query.m_radius = radius;
+	query.m_layerMask = layerMask;
+	query.m_hit = &outHit;
+	outHit = RaycastHit2D();
+	m_broadphase->QueryRay(start, query.m_direction, maxDistance, radius, CastAgainstCollider, &query);
+	return outHit.m_collider != nullptr;
+}
+
+int Physics2D::OverlapAABB(AABB2 const& bounds, Collider2D** outColliders, int maxColliders, unsigned int layerMask) const
+{
+	if (maxColliders <= 0)
+	{
+		return 0;
+	}
+	OverlapQuery2D query;
+	query.m_bounds = bounds;
+	query.m_layerMask = layerMask;
+	query.m_colliders = outColliders;
+	query.m_maxColliders = maxColliders;
+	m_broadphase->QueryBounds(bounds, OverlapCollider, &query);
+	return query.m_colliderCount;
+}
+
+int Physics2D::OverlapPoint(Vec2 const& point, Collider2D** outColliders, int maxColliders, unsigned int layerMask) const
+{
+	if (maxColliders <= 0)
+	{
+		return 0;
+	}
+	OverlapQuery2D query;
+	query.m_bounds = AABB2(point, point);
+	query.m_point = point;
+	query.m_isPoint = true;
+	query.m_layerMask = layerMask;
+	query.m_colliders = outColliders;
+	query.m_maxColliders = maxColliders;
+	m_broadphase->QueryBounds(query.m_bounds, OverlapCollider, &query);
+	return query.m_colliderCount;
+}
+
+void Physics2D::RaycastBatch(Raycast2D const* rays, int rayCount, RaycastHit2D* outHits, unsigned int layerMask) const
+{
+	//polygon shapes are rebuilt lazily, so bring them all up to date before the rays only read them
+	for (Collider2D const* collider : m_colliders)
+	{
+		RefreshCachedShape(collider);
+	}
+	auto castRay = [this, rays, outHits, layerMask](int rayIndex)
+	{
+		Raycast(rays[rayIndex].m_start, rays[rayIndex].m_direction, rays[rayIndex].m_maxDistance, outHits[rayIndex], layerMask);
+	};
+	if (m_jobSystem != nullptr)
+	{
+		m_jobSystem->ParallelFor(0, rayCount, RAYS_PER_JOB, castRay);
+	}
+	else
+	{
+		for (int rayIndex = 0; rayIndex < rayCount; ++rayIndex)
+		{
+			castRay(rayIndex);
+		}
+	}
+}
+
+//Collider pose as it is in memory, polygon bounding discs are moved incrementally and could not be recomputed bit for bit
+struct ColliderSnapshot2D
+{
+	Collider2D* m_collider = nullptr;
+	unsigned int m_generation = 0;		//a new collider in the same pool slot has another one
+	float m_worldPositionX = 0.f;
+	float m_worldPositionY = 0.f;
+	float m_worldRotation = 0.f;
+	float m_boundCenterX = 0.f;
+	float m_boundCenterY = 0.f;
+	float m_boundRadius = 0.f;
+};
+
+//Colliders are stored as their index in m_colliders, which a snapshot only loads into when it matches.
+//Key and collider ids are left out, they follow from the two colliders.
+struct ContactSnapshot2D
+{
+	int m_meIndex = -1;
+	int m_themIndex = -1;
+	float m_edge[4] = {};
+	float m_normal[2] = {};
+	float m_penetration = 0.f;
+	int m_frameId = 0;
+	float m_normalImpulses[Collision2D::MAX_CONTACT_POINTS] = {};
+	float m_tangentImpulses[Collision2D::MAX_CONTACT_POINTS] = {};
+};
+
+static ColliderSnapshot2D GetColliderSnapshot(Collider2D const* collider)
+{
+	ColliderSnapshot2D snapshot;
+	snapshot.m_collider = (Collider2D*)collider;
+	snapshot.m_generation = collider->m_poolHandle.m_generation;
+	Vec2 worldPosition;
+	if (collider->m_type == COLLIDER2D_DISC)
+	{
+		worldPosition = ((DiscCollider2D const*)collider)->m_worldPosition;
+		snapshot.m_worldRotation = ((DiscCollider2D const*)collider)->m_worldRotation;
+	}
+	else
+	{
+		worldPosition = ((PolygonCollider2D const*)collider)->m_worldPosition;
+		snapshot.m_worldRotation = ((PolygonCollider2D const*)collider)->m_worldRotation;
+	}
+	snapshot.m_worldPositionX = worldPosition.x;
+	snapshot.m_worldPositionY = worldPosition.y;
+	snapshot.m_boundCenterX = collider->m_bound.m_center.x;
+	snapshot.m_boundCenterY = collider->m_bound.m_center.y;
+	snapshot.m_boundRadius = collider->m_bound.m_radius;
+	return snapshot;
+}
+
+void Physics2D::SaveState(std::vector<unsigned char>& outBuffer) const
+{
+	PhysicsSnapshotWriter2D writer(outBuffer);
+	writer.Write(SNAPSHOT_VERSION);
+	writer.Write(m_frameId);
+	writer.Write((int)m_colliders.size());
+	for (Collider2D const* collider : m_colliders)
+	{
+		writer.Write(GetColliderSnapshot(collider));
+	}
+	m_bodyStorage.SaveState(writer);
+
+	writer.Write(m_contactCache.GetCount());
+	for (int contactIndex = 0; contactIndex < m_contactCache.GetCount(); ++contactIndex)
+	{
+		Collision2D const& contact = m_contactCache.GetContact(contactIndex);
+		ContactSnapshot2D snapshot;
+		snapshot.m_meIndex = contact.me->m_colliderIndex;
+		snapshot.m_themIndex = contact.them->m_colliderIndex;
+		snapshot.m_edge[0] = contact.manifold.contactEdge.pointA.x;
+		snapshot.m_edge[1] = contact.manifold.contactEdge.pointA.y;
+		snapshot.m_edge[2] = contact.manifold.contactEdge.pointB.x;
+		snapshot.m_edge[3] = contact.manifold.contactEdge.pointB.y;
+		snapshot.m_normal[0] = contact.manifold.contactNormal.x;
+		snapshot.m_normal[1] = contact.manifold.contactNormal.y;
+		snapshot.m_penetration = contact.manifold.penetration;
+		snapshot.m_frameId = contact.m_frameId;
+		for (int pointIndex = 0; pointIndex < Collision2D::MAX_CONTACT_POINTS; ++pointIndex)
+		{
+			snapshot.m_normalImpulses[pointIndex] = contact.m_normalImpulses[pointIndex];
+			snapshot.m_tangentImpulses[pointIndex] = contact.m_tangentImpulses[pointIndex];
+		}
+		writer.Write(snapshot);
+	}
+}
+
+bool Physics2D::LoadState(std::vector<unsigned char> const& buffer)
+{
+	//the whole buffer is checked before anything is written, so the second pass can not fail halfway
+	PhysicsSnapshotReader2D reader(buffer.data(), buffer.size());
+	int version = 0;
+	int frameId = 0;
+	int colliderCount = 0;
+	if (!reader.Read(version) || version != SNAPSHOT_VERSION || !reader.Read(frameId) ||
+		!reader.Read(colliderCount) || colliderCount != (int)m_colliders.size())
+	{
+		return false;
+	}
+	size_t collidersOffset = reader.GetOffset();
+	for (int colliderIndex = 0; colliderIndex < colliderCount; ++colliderIndex)
+	{
+		ColliderSnapshot2D snapshot;
+		if (!reader.Read(snapshot) || snapshot.m_collider != m_colliders[colliderIndex] ||
+			snapshot.m_generation != m_colliders[colliderIndex]->m_poolHandle.m_generation)
+		{
+			return false;
+		}
+	}
+	size_t storageOffset = reader.GetOffset();
+	if (!m_bodyStorage.ValidateState(reader))
+	{
+		return false;
+	}
+	int contactCount = 0;
+	if (!reader.Read(contactCount) || contactCount < 0)
+	{
+		return false;
+	}
+	//the contacts are the rest of the buffer
+	size_t contactsOffset = reader.GetOffset();
+	if ((buffer.size() - contactsOffset) != (size_t)contactCount * sizeof(ContactSnapshot2D))
+	{
+		return false;
+	}
+	for (int contactIndex = 0; contactIndex < contactCount; ++contactIndex)
+	{
+		ContactSnapshot2D snapshot;
+		reader.Read(snapshot);
+		if (snapshot.m_meIndex < 0 || snapshot.m_meIndex >= colliderCount || snapshot.m_themIndex < 0 ||
+			snapshot.m_themIndex >= colliderCount || snapshot.m_meIndex == snapshot.m_themIndex)
+		{
+			return false;
+		}
+	}
+
+	m_frameId = frameId;
+	reader.SetOffset(collidersOffset);
+	for (int colliderIndex = 0; colliderIndex < colliderCount; ++colliderIndex)
+	{
+		ColliderSnapshot2D snapshot;
+		reader.Read(snapshot);
+		Collider2D* collider = snapshot.m_collider;
+		ColliderSnapshot2D current = GetColliderSnapshot(collider);
+		if (current.m_worldPositionX == snapshot.m_worldPositionX && current.m_worldPositionY == snapshot.m_worldPositionY &&
+			current.m_worldRotation == snapshot.m_worldRotation && current.m_boundCenterX == snapshot.m_boundCenterX &&
+			current.m_boundCenterY == snapshot.m_boundCenterY && current.m_boundRadius == snapshot.m_boundRadius)
+		{
+			//static and sleeping colliders mostly, their proxies and cached shapes still fit
+			continue;
+		}
+		Vec2 worldPosition(snapshot.m_worldPositionX, snapshot.m_worldPositionY);
+		if (collider->m_type == COLLIDER2D_DISC)
+		{
+			((DiscCollider2D*)collider)->m_worldPosition = worldPosition;
+			((DiscCollider2D*)collider)->m_worldRotation = snapshot.m_worldRotation;
+		}
+		else
+		{
+			//transform versions went back in time too, a cached shape with a matching version may be from another pose
+			PolygonCollider2D* polygon = (PolygonCollider2D*)collider;
+			polygon->m_worldPosition = worldPosition;
+			polygon->m_worldRotation = snapshot.m_worldRotation;
+			polygon->m_shapeVersion = 0;
+		}
+		collider->m_bound.m_center = Vec2(snapshot.m_boundCenterX, snapshot.m_boundCenterY);
+		collider->m_bound.m_radius = snapshot.m_boundRadius;
+		RefitCollider(collider);
+	}
+
+	reader.SetOffset(storageOffset);
+	m_bodyStorage.LoadState(reader);
+
+	reader.SetOffset(contactsOffset);
+	m_contactCache.Clear();
+	for (Collider2D* collider : m_colliders)
+	{
+		collider->m_contactKeys.clear();
+	}
+	for (int contactIndex = 0; contactIndex < contactCount; ++contactIndex)
+	{
+		ContactSnapshot2D snapshot;
+		reader.Read(snapshot);
+		Collision2D contact;
+		contact.me = m_colliders[snapshot.m_meIndex];
+		contact.them = m_colliders[snapshot.m_themIndex];
+		contact.manifold.contactEdge = Segment2D(Vec2(snapshot.m_edge[0], snapshot.m_edge[1]), Vec2(snapshot.m_edge[2], snapshot.m_edge[3]));
+		contact.manifold.contactNormal = Vec2(snapshot.m_normal[0], snapshot.m_normal[1]);
+		contact.manifold.penetration = snapshot.m_penetration;
+		contact.m_colliderID = IntVec2(std::min(contact.me->m_id, contact.them->m_id), std::max(contact.me->m_id, contact.them->m_id));
+		contact.m_frameId = snapshot.m_frameId;
+		for (int pointIndex = 0; pointIndex < Collision2D::MAX_CONTACT_POINTS; ++pointIndex)
+		{
+			contact.m_normalImpulses[pointIndex] = snapshot.m_normalImpulses[pointIndex];
+			contact.m_tangentImpulses[pointIndex] = snapshot.m_tangentImpulses[pointIndex];
+		}
+		CacheContact(ContactCache2D::GetContactKey(contact.me->m_id, contact.them->m_id), contact);
+	}
+	return true;
+}
+
 void Physics2D::SetFixedDeltaTime(double frameTimeSeconds)
 {
 	m_fixedDeltaTime = frameTimeSeconds;
@@ -204,6 +863,25 @@ void Physics2D::SetClock(Clock* clock)
 	m_stepTimer.SetSeconds(m_clock, m_fixedDeltaTime);
 }
 
+void Physics2D::SetSolverIterations(int velocityIterations, int positionIterations)
+{
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+}
+
+void Physics2D::SetSleepEnabled(bool isEnabled)
+{
+	m_isSleepEnabled = isEnabled;
+	if (!isEnabled)
+	{
+		//Wake leaves static bodies where they are and only ever swaps with an index already passed
+		for (int bodyIndex = m_bodyStorage.GetAwakeCount(); bodyIndex < m_bodyStorage.GetCount(); ++bodyIndex)
+		{
+			m_bodyStorage.Wake(bodyIndex);
+		}
+	}
+}
+
 void Physics2D::EnableLayerInteraction(unsigned int layerIdx0, unsigned int layerIdx1)
 {
 	m_layerInteractions[layerIdx0] |= 1 << layerIdx1;
@@ -226,263 +904,306 @@ bool Physics2D::DoLayersInteract(unsigned int layerIdx0, unsigned int layerIdx1)
 
 void Physics2D::DetectCollisions()
 {
-	if (m_colliders.size() < 2)
+	for (int colliderIndex = 0; colliderIndex < m_colliders.size(); ++colliderIndex)
 	{
-		return;
+		m_colliders[colliderIndex]->m_isIntersecting = false;
 	}
-	for (int colliderIndex = 0; colliderIndex < m_colliders.size(); ++colliderIndex)
+	m_beginContacts.clear();
+	m_stayContacts.clear();
+	m_endContacts.clear();
+	m_sleepingPairs.clear();
+	m_activePairs.clear();
+	m_broadphase->UpdatePairs();
+	std::vector<ColliderPair2D> const& pairs = m_broadphase->GetPairs();
+	for (int pairIndex = 0; pairIndex < pairs.size(); ++pairIndex)
 	{
-		for (int colliderIndexJ = colliderIndex + 1; colliderIndexJ < m_colliders.size(); ++colliderIndexJ)
+		Collider2D* me = pairs[pairIndex].m_colliderA;
+		Collider2D* them = pairs[pairIndex].m_colliderB;
+		if (me->m_rigidbody == nullptr || them->m_rigidbody == nullptr ||
+			(me->m_rigidbody->GetSimulationMode() == STATIC && them->m_rigidbody->GetSimulationMode() == STATIC))
 		{
-			Collider2D* me = m_colliders[colliderIndex];
-			Collider2D* them = m_colliders[colliderIndexJ];
-			if ((me->m_rigidbody->m_mode != STATIC || them->m_rigidbody->m_mode != STATIC) &&
-				me->Intersects(them))
-			{
-				me->m_isIntersecting = true;
-				them->m_isIntersecting = true;
-// 				if (me->m_rigidbody->m_collider->m_type == COLLIDER2D_POLYGON &&
-// 					them->m_rigidbody->m_collider->m_type == COLLIDER2D_POLYGON)
-// 				{
-// 					manifold2 manifold = me->GetManifold(them);
-// 					return;
-// 				}
-				Collision2D collision;
-				collision.m_colliderID = IntVec2(std::min(me->m_id, them->m_id), std::max(me->m_id, them->m_id));
-				collision.m_frameId = m_frameId;
-				manifold2 manifold = me->GetManifold(them);
-// 				DebugAddWorldPoint(Vec3(manifold.contactEdge.pointA, 0.f) + Vec3(20.f, 10.f, 0.f), 1.f, Rgba8(255, 0, 0, 255), 2.f);
-// 				DebugAddWorldPoint(Vec3(manifold.contactEdge.pointB, 0.f) + Vec3(20.f, 10.f, 0.f), 1.f, Rgba8(255, 0, 0, 255), 2.f);
-				collision.me = me;
-				collision.them = them;
-				collision.manifold = manifold;
-				m_unresolvedCollisions.push(collision);
-
-				bool wasInLastFrame = false;
-				for (int i = 0; i < m_collisionsForEvents.size(); ++i)
-				{
-					if (m_collisionsForEvents[i].m_colliderID == collision.m_colliderID)
-					{
-						m_collisionsForEvents[i].m_frameId = m_frameId;
-						if ((me->m_isTrigger || them->m_isTrigger))
-						{
-							if (me->m_rigidbody->m_layer == them->m_rigidbody->m_layer)
-							{
-								me->m_rigidbody->OnTriggerStay(collision);
-								them->m_rigidbody->OnTriggerStay(collision.GetInversed());
-							}
-						}
-						else if(DoLayersInteract(me->m_rigidbody->m_layer, them->m_rigidbody->m_layer))
-						{
-							me->m_rigidbody->OnOverlapStay(collision);
-							them->m_rigidbody->OnOverlapStay(collision.GetInversed());
-						}
-						wasInLastFrame = true;
-						break;
-					}
-				}
-				if (!wasInLastFrame)
-				{
-					m_collisionsForEvents.push_back(collision);
-					if ((me->m_isTrigger || them->m_isTrigger))
-					{
-						if (me->m_rigidbody->m_layer == them->m_rigidbody->m_layer)
-						{
-							me->m_rigidbody->OnTriggerBegin(collision);
-							them->m_rigidbody->OnTriggerBegin(collision.GetInversed());
-						}
-						
-					}
-					else if(DoLayersInteract(me->m_rigidbody->m_layer, them->m_rigidbody->m_layer))
-					{
-						me->m_rigidbody->OnOverlapBegin(collision);
-						them->m_rigidbody->OnOverlapBegin(collision.GetInversed());
-					}
-				}
+			continue;
+		}
+		//neither body moved since the last step, decided after the islands touched by awake bodies woke up
+		if (!me->m_rigidbody->IsAwake() && !them->m_rigidbody->IsAwake())
+		{
+			m_sleepingPairs.push_back(pairs[pairIndex]);
+		}
+		else
+		{
+			m_activePairs.push_back(pairs[pairIndex]);
+		}
+	}
 
-			}
-			else
-			{
-				me->m_isIntersecting = false;
-				them->m_isIntersecting = false;
-			}
+	RunNarrowPhase();
+	//cache, events and waking stay on this thread in pair order so they do not depend on scheduling
+	for (int pairIndex = 0; pairIndex < m_activePairs.size(); ++pairIndex)
+	{
+		if (m_activeTouching[pairIndex] != 0)
+		{
+			Collider2D* me = m_activePairs[pairIndex].m_colliderA;
+			Collider2D* them = m_activePairs[pairIndex].m_colliderB;
+			RecordContact(me, them, m_activeManifolds[pairIndex]);
+			WakeOnContact(me, them);
 		}
 	}
-	for (int i = 0; i < m_collisionsForEvents.size(); ++i)
+	WakeQueuedIslands();
+
+	for (ColliderPair2D const& pair : m_sleepingPairs)
 	{
-		if (m_collisionsForEvents[i].m_frameId < m_frameId)
+		Collider2D* me = pair.m_colliderA;
+		Collider2D* them = pair.m_colliderB;
+		if (me->m_rigidbody->IsAwake() || them->m_rigidbody->IsAwake())
 		{
-			if ((m_collisionsForEvents[i].me->m_isTrigger || m_collisionsForEvents[i].them->m_isTrigger))
-			{
-				if (m_collisionsForEvents[i].me->m_rigidbody->m_layer == m_collisionsForEvents[i].them->m_rigidbody->m_layer)
-				{
-					m_collisionsForEvents[i].me->m_rigidbody->OnTriggerEnd(m_collisionsForEvents[i]);
-					m_collisionsForEvents[i].them->m_rigidbody->OnTriggerEnd(m_collisionsForEvents[i].GetInversed());
-				}
-			}
-			else if(DoLayersInteract(m_collisionsForEvents[i].me->m_rigidbody->m_layer, m_collisionsForEvents[i].them->m_rigidbody->m_layer))
+			//a sleeper touching a freshly woken body from another island wakes too, its own pairs
+			//that were already kept from the cache get the narrow phase again next step
+			if (UpdateContact(me, them))
 			{
-				m_collisionsForEvents[i].me->m_rigidbody->OnOverlapEnd(m_collisionsForEvents[i]);
-				m_collisionsForEvents[i].them->m_rigidbody->OnOverlapEnd(m_collisionsForEvents[i].GetInversed());
+				WakeOnContact(me, them);
 			}
+			continue;
+		}
 
-			m_collisionsForEvents.erase(m_collisionsForEvents.begin() + i);
+		//still asleep: nothing moved, so a touching pair keeps touching with the contact it slept with
+		Collision2D* cachedContact = m_contactCache.Find(ContactCache2D::GetContactKey(me->m_id, them->m_id));
+		if (cachedContact != nullptr)
+		{
+			me->m_isIntersecting = true;
+			them->m_isIntersecting = true;
+			cachedContact->m_frameId = m_frameId;
+			m_stayContacts.push_back(*cachedContact);
 		}
 	}
-}
+	WakeQueuedIslands();
 
-void Physics2D::ResolveCollisions()
-{
-	while (!m_unresolvedCollisions.empty())
+	//anything not refreshed this step stopped touching, walk backwards so swap-remove never skips a contact
+	for (int contactIndex = m_contactCache.GetCount() - 1; contactIndex >= 0; --contactIndex)
 	{
-		ResolveCollision(m_unresolvedCollisions.front());
-		m_unresolvedCollisions.pop();
+		if (m_contactCache.GetContact(contactIndex).m_frameId < m_frameId)
+		{
+			m_endContacts.push_back(m_contactCache.GetContact(contactIndex));
+			UncacheContact(m_contactCache.GetKey(contactIndex));
+		}
 	}
+	DispatchContactEvents();
 }
 
-void Physics2D::ResolveCollision(Collision2D const& collision)
+void Physics2D::RunNarrowPhase()
 {
-	if (collision.me->m_isTrigger || collision.them->m_isTrigger || 
-		!DoLayersInteract(collision.me->m_rigidbody->m_layer, collision.them->m_rigidbody->m_layer))
+	int pairCount = (int)m_activePairs.size();
+	m_activeManifolds.resize(pairCount);
+	m_activeTouching.resize(pairCount);
+	//stale polygon shapes are rebuilt here on the calling thread, the tests below only read them
+	for (int pairIndex = 0; pairIndex < pairCount; ++pairIndex)
 	{
-		return;
+		RefreshCachedShape(m_activePairs[pairIndex].m_colliderA);
+		RefreshCachedShape(m_activePairs[pairIndex].m_colliderB);
+	}
+	auto testPair = [this](int pairIndex)
+	{
+		Collider2D const* me = m_activePairs[pairIndex].m_colliderA;
+		Collider2D const* them = m_activePairs[pairIndex].m_colliderB;
+		m_activeTouching[pairIndex] = me->GetContact(them, m_activeManifolds[pairIndex]) ? 1 : 0;
+	};
+	if (m_jobSystem != nullptr)
+	{
+		m_jobSystem->ParallelFor(0, pairCount, NARROW_PHASE_PAIRS_PER_JOB, testPair);
+	}
+	else
+	{
+		for (int pairIndex = 0; pairIndex < pairCount; ++pairIndex)
+		{
+			testPair(pairIndex);
+		}
 	}
-	CorrectObjectsInCollision(collision);
-	ApplyImpulses(collision);
 }
 
-void Physics2D::CorrectObjectsInCollision(Collision2D const& collision)
+bool Physics2D::UpdateContact(Collider2D* me, Collider2D* them)
 {
-	// Correcting - stop overlapping
-	eSimulationMode meMode = collision.me->m_rigidbody->m_mode;
-	eSimulationMode theirMode = collision.them->m_rigidbody->m_mode;
-	float myMass = collision.me->m_rigidbody->GetMass();
-	float theirMass = collision.them->m_rigidbody->GetMass();
-	if (meMode > theirMode)
+	manifold2 manifold;
+	if (!me->GetContact(them, manifold))
 	{
-		collision.them->m_rigidbody->Translate(-collision.GetNormal() * collision.GetPenetration());
+		return false;
 	}
-	else if (meMode < theirMode)
+	RecordContact(me, them, manifold);
+	return true;
+}
+
+void Physics2D::RecordContact(Collider2D* me, Collider2D* them, manifold2 const& manifold)
+{
+	me->m_isIntersecting = true;
+	them->m_isIntersecting = true;
+	Collision2D collision;
+	collision.m_colliderID = IntVec2(std::min(me->m_id, them->m_id), std::max(me->m_id, them->m_id));
+	collision.m_frameId = m_frameId;
+	collision.me = me;
+	collision.them = them;
+	collision.manifold = manifold;
+
+	uint64_t contactKey = ContactCache2D::GetContactKey(me->m_id, them->m_id);
+	Collision2D* cachedContact = m_contactCache.Find(contactKey);
+	if (cachedContact != nullptr)
 	{
-		collision.me->m_rigidbody->Translate(collision.GetNormal() * collision.GetPenetration());
+		collision.InheritImpulses(*cachedContact);
+		*cachedContact = collision;
+		m_stayContacts.push_back(collision);
 	}
 	else
 	{
-		float pushMe = theirMass / (myMass + theirMass);
-		float pushThem = 1.0f - pushMe;
-		collision.me->m_rigidbody->Translate(pushMe * collision.GetNormal() * collision.GetPenetration());
-		collision.them->m_rigidbody->Translate(-pushThem * collision.GetNormal() * collision.GetPenetration());
+		CacheContact(contactKey, collision);
+		m_beginContacts.push_back(collision);
 	}
-	
-	//Apply Impulse
+	m_unresolvedCollisions.push_back(collision);
+}
 
-	
+void Physics2D::CacheContact(uint64_t key, Collision2D const& contact)
+{
+	m_contactCache.Add(key, contact);
+	contact.me->m_contactKeys.push_back(key);
+	contact.them->m_contactKeys.push_back(key);
 }
 
-float Physics2D::CalculateNormalImpulses(Collision2D const& collision)
+void Physics2D::UncacheContact(uint64_t key)
 {
-	float myMass = collision.me->m_rigidbody->GetMass();
-	float theirMass = collision.them->m_rigidbody->GetMass();
-	if (collision.me->m_rigidbody->m_mode != DYNAMIC)
+	Collision2D const* contact = m_contactCache.Find(key);
+	Collider2D* colliders[2] = { contact->me, contact->them };
+	for (Collider2D* collider : colliders)
 	{
-		myMass = INFINITY;
+		//a collider touches a handful of others, so the list stays short
+		std::vector<uint64_t>& contactKeys = collider->m_contactKeys;
+		auto keyIter = std::find(contactKeys.begin(), contactKeys.end(), key);
+		*keyIter = contactKeys.back();
+		contactKeys.pop_back();
 	}
-	else if (collision.them->m_rigidbody->m_mode != DYNAMIC)
-	{
-		theirMass = INFINITY;
-	}
-	Vec2 contactPoint = (collision.manifold.contactEdge.pointA + collision.manifold.contactEdge.pointB) * 0.5f;
-	Vec2 myVelocity = collision.me->m_rigidbody->GetImpactVelocityAtPoint(contactPoint);
-	Vec2 theirVelocity = collision.them->m_rigidbody->GetImpactVelocityAtPoint(contactPoint);
-
-	Vec2 diffVelocity = myVelocity - theirVelocity;
-	Vec2 normal = collision.GetNormal();
-	Vec2 rAPT = (contactPoint - collision.me->m_rigidbody->m_worldPosition).GetRotated90Degrees();
-	float rAPTDotNormal = DotProduct2D(rAPT, normal);
-	Vec2 rBPT = (contactPoint - collision.them->m_rigidbody->m_worldPosition).GetRotated90Degrees();
-	float rBPTDotNormal = DotProduct2D(rBPT, normal);
-	float bounciness = collision.me->GetBounceWith(collision.them);
-	float impulse = -DotProduct2D((1 + bounciness) * diffVelocity, normal) /
-		(DotProduct2D(normal, normal) * (1.f / myMass + 1.f / theirMass) +
-			rAPTDotNormal * rAPTDotNormal / collision.me->m_rigidbody->m_moment +
-			rBPTDotNormal * rBPTDotNormal / collision.them->m_rigidbody->m_moment);
-	return impulse;
+	m_contactCache.Remove(key);
 }
 
-float Physics2D::CalculateTangentImpulses(Collision2D const& collision)
+void Physics2D::WakeOnContact(Collider2D* me, Collider2D* them)
 {
-	float myMass = collision.me->m_rigidbody->GetMass();
-	float theirMass = collision.them->m_rigidbody->GetMass();
-	if (collision.me->m_rigidbody->m_mode != DYNAMIC)
+	//triggers report overlaps but never push anything, so they leave sleepers alone
+	if (me->m_isTrigger || them->m_isTrigger ||
+		!DoLayersInteract(me->m_rigidbody->m_layer, them->m_rigidbody->m_layer))
+	{
+		return;
+	}
+	Rigidbody2D* sleeper = me->m_rigidbody->IsAwake() ? them->m_rigidbody : me->m_rigidbody;
+	if (sleeper->IsAwake())
 	{
-		myMass = INFINITY;
+		return;
 	}
-	else if (collision.them->m_rigidbody->m_mode != DYNAMIC)
+	int islandID = m_bodyStorage.m_islandIDs[sleeper->GetIndex()];
+	if (islandID != -1)
 	{
-		theirMass = INFINITY;
+		m_islandsToWake.push_back(islandID);
 	}
-	Vec2 contactPoint = (collision.manifold.contactEdge.pointA + collision.manifold.contactEdge.pointB) * 0.5f;
-	Vec2 myVelocity = collision.me->m_rigidbody->GetImpactVelocityAtPoint(contactPoint);
-	Vec2 theirVelocity = collision.them->m_rigidbody->GetImpactVelocityAtPoint(contactPoint);
-
-	Vec2 diffVelocity = myVelocity - theirVelocity;
-	Vec2 tangent = collision.GetNormal().GetRotated90Degrees();
-	Vec2 rAPT = (contactPoint - collision.me->m_rigidbody->m_worldPosition).GetRotated90Degrees();
-	float rAPTDotNormal = DotProduct2D(rAPT, tangent);
-	Vec2 rBPT = (contactPoint - collision.them->m_rigidbody->m_worldPosition).GetRotated90Degrees();
-	float rBPTDotNormal = DotProduct2D(rBPT, tangent);
-	float bounciness = collision.me->GetBounceWith(collision.them);
-	float impulse = -DotProduct2D((1 + bounciness) * diffVelocity, tangent) /
-		(DotProduct2D(tangent, tangent) * (1.f / myMass + 1.f / theirMass) +
-			rAPTDotNormal * rAPTDotNormal / collision.me->m_rigidbody->m_moment +
-			rBPTDotNormal * rBPTDotNormal / collision.them->m_rigidbody->m_moment);
-	return impulse;
 }
 
-void Physics2D::ApplyImpulses(Collision2D const& collision)
+void Physics2D::WakeQueuedIslands()
 {
-	eSimulationMode meMode = collision.me->m_rigidbody->m_mode;
-	eSimulationMode theirMode = collision.them->m_rigidbody->m_mode;
-	if (meMode != DYNAMIC && theirMode != DYNAMIC)
+	if (m_islandsToWake.empty())
 	{
 		return;
 	}
-	float normalImpulse = CalculateNormalImpulses(collision);
-	float friction = collision.me->GetFrictionWith(collision.them);
-	float tanImpulse = CalculateTangentImpulses(collision);
-	Vec2 contactPoint = (collision.manifold.contactEdge.pointA + collision.manifold.contactEdge.pointB) * 0.5f;
-	
-	Vec2 tangent = collision.GetNormal().GetRotated90Degrees();
-	if (abs(tanImpulse) > friction * normalImpulse) {
-		tanImpulse = SignFloat(tanImpulse) * normalImpulse * friction;
-	}
-	Vec2 jn = normalImpulse * collision.GetNormal() + tanImpulse * tangent;
-	Vec2 meApplyPoint = GetNearestPointOnLineSegment2D(collision.me->m_rigidbody->m_worldPosition,
-		collision.manifold.contactEdge.pointA, collision.manifold.contactEdge.pointB);
-	Vec2 themApplyPoint = GetNearestPointOnLineSegment2D(collision.them->m_rigidbody->m_worldPosition,
-		collision.manifold.contactEdge.pointA, collision.manifold.contactEdge.pointB);
-	if (meMode == DYNAMIC && theirMode == DYNAMIC)
+	std::sort(m_islandsToWake.begin(), m_islandsToWake.end());
+	m_islandsToWake.erase(std::unique(m_islandsToWake.begin(), m_islandsToWake.end()), m_islandsToWake.end());
+	//Wake only ever swaps with an index already passed, so one forward walk over the sleeping range is enough
+	for (int bodyIndex = m_bodyStorage.GetAwakeCount(); bodyIndex < m_bodyStorage.GetCount(); ++bodyIndex)
 	{
-		collision.me->m_rigidbody->ApplyImpulse(jn, meApplyPoint);
-		collision.them->m_rigidbody->ApplyImpulse(-jn, themApplyPoint);
+		if (std::binary_search(m_islandsToWake.begin(), m_islandsToWake.end(), m_bodyStorage.m_islandIDs[bodyIndex]))
+		{
+			m_bodyStorage.Wake(bodyIndex);
+		}
+	}
+	m_islandsToWake.clear();
+}
 
+void Physics2D::DispatchContactEvents()
+{
+	for (Collision2D& collision : m_beginContacts)
+	{
+		Collider2D* me = collision.me;
+		Collider2D* them = collision.them;
+		if ((me->m_isTrigger || them->m_isTrigger))
+		{
+			if (me->m_rigidbody->m_layer == them->m_rigidbody->m_layer)
+			{
+				me->m_rigidbody->OnTriggerBegin(collision);
+				them->m_rigidbody->OnTriggerBegin(collision.GetInversed());
+			}
+		}
+		else if (DoLayersInteract(me->m_rigidbody->m_layer, them->m_rigidbody->m_layer))
+		{
+			me->m_rigidbody->OnOverlapBegin(collision);
+			them->m_rigidbody->OnOverlapBegin(collision.GetInversed());
+		}
 	}
-	else if (meMode == DYNAMIC)
+	for (Collision2D& collision : m_stayContacts)
 	{
-		collision.me->m_rigidbody->ApplyImpulse(jn, meApplyPoint);
+		Collider2D* me = collision.me;
+		Collider2D* them = collision.them;
+		if ((me->m_isTrigger || them->m_isTrigger))
+		{
+			if (me->m_rigidbody->m_layer == them->m_rigidbody->m_layer)
+			{
+				me->m_rigidbody->OnTriggerStay(collision);
+				them->m_rigidbody->OnTriggerStay(collision.GetInversed());
+			}
+		}
+		else if (DoLayersInteract(me->m_rigidbody->m_layer, them->m_rigidbody->m_layer))
+		{
+			me->m_rigidbody->OnOverlapStay(collision);
+			them->m_rigidbody->OnOverlapStay(collision.GetInversed());
+		}
 	}
-	else if (theirMode == DYNAMIC)
+	for (Collision2D& collision : m_endContacts)
 	{
-		collision.them->m_rigidbody->ApplyImpulse(-jn, themApplyPoint);
+		Collider2D* me = collision.me;
+		Collider2D* them = collision.them;
+		if ((me->m_isTrigger || them->m_isTrigger))
+		{
+			if (me->m_rigidbody->m_layer == them->m_rigidbody->m_layer)
+			{
+				me->m_rigidbody->OnTriggerEnd(collision);
+				them->m_rigidbody->OnTriggerEnd(collision.GetInversed());
+			}
+		}
+		else if (DoLayersInteract(me->m_rigidbody->m_layer, them->m_rigidbody->m_layer))
+		{
+			me->m_rigidbody->OnOverlapEnd(collision);
+			them->m_rigidbody->OnOverlapEnd(collision.GetInversed());
+		}
 	}
 }
 
-Vec2 Collision2D::GetNormal() const
+void Physics2D::ResolveCollisions()
 {
-	return manifold.contactNormal;
-}
+	m_contactSolver.Clear();
+	for (Collision2D const& collision : m_unresolvedCollisions)
+	{
+		if (collision.me->m_isTrigger || collision.them->m_isTrigger ||
+			!DoLayersInteract(collision.me->m_rigidbody->m_layer, collision.them->m_rigidbody->m_layer))
+		{
+			continue;
+		}
+		m_contactSolver.AddContact(collision, m_bodyStorage);
+	}
+	m_unresolvedCollisions.clear();
 
-float Collision2D::GetPenetration() const
-{
-	return manifold.penetration;
-}
\ No newline at end of file
+	m_contactSolver.BuildIslands(m_islandBuilder, m_bodyStorage.GetAwakeCount());
+	auto solveIslandVelocities = [this](int islandIndex)
+	{
+		m_contactSolver.SolveIslandVelocities(islandIndex, m_bodyStorage, m_velocityIterations);
+	};
+	if (m_jobSystem != nullptr)
+	{
+		m_jobSystem->ParallelFor(0, m_contactSolver.GetIslandCount(), ISLANDS_PER_JOB, solveIslandVelocities);
+	}
+	else
+	{
+		for (int islandIndex = 0; islandIndex < m_contactSolver.GetIslandCount(); ++islandIndex)
+		{
+			solveIslandVelocities(islandIndex);
+		}
+	}
+	m_contactSolver.StoreImpulses(m_contactCache);
+}
@@ -2,84 +2,174 @@
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Physics/Collider2D.hpp"
+#include "Engine/Physics/DiscCollider2D.hpp"
+#include "Engine/Physics/PolygonCollider2D.hpp"
+#include "Engine/Physics/Broadphase2D.hpp"
+#include "Engine/Physics/Collision2D.hpp"
+#include "Engine/Physics/ContactCache2D.hpp"
+#include "Engine/Physics/ContactSolver2D.hpp"
+#include "Engine/Physics/IslandBuilder2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+#include "Engine/Physics/Raycast2D.hpp"
+#include "Engine/Physics/RigidbodyStorage2D.hpp"
+#include "Engine/Physics/ShapeArena2D.hpp"
 #include "Engine/Core/Timer.hpp"
+#include "Engine/Core/ObjectPool.hpp"
 #include <vector>
-#include <queue>
 class Rigidbody2D;
 class Collider2D;
 class DiscCollider2D;
 class PolygonCollider2D;
 struct Plane2D;
 class Clock;
-struct Collision2D
-{
-	manifold2 manifold;
-	Collider2D* me = nullptr;
-	Collider2D* them = nullptr;
-	Vec2 GetNormal() const;
-	float GetPenetration() const;
-	IntVec2 m_colliderID;
-	int m_frameId = 0;
-public:
-	Collision2D GetInversed();
-};
-
+class JobSystem;
 class Physics2D
 {
 public:
-	Physics2D();
+	//With a job system the narrow phase and the contact islands are spread over its workers,
+	//contact events are still dispatched on the calling thread in the same order
+	explicit Physics2D(eBroadphaseType broadphaseType = BROADPHASE_AABB_TREE, JobSystem* jobSystem = nullptr);
 	~Physics2D();
 	void BeginFrame();
 
 	void Update();      // nothing in A01, but eventually it is the update, collision detection, and collision response part
+	//One fixed step outside of Update, for re-simulating the frames after a LoadState
+	void Step();
 	void ApplyEffectors(float deltaSeconds);
 	void MoveRigidbodies(float deltaSeconds);
+	//Islands that stayed below the sleep tolerances for long enough stop being integrated and tested
+	void UpdateSleep(float deltaSeconds);
 	void CleanupDestroyedObjects();
 	void EndFrame();    // cleanup destroyed objects
 	void SetGroundHeight(float height);
 	// factory style create/destroy
+	//Objects come from per-type pools and go back at the end of the step they were destroyed in,
+	//their pool handles go stale then, so a handle can be kept where a pointer could dangle
 	Rigidbody2D* CreateRigidbody();
 	void DestroyRigidbody(Rigidbody2D* rb);
+	//nullptr once the body was destroyed
+	Rigidbody2D* GetRigidbody(PoolHandle const& handle) const;
 
 	DiscCollider2D* CreateDiscCollider(Vec2 localPosition, float radius);
 	PolygonCollider2D* CreatePolygonCollider(Vec2 localPosition, std::vector<Vec2> const& points, bool isGiftWrapping = false);
 	void DestroyCollider(Collider2D* collider);
+	//nullptr once the collider was destroyed, type picks the pool the handle belongs to
+	Collider2D* GetCollider(eCollider2DType type, PoolHandle const& handle) const;
+	//Called whenever a collider's world shape changed
+	void RefitCollider(Collider2D* collider);
 
 	void DetectAllCollisionsFor(Collider2D* collider);
 	void SetSceneGravity(Vec2 gravity) { m_gravity = gravity; }
 	double GetFixedDeltaTime() const { return m_fixedDeltaTime; }
 	void SetFixedDeltaTime(double frameTimeSeconds);
 	void SetClock(Clock* clock);
+	void SetSolverIterations(int velocityIterations, int positionIterations);
+	void SetSleepEnabled(bool isEnabled);
+	void SetJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+	//Per phase timings of every step since the last reset
+	PhysicsStats2D const& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats.Reset(); }
+	//Bytes reserved by the pools, body arrays, shapes, contacts, solver and broadphase
+	size_t GetMemoryUsage() const;
+
+	//Rollback for networked play. A snapshot packs every body, collider pose, cached contact and m_frameId into one
+	//buffer, stepping on from a loaded snapshot with the same inputs gives the same results bit for bit.
+	//Loading checks the whole buffer first and fails without changing anything unless it is complete and the bodies
+	//and colliders are the ones that were saved.
+	void SaveState(std::vector<unsigned char>& outBuffer) const;
+	bool LoadState(std::vector<unsigned char> const& buffer);
 
 	void EnableLayerInteraction(unsigned int layerIdx0, unsigned int layerIdx1);
 	void DisableLayerInteraction(unsigned int layerIdx0, unsigned int layerIdx1);
 	bool DoLayersInteract(unsigned int layerIdx0, unsigned int layerIdx1) const;
+	//Bit per layer, the mask of the layers layerIdx interacts with
+	unsigned int GetLayerMask(unsigned int layerIdx) const { return m_layerInteractions[layerIdx]; }
+
+	//Spatial queries through the broadphase, results go to the caller's buffers. Only colliders on a layer in
+	//layerMask are reported, casts pass through triggers while overlaps report them.
+	bool Raycast(Vec2 const& start, Vec2 const& direction, float maxDistance, RaycastHit2D& outHit, unsigned int layerMask = ALL_LAYERS) const;
+	bool CastDisc(Vec2 const& start, float radius, Vec2 const& direction, float maxDistance, RaycastHit2D& outHit, unsigned int layerMask = ALL_LAYERS) const;
+	//Write at most maxColliders and return how many were written
+	int OverlapAABB(AABB2 const& bounds, Collider2D** outColliders, int maxColliders, unsigned int layerMask = ALL_LAYERS) const;
+	int OverlapPoint(Vec2 const& point, Collider2D** outColliders, int maxColliders, unsigned int layerMask = ALL_LAYERS) const;
+	//Closest hit of every ray into outHits, spread over the job system when there is one
+	void RaycastBatch(Raycast2D const* rays, int rayCount, RaycastHit2D* outHits, unsigned int layerMask = ALL_LAYERS) const;
 public:
 	int m_colliderId = 0;
 	int m_frameId = 0;
-	std::vector<Rigidbody2D*> m_rigidbodies;
-	std::vector<Collider2D*> m_colliders;
+	RigidbodyStorage2D m_bodyStorage;
+	ShapeArena2D m_shapeArena;		//world space polygon shapes, filled lazily by the colliders
+	std::vector<Collider2D*> m_colliders;		//unordered, removal swaps the last collider in
+	ObjectPool<Rigidbody2D> m_rigidbodyPool;
+	ObjectPool<DiscCollider2D> m_discColliderPool;
+	ObjectPool<PolygonCollider2D> m_polygonColliderPool;
+	std::vector<Rigidbody2D*> m_destroyedRigidbodies;	//waiting for CleanupDestroyedObjects
+	std::vector<Collider2D*> m_destroyedColliders;
 	Vec2 m_gravity = Vec2::ZERO;//in form of acceleration
 	Plane2D* m_ground = nullptr;
-	double m_fixedDeltaTime = 1.0 / 120.f;
+	double m_fixedDeltaTime = 1.0 / 60.f;
+	int m_velocityIterations = 8;
+	int m_positionIterations = 3;
+	bool m_isSleepEnabled = true;
+	JobSystem* m_jobSystem = nullptr;
+	static constexpr int NARROW_PHASE_PAIRS_PER_JOB = 64;
+	static constexpr int ISLANDS_PER_JOB = 4;
+	static constexpr int RAYS_PER_JOB = 64;
+	static constexpr unsigned int ALL_LAYERS = 0xffffffff;
+	static constexpr int SNAPSHOT_VERSION = 3;
+	static constexpr float CONTINUOUS_MOTION_FRACTION = 0.5f;	//flagged bodies moving less than this much of their radius per step are not swept
+	static constexpr int MAX_CONTINUOUS_SUBSTEPS = 4;			//impacts handled per flagged body per step, the time after the last one is dropped
 	// add members you may need to store these
 	// storage for all rigidbodies
 	// storage for all colliders
 	// ...
-	std::queue<Collision2D> m_unresolvedCollisions;
-	std::vector<Collision2D> m_collisionsForEvents;
+	std::vector<Collision2D> m_unresolvedCollisions;
+	ContactSolver2D m_contactSolver;
+	ContactCache2D m_contactCache;		//contacts touching as of the last step
+	IslandBuilder2D m_islandBuilder;
+	std::vector<float> m_islandSleepTimes;		//shortest sleep time per island root, scratch for UpdateSleep
+	std::vector<IntVec2> m_bodiesToSleep;		//x = handle, y = island id
+	std::vector<int> m_islandsToWake;
+	std::vector<ColliderPair2D> m_sleepingPairs;	//pairs without an awake body, only refreshed from the cache
+	std::vector<ColliderPair2D> m_activePairs;		//pairs with an awake body, narrow phase results below line up with them
+	std::vector<manifold2> m_activeManifolds;
+	std::vector<unsigned char> m_activeTouching;
+	std::vector<Collider2D*> m_sweepCandidates;		//scratch for the continuous sweeps
+	std::vector<Vec2> m_sweepPoints;
+	std::vector<Collision2D> m_beginContacts;
+	std::vector<Collision2D> m_stayContacts;
+	std::vector<Collision2D> m_endContacts;
 	Clock* m_clock = nullptr;
 	Timer m_stepTimer;
+	PhysicsStats2D m_stats;
 
 	unsigned int m_layerInteractions[32];
+
+	Broadphase2D* m_broadphase = nullptr;
 private:
 	void AdvanceSimulation(float deltaSeconds);
 	void DetectCollisions();
+	//Intersection test and manifold of every active pair, results only, safe to run on several threads
+	void RunNarrowPhase();
+	//Narrow phase for one broadphase pair, updates the contact cache and returns whether the pair touches
+	bool UpdateContact(Collider2D* me, Collider2D* them);
+	void RecordContact(Collider2D* me, Collider2D* them, manifold2 const& manifold);
+	//Every cache add and remove goes through these so each collider knows its own contacts
+	void CacheContact(uint64_t key, Collision2D const& contact);
+	void UncacheContact(uint64_t key);
+	//Queues the island of whichever body is asleep when a solid contact reaches it
+	void WakeOnContact(Collider2D* me, Collider2D* them);
+	void WakeQueuedIslands();
+	void DispatchContactEvents();
+	//Squeezes out the ranges of destroyed polygon colliders
+	void CompactShapeArena();
+	void AddCollider(Collider2D* collider);
+	//Destroys the object in place and gives its slot back to the pool
+	void FreeCollider(Collider2D* collider);
+	void FreeRigidbody(Rigidbody2D* rigidbody);
 	void ResolveCollisions();
-	void ResolveCollision(Collision2D const& collision);
-	void CorrectObjectsInCollision(Collision2D const& collision);
-	void ApplyImpulses(Collision2D const& collision);
-	//helper
-	float CalculateNormalImpulses(Collision2D const& collision);
-	float CalculateTangentImpulses(Collision2D const& collision);
+	//Flagged bodies are moved again from their start of step pose, sub-stepping from impact to impact
+	void SweepContinuousBodies(float deltaSeconds);
+	void SweepContinuousBody(int bodyIndex, float deltaSeconds);
 };
\ No newline at end of file
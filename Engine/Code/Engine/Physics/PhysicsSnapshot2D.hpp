@@ -0,0 +1,118 @@
+#pragma once
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+//Writes plain values and arrays over the byte buffer of a Physics2D snapshot, which is cut to what was written
+//when the writer goes away. Saving into the same buffer every step stops resizing it once it fits the scene.
+class PhysicsSnapshotWriter2D
+{
+public:
+	explicit PhysicsSnapshotWriter2D(std::vector<unsigned char>& buffer)
+		: m_buffer(buffer)
+	{}
+	~PhysicsSnapshotWriter2D() { m_buffer.resize(m_offset); }
+
+	template<typename T>
+	void Write(T const& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain copies only");
+		WriteBytes(&value, sizeof(T));
+	}
+
+	//Element count, then the elements in one copy
+	template<typename T>
+	void WriteArray(std::vector<T> const& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain copies only");
+		Write((int)values.size());
+		WriteBytes(values.data(), values.size() * sizeof(T));
+	}
+
+private:
+	void WriteBytes(void const* data, size_t size)
+	{
+		if (m_offset + size > m_buffer.size())
+		{
+			m_buffer.resize((m_offset + size) * 2);
+		}
+		if (size > 0)
+		{
+			memcpy(m_buffer.data() + m_offset, data, size);
+		}
+		m_offset += size;
+	}
+
+private:
+	std::vector<unsigned char>& m_buffer;
+	size_t m_offset = 0;
+};
+
+//Reads back what PhysicsSnapshotWriter2D wrote. Reads past the end fail and leave the value untouched.
+class PhysicsSnapshotReader2D
+{
+public:
+	PhysicsSnapshotReader2D(unsigned char const* data, size_t size)
+		: m_data(data)
+		, m_size(size)
+	{}
+
+	template<typename T>
+	bool Read(T& outValue)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain copies only");
+		return ReadBytes(&outValue, sizeof(T));
+	}
+
+	//Resizes values to the stored count, which only allocates when they have to grow
+	template<typename T>
+	bool ReadArray(std::vector<T>& outValues)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain copies only");
+		int count = 0;
+		if (!Read(count) || count < 0 || (size_t)count * sizeof(T) > m_size - m_offset)
+		{
+			return false;
+		}
+		outValues.resize(count);
+		return ReadBytes(outValues.data(), count * sizeof(T));
+	}
+
+	//Steps over an array, outCount is its element count
+	template<typename T>
+	bool SkipArray(int& outCount)
+	{
+		int count = 0;
+		if (!Read(count) || count < 0 || (size_t)count * sizeof(T) > m_size - m_offset)
+		{
+			return false;
+		}
+		outCount = count;
+		m_offset += count * sizeof(T);
+		return true;
+	}
+
+	size_t GetOffset() const { return m_offset; }
+	void SetOffset(size_t offset) { m_offset = offset; }
+	bool IsAtEnd() const { return m_offset == m_size; }
+
+private:
+	bool ReadBytes(void* outData, size_t size)
+	{
+		if (size > m_size - m_offset)
+		{
+			return false;
+		}
+		if (size > 0)
+		{
+			memcpy(outData, m_data + m_offset, size);
+		}
+		m_offset += size;
+		return true;
+	}
+
+private:
+	unsigned char const* m_data = nullptr;
+	size_t m_size = 0;
+	size_t m_offset = 0;
+};
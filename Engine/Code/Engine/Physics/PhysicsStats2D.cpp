@@ -0,0 +1,22 @@
+#include "Engine/Physics/PhysicsStats2D.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+double PhysicsStats2D::GetTotalSeconds() const
+{
+	return m_effectorSeconds + m_detectSeconds + m_resolveSeconds + m_moveSeconds + m_sleepSeconds + m_cleanupSeconds;
+}
+
+std::string PhysicsStats2D::GetCSVHeader()
+{
+	return "steps,steps_per_second,effectors_ms,detect_ms,resolve_ms,move_ms,sleep_ms,cleanup_ms,peak_memory_bytes";
+}
+
+std::string PhysicsStats2D::GetCSVRow() const
+{
+	double totalSeconds = GetTotalSeconds();
+	double stepsPerSecond = totalSeconds > 0.0 ? (double)m_stepCount / totalSeconds : 0.0;
+	double msPerStep = m_stepCount > 0 ? 1000.0 / (double)m_stepCount : 0.0;
+	return Stringf("%d,%.1f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%zu", m_stepCount, stepsPerSecond,
+		m_effectorSeconds * msPerStep, m_detectSeconds * msPerStep, m_resolveSeconds * msPerStep,
+		m_moveSeconds * msPerStep, m_sleepSeconds * msPerStep, m_cleanupSeconds * msPerStep, m_peakMemoryBytes);
+}
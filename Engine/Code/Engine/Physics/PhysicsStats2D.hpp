@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+
+//Wall clock time spent in each phase of the fixed steps since the last reset, for comparing runs of the same scene
+struct PhysicsStats2D
+{
+	void Reset() { *this = PhysicsStats2D(); }
+	double GetTotalSeconds() const;
+	static std::string GetCSVHeader();
+	//Steps per second over the measured time, phase times as milliseconds per step
+	std::string GetCSVRow() const;
+
+	int m_stepCount = 0;
+	double m_effectorSeconds = 0.0;
+	double m_detectSeconds = 0.0;
+	double m_resolveSeconds = 0.0;
+	double m_moveSeconds = 0.0;
+	double m_sleepSeconds = 0.0;
+	double m_cleanupSeconds = 0.0;
+	size_t m_peakMemoryBytes = 0;		//largest Physics2D::GetMemoryUsage at the end of a step
+};
+
+//Reserved bytes, not just the used ones
+template<typename T>
+size_t GetCapacityBytes(std::vector<T> const& values)
+{
+	return values.capacity() * sizeof(T);
+}
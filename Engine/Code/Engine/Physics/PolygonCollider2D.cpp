@@ -3,6 +3,7 @@
 #include "Engine/Physics/Rigidbody2D.hpp"
 #include "Engine/Physics/Physics2D.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Plane2D.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Renderer/RenderContext.hpp"
 
@@ -27,10 +28,12 @@ PolygonCollider2D::PolygonCollider2D(Physics2D* system, Vec2 const& localPositio
 	GUARANTEE_OR_DIE(m_polygon->IsValid(), "Polygon is not valid");
 	m_type = COLLIDER2D_POLYGON;
 	m_radius = GetApproximateRadiusOfPolygon2D(*m_polygon);
+	m_shapeOffset = m_system->m_shapeArena.Allocate(m_polygon->GetVertexCount());
 }
 
 PolygonCollider2D::~PolygonCollider2D()
 {
+	m_system->m_shapeArena.Release(m_polygon->GetVertexCount());
 	delete m_polygon;
 	m_polygon = nullptr;
 }
@@ -46,8 +49,8 @@ void PolygonCollider2D::UpdateWorldShape()
 	}
 	else
 	{
-		m_worldPosition = m_localPosition + m_rigidbody->m_worldPosition;
-		m_worldRotation = m_localRotation + m_rigidbody->m_RotationInRadians;
+		m_worldPosition = m_localPosition + m_rigidbody->GetPosition();
+		m_worldRotation = m_localRotation + m_rigidbody->GetRotation();
 	}
 	m_bound.m_center += m_worldPosition - previousLocation;
 	m_bound.m_center = (m_bound.m_center - m_worldPosition).
@@ -57,27 +60,31 @@ void PolygonCollider2D::UpdateWorldShape()
 
 Vec2 PolygonCollider2D::GetClosestPoint(Vec2 pos) const
 {
-	Polygon2D polygon = *m_polygon;
-	polygon.Rotate(ConvertRadiansToDegrees(m_worldRotation));
-	polygon.TranslateTo(m_worldPosition);
-	return polygon.GetClosestPoint(pos);
+	if (Contains(pos))
+	{
+		return pos;
+	}
+	return GetClosestPointEdge(pos);
 }
 
 Vec2 PolygonCollider2D::GetClosestPointEdge(Vec2 pos) const
 {
-	Polygon2D polygon = *m_polygon;
-	polygon.Rotate(ConvertRadiansToDegrees(m_worldRotation));
-	polygon.TranslateTo(m_worldPosition);
-	return polygon.GetClosestPointOnEdge(pos);
+	return GetNearestPointOnPolygon2DEdge(pos, GetWorldPoints(), GetVertexCount());
 }
 
 
 bool PolygonCollider2D::Contains(Vec2 pos) const
 {
-	Polygon2D polygon = *m_polygon;
-	polygon.Rotate(ConvertRadiansToDegrees(m_worldRotation));
-	polygon.TranslateTo(m_worldPosition);
-	return polygon.Contains(pos);
+	Vec2 const* points = GetWorldPoints();
+	Vec2 const* normals = GetWorldNormals();
+	for (int vertexIndex = 0; vertexIndex < GetVertexCount(); ++vertexIndex)
+	{
+		if (DotProduct2D(normals[vertexIndex], pos - points[vertexIndex]) >= 0.f)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 // bool PolygonCollider2D::Intersects(Collider2D const* other) const
@@ -94,10 +101,40 @@ bool PolygonCollider2D::Contains(Vec2 pos) const
 
 bool PolygonCollider2D::IntersectsPlane(Plane2D const& plane) const
 {
-	Polygon2D polygon = *m_polygon;
-	polygon.Rotate(ConvertRadiansToDegrees(m_worldRotation));
-	polygon.TranslateTo(m_worldPosition);
-	return DoPolygonPlaneOverlap(polygon, plane);
+	Vec2 const* points = GetWorldPoints();
+	Vec2 planeCenter = plane.distanceFromOriginAlongNormal * plane.normal;
+	for (int vertexIndex = 0; vertexIndex < GetVertexCount(); ++vertexIndex)
+	{
+		if (DotProduct2D(points[vertexIndex] - planeCenter, plane.normal) <= 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool PolygonCollider2D::IntersectsAABB(AABB2 const& box) const
+{
+	if (!DoAABBsOverlap2D(GetWorldBox(), box))
+	{
+		return false;
+	}
+	Vec2 const boxPoints[4] = { box.mins, Vec2(box.maxs.x, box.mins.y), box.maxs, Vec2(box.mins.x, box.maxs.y) };
+	return IsPolygonIntersectWithOtherPolygon(GetWorldPoints(), GetVertexCount(), m_worldPosition, boxPoints, 4, box.GetCenter());
+}
+
+bool PolygonCollider2D::CastDisc(Vec2 const& start, float radius, Vec2 const& direction, float maxDistance, float& outDistance, Vec2& outNormal) const
+{
+	float entryDistance = 0.f;
+	if (!RaycastVsAABB2D(start, direction, maxDistance, AABB2(GetWorldBox().mins - Vec2(radius, radius), GetWorldBox().maxs + Vec2(radius, radius)), entryDistance))
+	{
+		return false;
+	}
+	if (radius == 0.f)
+	{
+		return RaycastVsPolygon2D(start, direction, maxDistance, GetWorldPoints(), GetWorldNormals(), GetVertexCount(), outDistance, outNormal);
+	}
+	return DiscCastVsPolygon2D(start, radius, direction, maxDistance, GetWorldPoints(), GetWorldNormals(), GetVertexCount(), outDistance, outNormal);
 }
 
 void PolygonCollider2D::AddVerticesToDebugRender(std::vector<Vertex_PCU>& vertices, Rgba8 const& borderColor, Rgba8 const& fillColor)
@@ -122,10 +159,54 @@ float PolygonCollider2D::CalculateMoment(float mass)
 	return m_polygon->GetMomentumWithoutMass() * mass;
 }
 
-Polygon2D PolygonCollider2D::GetUpdatedWorldShape() const
+Vec2 const* PolygonCollider2D::GetWorldPoints() const
+{
+	RefreshWorldShape();
+	return m_system->m_shapeArena.GetVertices(m_shapeOffset);
+}
+
+Vec2 const* PolygonCollider2D::GetWorldNormals() const
+{
+	RefreshWorldShape();
+	return m_system->m_shapeArena.GetNormals(m_shapeOffset);
+}
+
+AABB2 const& PolygonCollider2D::GetWorldBox() const
 {
-	Polygon2D polygon = *m_polygon;
-	polygon.Rotate(ConvertRadiansToDegrees(m_worldRotation));
-	polygon.TranslateTo(m_worldPosition);
-	return polygon;
-}
\ No newline at end of file
+	RefreshWorldShape();
+	return m_worldBox;
+}
+
+void PolygonCollider2D::RefreshWorldShape() const
+{
+	unsigned int transformVersion = GetTransformVersion();
+	if (m_shapeVersion == transformVersion)
+	{
+		return;
+	}
+	m_shapeVersion = transformVersion;
+
+	std::vector<Vec2> const& localPoints = m_polygon->GetPoints();
+	int numVertices = (int)localPoints.size();
+	Vec2* points = m_system->m_shapeArena.GetVertices(m_shapeOffset);
+	Vec2* normals = m_system->m_shapeArena.GetNormals(m_shapeOffset);
+	float worldDegrees = ConvertRadiansToDegrees(m_worldRotation);
+	for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+	{
+		points[vertexIndex] = localPoints[vertexIndex].GetRotatedDegrees(worldDegrees) + m_worldPosition;
+	}
+	m_worldBox = AABB2(points[0], points[0]);
+	for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+	{
+		//counter clockwise, so the right hand normal points out
+		Vec2 edge = points[(vertexIndex + 1) % numVertices] - points[vertexIndex];
+		normals[vertexIndex] = edge.GetRotatedMinus90Degrees().GetNormalized();
+		m_worldBox.StretchToIncludePoint(points[vertexIndex]);
+	}
+}
+
+unsigned int PolygonCollider2D::GetTransformVersion() const
+{
+	//without a rigidbody the world shape never moves
+	return m_rigidbody != nullptr ? m_rigidbody->GetTransformVersion() : 1;
+}
@@ -13,6 +13,8 @@ public:
 	virtual bool Contains(Vec2 pos) const override;
 	//virtual bool Intersects(Collider2D const* other) const override;
 	virtual bool IntersectsPlane(Plane2D const& plane) const override;
+	virtual bool IntersectsAABB(AABB2 const& box) const override;
+	virtual bool CastDisc(Vec2 const& start, float radius, Vec2 const& direction, float maxDistance, float& outDistance, Vec2& outNormal) const override;
 	// debug helpers
 	virtual void AddVerticesToDebugRender(std::vector<Vertex_PCU>& vertices, Rgba8 const& borderColor, Rgba8 const& fillColor) override;
 
@@ -20,7 +22,12 @@ public:
 
 	virtual float CalculateMoment(float mass) override;
 
-	Polygon2D GetUpdatedWorldShape() const;
+	//World space shape, rebuilt in the system's shape arena on first use after the rigidbody's transform version changed
+	Vec2 const* GetWorldPoints() const;
+	Vec2 const* GetWorldNormals() const;		//outward normal of the edge from point i to i + 1
+	AABB2 const& GetWorldBox() const;
+	int GetVertexCount() const { return m_polygon->GetVertexCount(); }
+	void RefreshWorldShape() const;
 public:
 	Vec2 m_localPosition; // my local offset from my parent
 	Vec2 m_worldPosition; // my local offset from my parent
@@ -28,6 +35,12 @@ public:
 	float m_worldRotation = 0.f;
 	Polygon2D* m_polygon;
 	float m_radius;//very approximate radius for out screen calculation
+private:
+	unsigned int GetTransformVersion() const;
+
+	int m_shapeOffset = 0;						// first vertex in m_system->m_shapeArena
+	mutable unsigned int m_shapeVersion = 0;	// transform version the cached shape was built for, 0 = never built
+	mutable AABB2 m_worldBox;
 protected:
 	PolygonCollider2D(Physics2D* system, Vec2 const& localPosition, std::vector<Vec2> const vertices, bool isGiftWrapping = false);
 	~PolygonCollider2D();
@@ -0,0 +1,20 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+
+class Collider2D;
+
+//One ray of Physics2D::RaycastBatch, direction does not have to be normalized
+struct Raycast2D
+{
+	Vec2 m_start = Vec2::ZERO;
+	Vec2 m_direction = Vec2(1.f, 0.f);
+	float m_maxDistance = 0.f;
+};
+
+struct RaycastHit2D
+{
+	Collider2D* m_collider = nullptr;	//nullptr when nothing was hit
+	Vec2 m_point = Vec2::ZERO;			//where the cast shape touches the collider
+	Vec2 m_normal = Vec2::ZERO;			//collider's surface normal at m_point
+	float m_distance = 0.f;				//along the normalized direction, 0 when the cast starts inside the collider
+};
@@ -11,6 +11,16 @@ Rigidbody2D::Rigidbody2D(Physics2D* system)
 Rigidbody2D::~Rigidbody2D()
 {}
 
+RigidbodyStorage2D& Rigidbody2D::GetStorage() const
+{
+	return m_system->m_bodyStorage;
+}
+
+int Rigidbody2D::GetIndex() const
+{
+	return m_system->m_bodyStorage.GetIndex(m_handle);
+}
+
 void Rigidbody2D::Destroy()
 {
 	DestroyCollider();
@@ -23,6 +33,7 @@ void Rigidbody2D::DestroyCollider()
 	{
 		m_system->DestroyCollider(m_collider);
 		m_collider = nullptr;
+		GetStorage().m_colliders[GetIndex()] = nullptr;
 	}
 }
 
@@ -35,63 +46,170 @@ void Rigidbody2D::TakeCollider(Collider2D* collider)
 {
 	DestroyCollider();
 	m_collider = collider;
+	GetStorage().m_colliders[GetIndex()] = collider;
 	collider->m_rigidbody = this;
+	++GetStorage().m_transformVersions[GetIndex()];
 	collider->UpdateWorldShape();
+	m_system->RefitCollider(collider);
 	CalculateMoment();
 }
 
 void Rigidbody2D::Translate(Vec2 offset)
 {
-	SetPosition(m_worldPosition + offset);
+	SetPosition(GetPosition() + offset);
 }
 
 void Rigidbody2D::SetPosition(Vec2 position)
 {
-	m_worldPosition = position;
+	SetAwake(true);
+	int index = GetIndex();
+	GetStorage().m_positionX[index] = position.x;
+	GetStorage().m_positionY[index] = position.y;
+	++GetStorage().m_transformVersions[index];
+	if (!GetStorage().IsAwake(index))
+	{
+		//static bodies are never integrated, their start position is only ever set here
+		GetStorage().m_startPositionX[index] = position.x;
+		GetStorage().m_startPositionY[index] = position.y;
+	}
 	if (m_collider != nullptr)
 	{
 		m_collider->UpdateWorldShape();
+		m_system->RefitCollider(m_collider);
 	}
 }
 
-void Rigidbody2D::ApplyImpulse(Vec2 impulse, Vec2 point)
+Vec2 Rigidbody2D::GetPosition() const
 {
-	m_velocity += impulse / m_mass;
-	Vec2 rT = (point - m_worldPosition).GetRotated90Degrees();
-	float Torque = DotProduct2D(rT, impulse);
-	m_angularVelocity += Torque / m_moment;
+	int index = GetIndex();
+	return Vec2(GetStorage().m_positionX[index], GetStorage().m_positionY[index]);
+}
+
+void Rigidbody2D::SetVelocity(Vec2 velocity)
+{
+	SetAwake(true);
+	int index = GetIndex();
+	GetStorage().m_velocityX[index] = velocity.x;
+	GetStorage().m_velocityY[index] = velocity.y;
+}
+
+Vec2 Rigidbody2D::GetVelocity() const
+{
+	int index = GetIndex();
+	return Vec2(GetStorage().m_velocityX[index], GetStorage().m_velocityY[index]);
+}
+
+void Rigidbody2D::SetPhysicsEnable(bool enable)
+{
+	SetAwake(true);
+	GetStorage().m_physicsEnabled[GetIndex()] = enable ? 1 : 0;
+}
+
+bool Rigidbody2D::IsPhysicsEnabled() const
+{
+	return GetStorage().m_physicsEnabled[GetIndex()] != 0;
+}
+
+void Rigidbody2D::SetSimulationMode(eSimulationMode mode)
+{
+	GetStorage().m_mode[GetIndex()] = (unsigned char)mode;
+	//static bodies live with the sleeping ones, Wake ignores them
+	if (mode == STATIC)
+	{
+		GetStorage().Sleep(GetIndex(), -1);
+	}
+	else
+	{
+		SetAwake(true);
+	}
+}
+
+void Rigidbody2D::SetContinuousCollision(bool isContinuous)
+{
+	GetStorage().m_continuousEnabled[GetIndex()] = isContinuous ? 1 : 0;
+}
+
+bool Rigidbody2D::IsContinuousCollision() const
+{
+	return GetStorage().m_continuousEnabled[GetIndex()] != 0;
+}
+
+void Rigidbody2D::SetAwake(bool isAwake)
+{
+	if (isAwake)
+	{
+		GetStorage().Wake(GetIndex());
+	}
+	else if (GetSimulationMode() != STATIC)
+	{
+		GetStorage().Sleep(GetIndex(), m_handle);
+	}
+}
+
+bool Rigidbody2D::IsAwake() const
+{
+	return GetStorage().IsAwake(GetIndex());
+}
+
+unsigned int Rigidbody2D::GetTransformVersion() const
+{
+	return GetStorage().m_transformVersions[GetIndex()];
+}
+
+eSimulationMode Rigidbody2D::GetSimulationMode() const
+{
+	return (eSimulationMode)GetStorage().m_mode[GetIndex()];
+}
+
+void Rigidbody2D::SetMass(float mass)
+{
+	GetStorage().m_mass[GetIndex()] = mass;
 }
 
-void Rigidbody2D::ApplyDragForce()
+float Rigidbody2D::GetMass() const
 {
-	m_nonGravityForces = Vec2::ZERO;//todo, move to somewhere else
-	Vec2 velocity = m_velocity;//TODO, change to verlet velocity //tried but didnt work
-	Vec2 dragForce = -velocity * m_drag;
-	m_nonGravityForces += dragForce;
+	return GetStorage().m_mass[GetIndex()];
+}
+
+float Rigidbody2D::GetDrag() const
+{
+	return GetStorage().m_drag[GetIndex()];
+}
+
+void Rigidbody2D::ApplyImpulse(Vec2 impulse, Vec2 point)
+{
+	SetVelocity(GetVelocity() + impulse / GetMass());
+	Vec2 rT = (point - GetPosition()).GetRotated90Degrees();
+	float Torque = DotProduct2D(rT, impulse);
+	UpdateAngularVelocity(Torque / GetMoment());
 }
 
 void Rigidbody2D::ChangeMass(float offset)
 {
-	m_mass += offset;
-	if (m_mass < 0.001f)
+	float& mass = GetStorage().m_mass[GetIndex()];
+	mass += offset;
+	if (mass < 0.001f)
 	{
-		m_mass = 0.001f;
+		mass = 0.001f;
 	}
 	CalculateMoment();
 }
 
 void Rigidbody2D::ChangeDrag(float offset)
 {
-	m_drag += offset;
-	if (m_drag < 0.f)
+	float& drag = GetStorage().m_drag[GetIndex()];
+	drag += offset;
+	if (drag < 0.f)
 	{
-		m_drag = 0.f;
+		drag = 0.f;
 	}
 }
 
 Vec2 Rigidbody2D::GetVerletVelocity()
 {
-	return (m_worldPosition - m_startPosition) / (float)(m_system->m_fixedDeltaTime);
+	int index = GetIndex();
+	Vec2 startPosition(GetStorage().m_startPositionX[index], GetStorage().m_startPositionY[index]);
+	return (GetPosition() - startPosition) / (float)(m_system->m_fixedDeltaTime);
 }
 
 float Rigidbody2D::GetBounciness() const
@@ -105,14 +223,19 @@ float Rigidbody2D::GetFriction() const
 
 void Rigidbody2D::CalculateMoment()
 {
-	m_moment = m_collider->CalculateMoment(m_mass);
+	GetStorage().m_moment[GetIndex()] = m_collider->CalculateMoment(GetMass());
+}
+
+float Rigidbody2D::GetMoment() const
+{
+	return GetStorage().m_moment[GetIndex()];
 }
 
 Vec2 Rigidbody2D::GetImpactVelocityAtPoint(Vec2 point)
 {
-	Vec2 Tan = (point - m_worldPosition).GetRotated90Degrees();
-	Vec2 pointLocalVelocity = Tan * m_angularVelocity;
-	return m_velocity + pointLocalVelocity;
+	Vec2 Tan = (point - GetPosition()).GetRotated90Degrees();
+	Vec2 pointLocalVelocity = Tan * GetAngularVelocity();
+	return GetVelocity() + pointLocalVelocity;
 }
 
 void Rigidbody2D::SetLayer(unsigned int layer)
@@ -138,24 +261,39 @@ void* Rigidbody2D::GetUserData(eUserType userType)
 
 void Rigidbody2D::SetRotation(float rotationRadians) 
 { 
-	m_RotationInRadians = rotationRadians; 
-	while (m_RotationInRadians < 0.f)
+	SetAwake(true);
+	++GetStorage().m_transformVersions[GetIndex()];
+	float& rotation = GetStorage().m_rotation[GetIndex()];
+	rotation = rotationRadians; 
+	while (rotation < 0.f)
 	{
-		m_RotationInRadians += 2 * 3.14159f;
+		rotation += 2 * 3.14159f;
 	}
 
-	while (m_RotationInRadians > 2 * 3.14159f)
+	while (rotation > 2 * 3.14159f)
 	{
-		m_RotationInRadians -= 2 * 3.14159f;
+		rotation -= 2 * 3.14159f;
 	}
 }
 
+float Rigidbody2D::GetRotation() const
+{
+	return GetStorage().m_rotation[GetIndex()];
+}
+
 void Rigidbody2D::UpdateAngularVelocity(float offset)
 {
-	m_angularVelocity += offset;
+	SetAwake(true);
+	GetStorage().m_angularVelocity[GetIndex()] += offset;
 }
 
 void Rigidbody2D::SetAngularVelocity(float angularVelocity)
 {
-	m_angularVelocity = angularVelocity;
-}
\ No newline at end of file
+	SetAwake(true);
+	GetStorage().m_angularVelocity[GetIndex()] = angularVelocity;
+}
+
+float Rigidbody2D::GetAngularVelocity() const
+{
+	return GetStorage().m_angularVelocity[GetIndex()];
+}
@@ -1,9 +1,11 @@
 #pragma once
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Core/Delegate.hpp"
+#include "Engine/Core/ObjectPool.hpp"
 class Collider2D;
 struct Collision2D;
 class Physics2D;
+class RigidbodyStorage2D;
 class RenderContext;
 enum eSimulationMode
 {
@@ -31,13 +33,22 @@ public:
 
 	void Translate(Vec2 offset);
 	void SetPosition(Vec2 position);          // update my position, and my colliders world position
-	void SetVelocity(Vec2 velocity) { m_velocity = velocity; }
-	void SetPhysicsEnable(bool enable) { m_physicsEnabled = enable; }
-	void SetSimulationMode(eSimulationMode mode) { m_mode = mode; }
-	void SetMass(float mass) { m_mass = mass; }
-	float GetMass() const { return m_mass; }
+	Vec2 GetPosition() const;
+	void SetVelocity(Vec2 velocity);
+	Vec2 GetVelocity() const;
+	void SetPhysicsEnable(bool enable);
+	bool IsPhysicsEnabled() const;
+	void SetSimulationMode(eSimulationMode mode);
+	void SetContinuousCollision(bool isContinuous); // fast dynamic bodies are swept so they can not pass through thin colliders
+	bool IsContinuousCollision() const;
+	eSimulationMode GetSimulationMode() const;
+	void SetAwake(bool isAwake);              // velocity, impulse and position changes wake the body on their own
+	bool IsAwake() const;
+	unsigned int GetTransformVersion() const; // changes whenever the position or rotation does, colliders cache against it
+	void SetMass(float mass);
+	float GetMass() const;
+	float GetDrag() const;
 	void ApplyImpulse(Vec2 impulse, Vec2 point);
-	void ApplyDragForce();
 	void ChangeMass(float offset);
 	void ChangeDrag(float offset);
 
@@ -46,10 +57,12 @@ public:
 	float GetFriction() const;
 
 	void SetRotation(float rotationRadians);
-	float GetRotation() { return m_RotationInRadians; }
+	float GetRotation() const;
 	void UpdateAngularVelocity(float offset);
 	void SetAngularVelocity(float angularVelocity);
+	float GetAngularVelocity() const;
 	void CalculateMoment();
+	float GetMoment() const;
 	Vec2 GetImpactVelocityAtPoint(Vec2 point);
 	
 	void SetLayer(unsigned int layer);
@@ -68,25 +81,15 @@ public:
 
 	Physics2D* m_system;     // which scene created/owns this object
 	Collider2D* m_collider = nullptr;
+	int m_handle = -1;		// position, velocity, mass etc. live in the system's RigidbodyStorage2D under this handle
+	PoolHandle m_poolHandle;	// slot in the system's rigidbody pool, Physics2D::GetRigidbody turns it back into this body while it lives
 
-	Vec2 m_worldPosition = Vec2::ZERO;     // where in the world is this rigidbody
 	bool m_isDestroyed = false;
-	bool m_physicsEnabled = true;
-	float m_mass = 1.0f;
-	float m_drag = 0.f;
-	Vec2 m_velocity;
-	Vec2 m_nonGravityForces;
-	Vec2 m_startPosition;
-	//angular
-	float m_RotationInRadians = 0.f;
-	float m_angularVelocity = 0.f;
-	float m_frameTorque = 0.f;
-	float m_moment = 0.f;
-
 	unsigned int m_layer = 0;
-
-	eSimulationMode m_mode = DYNAMIC;
 private:
+	RigidbodyStorage2D& GetStorage() const;
+	int GetIndex() const;
+
 	void* m_userData = nullptr;
 	eUserType m_userType = USERTYPE_GAMEOJECT;
 protected:
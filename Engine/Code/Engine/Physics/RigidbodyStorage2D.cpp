@@ -0,0 +1,336 @@
+#include "Engine/Physics/RigidbodyStorage2D.hpp"
+#include "Engine/Physics/PhysicsSnapshot2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+#include <algorithm>
+
+int RigidbodyStorage2D::Add(Rigidbody2D* owner)
+{
+	int handle = 0;
+	if (m_freeHandles.empty())
+	{
+		handle = (int)m_indexOfHandle.size();
+		m_indexOfHandle.push_back(-1);
+	}
+	else
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+	m_indexOfHandle[handle] = GetCount();
+	m_handleOfIndex.push_back(handle);
+	m_owners.push_back(owner);
+
+	m_positionX.push_back(0.f);
+	m_positionY.push_back(0.f);
+	m_startPositionX.push_back(0.f);
+	m_startPositionY.push_back(0.f);
+	m_velocityX.push_back(0.f);
+	m_velocityY.push_back(0.f);
+	m_rotation.push_back(0.f);
+	m_angularVelocity.push_back(0.f);
+	m_mass.push_back(1.f);
+	m_drag.push_back(0.f);
+	m_moment.push_back(0.f);
+	m_mode.push_back((unsigned char)DYNAMIC);
+	m_physicsEnabled.push_back(1);
+	m_continuousEnabled.push_back(0);
+	m_colliders.push_back(nullptr);
+	m_sleepTime.push_back(0.f);
+	m_islandIDs.push_back(-1);
+	m_transformVersions.push_back(1);
+	Wake(GetCount() - 1);
+	return handle;
+}
+
+void RigidbodyStorage2D::Remove(int handle)
+{
+	//move the body out of the awake range first so the ranges stay contiguous, then off the end
+	int index = m_indexOfHandle[handle];
+	if (index < m_awakeCount)
+	{
+		SwapBodies(index, m_awakeCount - 1);
+		index = m_awakeCount - 1;
+		--m_awakeCount;
+	}
+	SwapBodies(index, GetCount() - 1);
+
+	m_positionX.pop_back();
+	m_positionY.pop_back();
+	m_startPositionX.pop_back();
+	m_startPositionY.pop_back();
+	m_velocityX.pop_back();
+	m_velocityY.pop_back();
+	m_rotation.pop_back();
+	m_angularVelocity.pop_back();
+	m_mass.pop_back();
+	m_drag.pop_back();
+	m_moment.pop_back();
+	m_mode.pop_back();
+	m_physicsEnabled.pop_back();
+	m_continuousEnabled.pop_back();
+	m_colliders.pop_back();
+	m_sleepTime.pop_back();
+	m_islandIDs.pop_back();
+	m_transformVersions.pop_back();
+	m_owners.pop_back();
+	m_handleOfIndex.pop_back();
+	m_indexOfHandle[handle] = -1;
+	m_freeHandles.push_back(handle);
+}
+
+void RigidbodyStorage2D::SaveState(PhysicsSnapshotWriter2D& writer) const
+{
+	writer.Write(GetCount());
+	writer.Write(m_awakeCount);
+	for (int index = 0; index < GetCount(); ++index)
+	{
+		writer.Write(m_owners[index]);
+		writer.Write(m_handleOfIndex[index]);
+		writer.Write(m_owners[index]->m_poolHandle.m_generation);
+	}
+	writer.WriteArray(m_indexOfHandle);
+	writer.WriteArray(m_freeHandles);
+	writer.WriteArray(m_positionX);
+	writer.WriteArray(m_positionY);
+	writer.WriteArray(m_startPositionX);
+	writer.WriteArray(m_startPositionY);
+	writer.WriteArray(m_velocityX);
+	writer.WriteArray(m_velocityY);
+	writer.WriteArray(m_rotation);
+	writer.WriteArray(m_angularVelocity);
+	writer.WriteArray(m_mass);
+	writer.WriteArray(m_drag);
+	writer.WriteArray(m_moment);
+	writer.WriteArray(m_mode);
+	writer.WriteArray(m_physicsEnabled);
+	writer.WriteArray(m_continuousEnabled);
+	writer.WriteArray(m_colliders);
+	writer.WriteArray(m_sleepTime);
+	writer.WriteArray(m_islandIDs);
+	writer.WriteArray(m_transformVersions);
+}
+
+template<typename T>
+static bool SkipBodyArray(PhysicsSnapshotReader2D& reader, int bodyCount)
+{
+	int count = 0;
+	return reader.SkipArray<T>(count) && count == bodyCount;
+}
+
+bool RigidbodyStorage2D::ValidateState(PhysicsSnapshotReader2D& reader) const
+{
+	//the owners may be gone by now, only the live owner a saved one matches is dereferenced
+	int count = 0;
+	int awakeCount = 0;
+	if (!reader.Read(count) || !reader.Read(awakeCount) || count != GetCount() || awakeCount < 0 || awakeCount > count)
+	{
+		return false;
+	}
+	for (int index = 0; index < count; ++index)
+	{
+		Rigidbody2D* owner = nullptr;
+		int handle = -1;
+		unsigned int generation = 0;
+		if (!reader.Read(owner) || !reader.Read(handle) || !reader.Read(generation) || handle < 0 ||
+			handle >= (int)m_indexOfHandle.size() || m_indexOfHandle[handle] == -1 || m_owners[m_indexOfHandle[handle]] != owner ||
+			owner->m_poolHandle.m_generation != generation)
+		{
+			return false;
+		}
+	}
+	int handleCount = 0;
+	int freeHandleCount = 0;
+	return reader.SkipArray<int>(handleCount) && reader.SkipArray<int>(freeHandleCount) &&
+		SkipBodyArray<float>(reader, count) && SkipBodyArray<float>(reader, count) &&
+		SkipBodyArray<float>(reader, count) && SkipBodyArray<float>(reader, count) &&
+		SkipBodyArray<float>(reader, count) && SkipBodyArray<float>(reader, count) &&
+		SkipBodyArray<float>(reader, count) && SkipBodyArray<float>(reader, count) &&
+		SkipBodyArray<float>(reader, count) && SkipBodyArray<float>(reader, count) && SkipBodyArray<float>(reader, count) &&
+		SkipBodyArray<unsigned char>(reader, count) && SkipBodyArray<unsigned char>(reader, count) &&
+		SkipBodyArray<unsigned char>(reader, count) && SkipBodyArray<Collider2D*>(reader, count) &&
+		SkipBodyArray<float>(reader, count) && SkipBodyArray<int>(reader, count) && SkipBodyArray<unsigned int>(reader, count);
+}
+
+void RigidbodyStorage2D::LoadState(PhysicsSnapshotReader2D& reader)
+{
+	int count = 0;
+	reader.Read(count);
+	reader.Read(m_awakeCount);
+	for (int index = 0; index < count; ++index)
+	{
+		unsigned int generation = 0;
+		reader.Read(m_owners[index]);
+		reader.Read(m_handleOfIndex[index]);
+		reader.Read(generation);
+	}
+	reader.ReadArray(m_indexOfHandle);
+	reader.ReadArray(m_freeHandles);
+	reader.ReadArray(m_positionX);
+	reader.ReadArray(m_positionY);
+	reader.ReadArray(m_startPositionX);
+	reader.ReadArray(m_startPositionY);
+	reader.ReadArray(m_velocityX);
+	reader.ReadArray(m_velocityY);
+	reader.ReadArray(m_rotation);
+	reader.ReadArray(m_angularVelocity);
+	reader.ReadArray(m_mass);
+	reader.ReadArray(m_drag);
+	reader.ReadArray(m_moment);
+	reader.ReadArray(m_mode);
+	reader.ReadArray(m_physicsEnabled);
+	reader.ReadArray(m_continuousEnabled);
+	reader.ReadArray(m_colliders);
+	reader.ReadArray(m_sleepTime);
+	reader.ReadArray(m_islandIDs);
+	reader.ReadArray(m_transformVersions);
+}
+
+size_t RigidbodyStorage2D::GetMemoryUsage() const
+{
+	return GetCapacityBytes(m_positionX) + GetCapacityBytes(m_positionY) + GetCapacityBytes(m_startPositionX) +
+		GetCapacityBytes(m_startPositionY) + GetCapacityBytes(m_velocityX) + GetCapacityBytes(m_velocityY) +
+		GetCapacityBytes(m_rotation) + GetCapacityBytes(m_angularVelocity) + GetCapacityBytes(m_mass) +
+		GetCapacityBytes(m_drag) + GetCapacityBytes(m_moment) + GetCapacityBytes(m_mode) +
+		GetCapacityBytes(m_physicsEnabled) + GetCapacityBytes(m_continuousEnabled) + GetCapacityBytes(m_colliders) +
+		GetCapacityBytes(m_sleepTime) + GetCapacityBytes(m_islandIDs) + GetCapacityBytes(m_transformVersions) +
+		GetCapacityBytes(m_owners) + GetCapacityBytes(m_handleOfIndex) + GetCapacityBytes(m_indexOfHandle) +
+		GetCapacityBytes(m_freeHandles);
+}
+
+void RigidbodyStorage2D::Wake(int index)
+{
+	if (m_mode[index] == STATIC)
+	{
+		return;
+	}
+	m_sleepTime[index] = 0.f;
+	m_islandIDs[index] = -1;
+	if (index >= m_awakeCount)
+	{
+		SwapBodies(index, m_awakeCount);
+		++m_awakeCount;
+	}
+}
+
+void RigidbodyStorage2D::Sleep(int index, int islandID)
+{
+	m_velocityX[index] = 0.f;
+	m_velocityY[index] = 0.f;
+	m_angularVelocity[index] = 0.f;
+	m_startPositionX[index] = m_positionX[index];
+	m_startPositionY[index] = m_positionY[index];
+	m_islandIDs[index] = islandID;
+	if (index < m_awakeCount)
+	{
+		SwapBodies(index, m_awakeCount - 1);
+		--m_awakeCount;
+	}
+}
+
+void RigidbodyStorage2D::UpdateSleepTimers(float deltaSeconds)
+{
+	float const linearToleranceSquared = LINEAR_SLEEP_TOLERANCE * LINEAR_SLEEP_TOLERANCE;
+	float const angularToleranceSquared = ANGULAR_SLEEP_TOLERANCE * ANGULAR_SLEEP_TOLERANCE;
+	float const* velocityX = m_velocityX.data();
+	float const* velocityY = m_velocityY.data();
+	float const* angularVelocity = m_angularVelocity.data();
+	float* sleepTime = m_sleepTime.data();
+	for (int index = 0; index < m_awakeCount; ++index)
+	{
+		float linearSpeedSquared = velocityX[index] * velocityX[index] + velocityY[index] * velocityY[index];
+		float angularSpeedSquared = angularVelocity[index] * angularVelocity[index];
+		float stillScale = (float)((linearSpeedSquared <= linearToleranceSquared) & (angularSpeedSquared <= angularToleranceSquared));
+		sleepTime[index] = (sleepTime[index] + deltaSeconds) * stillScale;
+	}
+}
+
+void RigidbodyStorage2D::SwapBodies(int indexA, int indexB)
+{
+	if (indexA == indexB)
+	{
+		return;
+	}
+	std::swap(m_positionX[indexA], m_positionX[indexB]);
+	std::swap(m_positionY[indexA], m_positionY[indexB]);
+	std::swap(m_startPositionX[indexA], m_startPositionX[indexB]);
+	std::swap(m_startPositionY[indexA], m_startPositionY[indexB]);
+	std::swap(m_velocityX[indexA], m_velocityX[indexB]);
+	std::swap(m_velocityY[indexA], m_velocityY[indexB]);
+	std::swap(m_rotation[indexA], m_rotation[indexB]);
+	std::swap(m_angularVelocity[indexA], m_angularVelocity[indexB]);
+	std::swap(m_mass[indexA], m_mass[indexB]);
+	std::swap(m_drag[indexA], m_drag[indexB]);
+	std::swap(m_moment[indexA], m_moment[indexB]);
+	std::swap(m_mode[indexA], m_mode[indexB]);
+	std::swap(m_physicsEnabled[indexA], m_physicsEnabled[indexB]);
+	std::swap(m_continuousEnabled[indexA], m_continuousEnabled[indexB]);
+	std::swap(m_colliders[indexA], m_colliders[indexB]);
+	std::swap(m_sleepTime[indexA], m_sleepTime[indexB]);
+	std::swap(m_islandIDs[indexA], m_islandIDs[indexB]);
+	std::swap(m_transformVersions[indexA], m_transformVersions[indexB]);
+	std::swap(m_owners[indexA], m_owners[indexB]);
+	std::swap(m_handleOfIndex[indexA], m_handleOfIndex[indexB]);
+	m_indexOfHandle[m_handleOfIndex[indexA]] = indexA;
+	m_indexOfHandle[m_handleOfIndex[indexB]] = indexB;
+}
+
+void RigidbodyStorage2D::IntegrateVelocities(Vec2 const& gravity, float deltaSeconds)
+{
+	std::copy(m_positionX.begin(), m_positionX.begin() + m_awakeCount, m_startPositionX.begin());
+	std::copy(m_positionY.begin(), m_positionY.begin() + m_awakeCount, m_startPositionY.begin());
+	IntegrateVelocityAxis(m_velocityX.data(), gravity.x * deltaSeconds, deltaSeconds);
+	IntegrateVelocityAxis(m_velocityY.data(), gravity.y * deltaSeconds, deltaSeconds);
+}
+
+void RigidbodyStorage2D::IntegratePositions(float deltaSeconds)
+{
+	IntegrateAxis(m_positionX.data(), m_velocityX.data(), deltaSeconds);
+	IntegrateAxis(m_positionY.data(), m_velocityY.data(), deltaSeconds);
+	IntegrateAxis(m_rotation.data(), m_angularVelocity.data(), deltaSeconds);
+
+	//one wrap is enough unless a body turns more than a full circle in a single step,
+	//both corrections are picked from the unwrapped value so they stay independent selects
+	int count = m_awakeCount;
+	float* rotation = m_rotation.data();
+	float const twoPi = 2 * 3.14159f;
+	for (int index = 0; index < count; ++index)
+	{
+		float wrapUp = (rotation[index] < 0.f) ? twoPi : 0.f;
+		float wrapDown = (rotation[index] > twoPi) ? twoPi : 0.f;
+		rotation[index] = rotation[index] + wrapUp - wrapDown;
+	}
+}
+
+//The loops below are kept to one written array each with no branches, the compiler only vectorizes
+//them in that shape (more streams means more possible aliasing than it is willing to check at runtime)
+void RigidbodyStorage2D::IntegrateVelocityAxis(float* velocity, float frameGravity, float deltaSeconds)
+{
+	int count = m_awakeCount;
+	float const* mass = m_mass.data();
+	float const* drag = m_drag.data();
+	unsigned char const* mode = m_mode.data();
+	unsigned char const* physicsEnabled = m_physicsEnabled.data();
+	for (int index = 0; index < count; ++index)
+	{
+		//bools turned into 0/1 scales with & and a cast, && or ?: would leave a branch in the loop
+		bool isEnabled = physicsEnabled[index] != 0;
+		float dynamicScale = (float)(isEnabled & (mode[index] == DYNAMIC));
+		float keepScale = (float)(isEnabled & (mode[index] != STATIC));
+		//drag is the only non gravity force for now
+		float massDivisor = (mass[index] > 0.f) ? mass[index] : 1.f;
+		float frameOther = ((-velocity[index] * drag[index]) / massDivisor) * deltaSeconds;
+		velocity[index] = (velocity[index] + frameGravity * dynamicScale + frameOther * dynamicScale) * keepScale;
+	}
+}
+
+void RigidbodyStorage2D::IntegrateAxis(float* value, float const* rate, float deltaSeconds)
+{
+	int count = m_awakeCount;
+	unsigned char const* mode = m_mode.data();
+	unsigned char const* physicsEnabled = m_physicsEnabled.data();
+	for (int index = 0; index < count; ++index)
+	{
+		float moveScale = (float)((physicsEnabled[index] != 0) & (mode[index] != STATIC));
+		value[index] = value[index] + rate[index] * deltaSeconds * moveScale;
+	}
+}
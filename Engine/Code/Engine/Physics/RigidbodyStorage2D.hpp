@@ -0,0 +1,89 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+#include <vector>
+
+class Collider2D;
+class PhysicsSnapshotWriter2D;
+class PhysicsSnapshotReader2D;
+
+//Per-body simulation state owned by Physics2D, one array per field so the integrate loops stream
+//through memory and vectorize. Bodies are packed (swap-remove), Rigidbody2D keeps a handle that stays
+//valid until the body is removed and is translated to the packed index on access.
+//Awake bodies are kept in front of sleeping and static ones so the per-step loops only walk [0, awake count),
+//waking, sleeping, adding and removing a body may therefore move other bodies to a different index.
+class RigidbodyStorage2D
+{
+public:
+	RigidbodyStorage2D() = default;
+	~RigidbodyStorage2D() = default;
+
+	int Add(Rigidbody2D* owner);
+	void Remove(int handle);
+
+	int GetCount() const { return (int)m_owners.size(); }
+	int GetAwakeCount() const { return m_awakeCount; }
+	int GetIndex(int handle) const { return m_indexOfHandle[handle]; }
+	Rigidbody2D* GetOwner(int index) const { return m_owners[index]; }
+
+	//start position = position, then gravity and drag on dynamic bodies, zero velocity on static or disabled ones
+	void IntegrateVelocities(Vec2 const& gravity, float deltaSeconds);
+	//Moves and rotates every movable body, colliders are left for the caller to refit
+	void IntegratePositions(float deltaSeconds);
+	bool IsMovable(int index) const { return index < m_awakeCount && m_physicsEnabled[index] != 0 && m_mode[index] != STATIC; }
+
+	//Static bodies count as asleep for good, they never move
+	bool IsAwake(int index) const { return index < m_awakeCount; }
+	void Wake(int index);
+	//Zeroes the velocity, islandID is what wakes the body together with the rest of its island
+	void Sleep(int index, int islandID);
+	//Awake bodies below both tolerances accumulate still time, anything faster starts over
+	void UpdateSleepTimers(float deltaSeconds);
+
+	//Every field and the packing order, so restored bodies step exactly like the saved ones
+	void SaveState(PhysicsSnapshotWriter2D& writer) const;
+	//Reads through a saved block without changing anything, false unless it is complete and holds the bodies
+	//stored now under the same handles. On success the reader ends up behind the block.
+	bool ValidateState(PhysicsSnapshotReader2D& reader) const;
+	//Only for a block ValidateState accepted
+	void LoadState(PhysicsSnapshotReader2D& reader);
+	size_t GetMemoryUsage() const;
+
+public:
+	static constexpr float LINEAR_SLEEP_TOLERANCE = 0.01f;
+	static constexpr float ANGULAR_SLEEP_TOLERANCE = 2.f * 3.14159f / 180.f;
+	static constexpr float TIME_TO_SLEEP = 0.5f;
+
+public:
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_startPositionX;
+	std::vector<float> m_startPositionY;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_rotation;
+	std::vector<float> m_angularVelocity;
+	std::vector<float> m_mass;
+	std::vector<float> m_drag;
+	std::vector<float> m_moment;
+	std::vector<unsigned char> m_mode;			//eSimulationMode, bytes so the integrate loops can compare them as vectors
+	std::vector<unsigned char> m_physicsEnabled;
+	std::vector<unsigned char> m_continuousEnabled;	//swept against the other colliders instead of teleported
+	std::vector<Collider2D*> m_colliders;		//mirrors Rigidbody2D::m_collider so refitting does not touch the facades
+	std::vector<float> m_sleepTime;				//seconds spent below the sleep tolerances
+	std::vector<int> m_islandIDs;				//island a sleeping body went to sleep with, -1 while awake
+	std::vector<unsigned int> m_transformVersions;	//bumped whenever position or rotation is written back, starts at 1
+
+private:
+	void SwapBodies(int indexA, int indexB);
+	void IntegrateVelocityAxis(float* velocity, float frameGravity, float deltaSeconds);
+	//value += rate * deltaSeconds on movable bodies
+	void IntegrateAxis(float* value, float const* rate, float deltaSeconds);
+
+private:
+	std::vector<Rigidbody2D*> m_owners;
+	std::vector<int> m_handleOfIndex;
+	std::vector<int> m_indexOfHandle;		//-1 for free handles
+	std::vector<int> m_freeHandles;
+	int m_awakeCount = 0;
+};
@@ -0,0 +1,47 @@
+#include "Engine/Physics/ShapeArena2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+
+int ShapeArena2D::Allocate(int count)
+{
+	int offset = (int)m_vertices.size();
+	m_vertices.resize(offset + count, Vec2::ZERO);
+	m_normals.resize(offset + count, Vec2::ZERO);
+	return offset;
+}
+
+void ShapeArena2D::Release(int count)
+{
+	m_releasedCount += count;
+}
+
+bool ShapeArena2D::NeedsCompact() const
+{
+	//only worth the copy once at least half of the arena is dead
+	return m_releasedCount * 2 > (int)m_vertices.size();
+}
+
+void ShapeArena2D::BeginCompact()
+{
+	m_compactVertices.clear();
+	m_compactNormals.clear();
+}
+
+int ShapeArena2D::Keep(int offset, int count)
+{
+	int newOffset = (int)m_compactVertices.size();
+	m_compactVertices.insert(m_compactVertices.end(), m_vertices.begin() + offset, m_vertices.begin() + offset + count);
+	m_compactNormals.insert(m_compactNormals.end(), m_normals.begin() + offset, m_normals.begin() + offset + count);
+	return newOffset;
+}
+
+void ShapeArena2D::EndCompact()
+{
+	m_vertices.swap(m_compactVertices);
+	m_normals.swap(m_compactNormals);
+	m_releasedCount = 0;
+}
+
+size_t ShapeArena2D::GetMemoryUsage() const
+{
+	return GetCapacityBytes(m_vertices) + GetCapacityBytes(m_normals) + GetCapacityBytes(m_compactVertices) + GetCapacityBytes(m_compactNormals);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+//World space vertices and outward edge normals of every polygon collider in a system, back to back in two arrays.
+//Colliders keep an offset into it, ranges of destroyed colliders are reclaimed by compacting.
+class ShapeArena2D
+{
+public:
+	ShapeArena2D() = default;
+	~ShapeArena2D() = default;
+
+	//Returns the offset of count new vertices and normals
+	int Allocate(int count);
+	void Release(int count);
+	bool NeedsCompact() const;
+	//Keep copies one live range into the new layout and returns its new offset, call it for every live range in between
+	void BeginCompact();
+	int Keep(int offset, int count);
+	void EndCompact();
+	size_t GetMemoryUsage() const;
+
+	Vec2* GetVertices(int offset) { return m_vertices.data() + offset; }
+	Vec2 const* GetVertices(int offset) const { return m_vertices.data() + offset; }
+	Vec2* GetNormals(int offset) { return m_normals.data() + offset; }
+	Vec2 const* GetNormals(int offset) const { return m_normals.data() + offset; }
+
+private:
+	std::vector<Vec2> m_vertices;
+	std::vector<Vec2> m_normals;
+	std::vector<Vec2> m_compactVertices;
+	std::vector<Vec2> m_compactNormals;
+	int m_releasedCount = 0;
+};
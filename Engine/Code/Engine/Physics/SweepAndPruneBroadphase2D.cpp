@@ -0,0 +1,371 @@
+#include "Engine/Physics/SweepAndPruneBroadphase2D.hpp"
+#include "Engine/Physics/Collider2D.hpp"
+#include "Engine/Physics/PhysicsStats2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+
+static float GetAxisValue(AABB2 const& bounds, int axis, bool isMax)
+{
+	Vec2 const& corner = isMax ? bounds.maxs : bounds.mins;
+	return (axis == 0) ? corner.x : corner.y;
+}
+
+//Touching counts, to match the endpoint order where a min sorts before a max of the same value
+static bool DoBoundsTouch(AABB2 const& boundsA, AABB2 const& boundsB)
+{
+	return boundsA.mins.x <= boundsB.maxs.x && boundsB.mins.x <= boundsA.maxs.x &&
+		boundsA.mins.y <= boundsB.maxs.y && boundsB.mins.y <= boundsA.maxs.y;
+}
+
+static bool IsEndpointAfter(SAPEndpoint2D const& endpointA, SAPEndpoint2D const& endpointB)
+{
+	if (endpointA.m_value != endpointB.m_value)
+	{
+		return endpointA.m_value > endpointB.m_value;
+	}
+	return endpointA.m_isMax && !endpointB.m_isMax;
+}
+
+int SweepAndPruneBroadphase2D::CreateProxy(AABB2 const& bounds, Collider2D* collider)
+{
+	int proxyID = 0;
+	if (m_freeProxyIDs.empty())
+	{
+		proxyID = (int)m_proxies.size();
+		m_proxies.emplace_back();
+	}
+	else
+	{
+		proxyID = m_freeProxyIDs.back();
+		m_freeProxyIDs.pop_back();
+	}
+	m_proxies[proxyID].m_bounds = bounds;
+	m_proxies[proxyID].m_collider = collider;
+	m_proxies[proxyID].m_queryTreeProxyID = m_queryTree.CreateProxy(bounds, (void*)(intptr_t)proxyID);
+	//endpoints are added by the next update
+	m_newProxyIDs.push_back(proxyID);
+	return proxyID;
+}
+
+void SweepAndPruneBroadphase2D::DestroyProxy(int proxyID)
+{
+	//endpoints and overlaps stay until the next update walks past them
+	m_proxies[proxyID].m_collider = nullptr;
+	m_queryTree.DestroyProxy(m_proxies[proxyID].m_queryTreeProxyID);
+	m_proxies[proxyID].m_queryTreeProxyID = -1;
+	m_destroyedProxyIDs.push_back(proxyID);
+}
+
+void SweepAndPruneBroadphase2D::MoveProxy(int proxyID, AABB2 const& bounds)
+{
+	SAPProxy2D& proxy = m_proxies[proxyID];
+	proxy.m_bounds = bounds;
+	if (!proxy.m_isQueryTreeStale)
+	{
+		proxy.m_isQueryTreeStale = true;
+		m_staleQueryProxyIDs.push_back(proxyID);
+		m_isQueryTreeStale.store(true, std::memory_order_relaxed);
+	}
+}
+
+void SweepAndPruneBroadphase2D::QueryBounds(AABB2 const& bounds, query_cb callback, void* context) const
+{
+	UpdateQueryTree();
+	m_queryTree.Query(bounds, [this, &bounds, callback, context](int treeProxyID)
+	{
+		//the tree only knows the fattened bounds
+		SAPProxy2D const& proxy = m_proxies[(int)(intptr_t)m_queryTree.GetUserData(treeProxyID)];
+		return !DoAABBsOverlap2D(proxy.m_bounds, bounds) || callback(context, proxy.m_collider);
+	});
+}
+
+void SweepAndPruneBroadphase2D::QueryRay(Vec2 const& start, Vec2 const& direction, float maxDistance, float radius, raycast_cb callback, void* context) const
+{
+	UpdateQueryTree();
+	Vec2 const grow(radius, radius);
+	m_queryTree.RayCast(start, direction, maxDistance, radius, [this, &start, &direction, &grow, callback, context](int treeProxyID, float currentMaxDistance)
+	{
+		SAPProxy2D const& proxy = m_proxies[(int)(intptr_t)m_queryTree.GetUserData(treeProxyID)];
+		float entryDistance = 0.f;
+		if (!RaycastVsAABB2D(start, direction, currentMaxDistance, AABB2(proxy.m_bounds.mins - grow, proxy.m_bounds.maxs + grow), entryDistance))
+		{
+			return currentMaxDistance;
+		}
+		return callback(context, proxy.m_collider, currentMaxDistance);
+	});
+}
+
+void SweepAndPruneBroadphase2D::UpdateQueryTree() const
+{
+	if (!m_isQueryTreeStale.load(std::memory_order_acquire))
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> queryTreeLock(m_queryTreeMutex);
+	if (!m_isQueryTreeStale.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	for (int proxyID : m_staleQueryProxyIDs)
+	{
+		SAPProxy2D const& proxy = m_proxies[proxyID];
+		proxy.m_isQueryTreeStale = false;
+		if (proxy.m_queryTreeProxyID != -1)
+		{
+			m_queryTree.MoveProxy(proxy.m_queryTreeProxyID, proxy.m_bounds);
+		}
+	}
+	m_staleQueryProxyIDs.clear();
+	m_isQueryTreeStale.store(false, std::memory_order_release);
+}
+
+size_t SweepAndPruneBroadphase2D::GetMemoryUsage() const
+{
+	//one bucket pointer per bucket, a next pointer and the key per node
+	size_t overlapBytes = m_overlaps.bucket_count() * sizeof(void*) + m_overlaps.size() * (sizeof(void*) + sizeof(uint64_t));
+	return Broadphase2D::GetMemoryUsage() + GetCapacityBytes(m_proxies) + GetCapacityBytes(m_freeProxyIDs) +
+		GetCapacityBytes(m_destroyedProxyIDs) + GetCapacityBytes(m_newProxyIDs) + GetCapacityBytes(m_endpoints[0]) +
+		GetCapacityBytes(m_endpoints[1]) + GetCapacityBytes(m_newEndpoints) + GetCapacityBytes(m_mergedEndpoints) +
+		overlapBytes + GetCapacityBytes(m_addedKeys) + GetCapacityBytes(m_removedKeys) + m_queryTree.GetMemoryUsage() +
+		GetCapacityBytes(m_staleQueryProxyIDs);
+}
+
+void SweepAndPruneBroadphase2D::UpdatePairs()
+{
+	m_addedKeys.clear();
+	m_removedKeys.clear();
+	bool isRebuild = (int)m_newProxyIDs.size() > NEW_PROXIES_BEFORE_REBUILD;
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		//new endpoints in order, destroyed proxies created since the last update never get any
+		m_newEndpoints.clear();
+		for (int proxyID : m_newProxyIDs)
+		{
+			SAPProxy2D const& proxy = m_proxies[proxyID];
+			if (proxy.m_collider != nullptr)
+			{
+				SAPEndpoint2D endpoint;
+				endpoint.m_proxyID = proxyID;
+				endpoint.m_isMax = false;
+				endpoint.m_value = GetAxisValue(proxy.m_bounds, axis, false);
+				m_newEndpoints.push_back(endpoint);
+				endpoint.m_isMax = true;
+				endpoint.m_value = GetAxisValue(proxy.m_bounds, axis, true);
+				m_newEndpoints.push_back(endpoint);
+			}
+		}
+		if (!isRebuild)
+		{
+			std::sort(m_newEndpoints.begin(), m_newEndpoints.end(), [](SAPEndpoint2D const& endpointA, SAPEndpoint2D const& endpointB)
+			{
+				return IsEndpointAfter(endpointB, endpointA);
+			});
+		}
+
+		//one pass refreshes the values, drops the endpoints of destroyed proxies and merges the new ones in where they go
+		//among last step's values, so the sort below only moves them as far as the others moved
+		std::vector<SAPEndpoint2D>& endpoints = m_endpoints[axis];
+		m_mergedEndpoints.clear();
+		m_mergedEndpoints.reserve(endpoints.size() + m_newEndpoints.size());
+		size_t newIndex = 0;
+		for (SAPEndpoint2D const& endpoint : endpoints)
+		{
+			while (!isRebuild && newIndex < m_newEndpoints.size() && !IsEndpointAfter(m_newEndpoints[newIndex], endpoint))
+			{
+				m_mergedEndpoints.push_back(m_newEndpoints[newIndex++]);
+			}
+			SAPProxy2D const& proxy = m_proxies[endpoint.m_proxyID];
+			if (proxy.m_collider != nullptr)
+			{
+				m_mergedEndpoints.push_back(endpoint);
+				m_mergedEndpoints.back().m_value = GetAxisValue(proxy.m_bounds, axis, endpoint.m_isMax);
+			}
+		}
+		m_mergedEndpoints.insert(m_mergedEndpoints.end(), m_newEndpoints.begin() + newIndex, m_newEndpoints.end());
+		endpoints.swap(m_mergedEndpoints);
+	}
+	if (isRebuild)
+	{
+		RebuildOverlaps();
+	}
+	else
+	{
+		SortAxis(0);
+		SortAxis(1);
+		//the sort only finds overlaps where endpoints trade places, the query tree finds the ones new proxies started with
+		if (!m_newProxyIDs.empty())
+		{
+			UpdateQueryTree();
+		}
+		for (int proxyID : m_newProxyIDs)
+		{
+			SAPProxy2D const& proxy = m_proxies[proxyID];
+			if (proxy.m_collider == nullptr)
+			{
+				continue;
+			}
+			m_queryTree.Query(proxy.m_bounds, [this, proxyID, &proxy](int treeProxyID)
+			{
+				int otherProxyID = (int)(intptr_t)m_queryTree.GetUserData(treeProxyID);
+				if (otherProxyID != proxyID && DoBoundsTouch(proxy.m_bounds, m_proxies[otherProxyID].m_bounds))
+				{
+					AddOverlap(proxyID, otherProxyID);
+				}
+				return true;
+			});
+		}
+	}
+	m_newProxyIDs.clear();
+
+	//overlaps of destroyed proxies are dropped by the pass that turns the overlaps into pairs
+	m_pairs.clear();
+	m_pairs.reserve(m_overlaps.size());
+	for (auto overlapIter = m_overlaps.begin(); overlapIter != m_overlaps.end();)
+	{
+		if (IsOverlapDestroyed(*overlapIter))
+		{
+			overlapIter = m_overlaps.erase(overlapIter);
+		}
+		else
+		{
+			m_pairs.push_back(GetPairFromKey(*overlapIter));
+			++overlapIter;
+		}
+	}
+	SortPairs(m_pairs);
+	//only now can the ids of destroyed proxies be handed out again
+	m_freeProxyIDs.insert(m_freeProxyIDs.end(), m_destroyedProxyIDs.begin(), m_destroyedProxyIDs.end());
+	m_destroyedProxyIDs.clear();
+
+	m_addedPairs.clear();
+	for (uint64_t key : m_addedKeys)
+	{
+		m_addedPairs.push_back(GetPairFromKey(key));
+	}
+	SortPairs(m_addedPairs);
+	m_removedPairs.clear();
+	for (uint64_t key : m_removedKeys)
+	{
+		m_removedPairs.push_back(GetPairFromKey(key));
+	}
+	SortPairs(m_removedPairs);
+}
+
+uint64_t SweepAndPruneBroadphase2D::GetProxyPairKey(int proxyIDA, int proxyIDB)
+{
+	uint32_t lowID = (uint32_t)std::min(proxyIDA, proxyIDB);
+	uint32_t highID = (uint32_t)std::max(proxyIDA, proxyIDB);
+	return ((uint64_t)lowID << 32) | highID;
+}
+
+bool SweepAndPruneBroadphase2D::IsOverlapDestroyed(uint64_t key) const
+{
+	return m_proxies[(int)(key >> 32)].m_collider == nullptr || m_proxies[(int)(key & 0xffffffff)].m_collider == nullptr;
+}
+
+void SweepAndPruneBroadphase2D::SortAxis(int axis)
+{
+	std::vector<SAPEndpoint2D>& endpoints = m_endpoints[axis];
+	for (int endpointIndex = 1; endpointIndex < (int)endpoints.size(); ++endpointIndex)
+	{
+		SAPEndpoint2D moving = endpoints[endpointIndex];
+		int insertIndex = endpointIndex;
+		while (insertIndex > 0 && IsEndpointAfter(endpoints[insertIndex - 1], moving))
+		{
+			//each swap is a pair of endpoints whose order really changed since the last step
+			SAPEndpoint2D const& passed = endpoints[insertIndex - 1];
+			if (!moving.m_isMax && passed.m_isMax)
+			{
+				//a min moved below another proxy's max: they may have started to overlap
+				if (DoBoundsTouch(m_proxies[moving.m_proxyID].m_bounds, m_proxies[passed.m_proxyID].m_bounds))
+				{
+					AddOverlap(moving.m_proxyID, passed.m_proxyID);
+				}
+			}
+			else if (moving.m_isMax && !passed.m_isMax)
+			{
+				//a max moved below another proxy's min: separated on this axis
+				RemoveOverlap(moving.m_proxyID, passed.m_proxyID);
+			}
+			endpoints[insertIndex] = passed;
+			--insertIndex;
+		}
+		endpoints[insertIndex] = moving;
+	}
+}
+
+void SweepAndPruneBroadphase2D::RebuildOverlaps()
+{
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		std::sort(m_endpoints[axis].begin(), m_endpoints[axis].end(), [](SAPEndpoint2D const& endpointA, SAPEndpoint2D const& endpointB)
+		{
+			return IsEndpointAfter(endpointB, endpointA);
+		});
+	}
+
+	//sweep along x keeping the proxies whose interval is open, each one is tested against those on y
+	std::unordered_set<uint64_t> previousOverlaps;
+	previousOverlaps.swap(m_overlaps);
+	std::vector<int> openProxyIDs;
+	for (SAPEndpoint2D const& endpoint : m_endpoints[0])
+	{
+		if (endpoint.m_isMax)
+		{
+			auto openIter = std::find(openProxyIDs.begin(), openProxyIDs.end(), endpoint.m_proxyID);
+			*openIter = openProxyIDs.back();
+			openProxyIDs.pop_back();
+			continue;
+		}
+		AABB2 const& bounds = m_proxies[endpoint.m_proxyID].m_bounds;
+		for (int openProxyID : openProxyIDs)
+		{
+			if (DoBoundsTouch(bounds, m_proxies[openProxyID].m_bounds))
+			{
+				m_overlaps.insert(GetProxyPairKey(endpoint.m_proxyID, openProxyID));
+			}
+		}
+		openProxyIDs.push_back(endpoint.m_proxyID);
+	}
+
+	for (uint64_t key : m_overlaps)
+	{
+		if (previousOverlaps.find(key) == previousOverlaps.end())
+		{
+			m_addedKeys.push_back(key);
+		}
+	}
+	for (uint64_t key : previousOverlaps)
+	{
+		//overlaps of destroyed proxies end without being reported
+		if (!IsOverlapDestroyed(key) && m_overlaps.find(key) == m_overlaps.end())
+		{
+			m_removedKeys.push_back(key);
+		}
+	}
+}
+
+void SweepAndPruneBroadphase2D::AddOverlap(int proxyIDA, int proxyIDB)
+{
+	uint64_t key = GetProxyPairKey(proxyIDA, proxyIDB);
+	if (m_overlaps.insert(key).second)
+	{
+		m_addedKeys.push_back(key);
+	}
+}
+
+void SweepAndPruneBroadphase2D::RemoveOverlap(int proxyIDA, int proxyIDB)
+{
+	uint64_t key = GetProxyPairKey(proxyIDA, proxyIDB);
+	if (m_overlaps.erase(key) > 0)
+	{
+		m_removedKeys.push_back(key);
+	}
+}
+
+ColliderPair2D SweepAndPruneBroadphase2D::GetPairFromKey(uint64_t key) const
+{
+	int lowID = (int)(key >> 32);
+	int highID = (int)(key & 0xffffffff);
+	return MakePair(m_proxies[lowID].m_collider, m_proxies[highID].m_collider);
+}
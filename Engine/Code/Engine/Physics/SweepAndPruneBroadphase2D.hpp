@@ -0,0 +1,77 @@
+#pragma once
+#include "Engine/Physics/Broadphase2D.hpp"
+#include "Engine/Physics/AABBTree2D.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+
+struct SAPEndpoint2D
+{
+	float m_value = 0.f;
+	int m_proxyID = -1;
+	bool m_isMax = false;
+};
+
+struct SAPProxy2D
+{
+	AABB2 m_bounds;
+	Collider2D* m_collider = nullptr;		//nullptr once destroyed
+	int m_queryTreeProxyID = -1;
+	mutable bool m_isQueryTreeStale = false;	//moved since the query tree last saw it
+};
+
+//Incremental sort and sweep. Both axes keep their endpoint arrays sorted from the previous step and are
+//re-sorted with insertion sort, so a step where little moved costs about one pass over the endpoints.
+//Pairs are added and removed exactly where a min endpoint and a max endpoint trade places. New proxies are merged in
+//where they belong and get their first overlaps from the query tree, destroyed ones are dropped by passes the update makes anyway.
+//QueryBounds and QueryRay search an AABB tree of the same proxies. Moves only reach the tree once a query needs it,
+//so steps without queries do not pay for keeping it up to date.
+class SweepAndPruneBroadphase2D : public Broadphase2D
+{
+public:
+	SweepAndPruneBroadphase2D() = default;
+	virtual ~SweepAndPruneBroadphase2D() = default;
+
+	virtual int CreateProxy(AABB2 const& bounds, Collider2D* collider) override;
+	virtual void DestroyProxy(int proxyID) override;
+	virtual void MoveProxy(int proxyID, AABB2 const& bounds) override;
+	virtual void UpdatePairs() override;
+	using Broadphase2D::QueryBounds;
+	virtual void QueryBounds(AABB2 const& bounds, query_cb callback, void* context) const override;
+	virtual void QueryRay(Vec2 const& start, Vec2 const& direction, float maxDistance, float radius, raycast_cb callback, void* context) const override;
+	//The overlap set is estimated from its bucket and node counts
+	virtual size_t GetMemoryUsage() const override;
+
+private:
+	static constexpr int NEW_PROXIES_BEFORE_REBUILD = 64;
+
+	static uint64_t GetProxyPairKey(int proxyIDA, int proxyIDB);
+	//Either proxy was destroyed since the last update
+	bool IsOverlapDestroyed(uint64_t key) const;
+	void SortAxis(int axis);
+	//Used when a lot of proxies arrived at once, one query tree search each would cost more than starting over
+	void RebuildOverlaps();
+	void AddOverlap(int proxyIDA, int proxyIDB);
+	void RemoveOverlap(int proxyIDA, int proxyIDB);
+	ColliderPair2D GetPairFromKey(uint64_t key) const;
+	//Queries may run on several threads at once, the first one brings the tree up to date for all of them
+	void UpdateQueryTree() const;
+
+private:
+	std::vector<SAPProxy2D> m_proxies;
+	std::vector<int> m_freeProxyIDs;
+	std::vector<int> m_destroyedProxyIDs;	//ids are not reused until the next update dropped their endpoints and overlaps
+	std::vector<int> m_newProxyIDs;			//created since the last update, their endpoints are not in yet
+	std::vector<SAPEndpoint2D> m_endpoints[2];
+	std::vector<SAPEndpoint2D> m_newEndpoints;		//scratch for one axis
+	std::vector<SAPEndpoint2D> m_mergedEndpoints;	//the next endpoints of one axis, swapped in
+	std::unordered_set<uint64_t> m_overlaps;
+	std::vector<uint64_t> m_addedKeys;
+	std::vector<uint64_t> m_removedKeys;
+
+	mutable AABBTree2D m_queryTree;			//user data is the proxy id
+	mutable std::vector<int> m_staleQueryProxyIDs;
+	mutable std::atomic<bool> m_isQueryTreeStale{ false };
+	mutable std::mutex m_queryTreeMutex;
+};
@@ -0,0 +1,166 @@
+#include "Engine/Physics/TimeOfImpact2D.hpp"
+#include "Engine/Physics/Collider2D.hpp"
+#include "Engine/Physics/DiscCollider2D.hpp"
+#include "Engine/Physics/PolygonCollider2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+static constexpr int MAX_ADVANCEMENT_ITERATIONS = 20;
+static constexpr float TIME_OF_IMPACT_TOLERANCE = 0.25f;	//of the target distance, how close counts as arrived
+
+static float GetDistanceFromPointToPolygon(Vec2 const& point, Vec2 const* points, int pointCount, Vec2& outNormal)
+{
+	if (IsPointInsidePolygon2D(point, points, pointCount))
+	{
+		return 0.f;
+	}
+	Vec2 nearestPoint = GetNearestPointOnPolygon2DEdge(point, points, pointCount);
+	Vec2 diff = point - nearestPoint;
+	float distance = diff.GetLength();
+	if (distance > 0.f)
+	{
+		outNormal = diff / distance;
+	}
+	return distance;
+}
+
+//Separated convex polygons are closest between a vertex of one and an edge of the other
+static float GetDistanceBetweenPolygons(Vec2 const* pointsA, int countA, Vec2 const& centerA, Vec2 const* pointsB, int countB, Vec2 const& centerB,
+	Vec2& outNormal)
+{
+	if (IsPolygonIntersectWithOtherPolygon(pointsA, countA, centerA, pointsB, countB, centerB))
+	{
+		return 0.f;
+	}
+	float closestDistance = INFINITY;
+	for (int vertexIndex = 0; vertexIndex < countA; ++vertexIndex)
+	{
+		Vec2 nearestPoint = GetNearestPointOnPolygon2DEdge(pointsA[vertexIndex], pointsB, countB);
+		Vec2 diff = pointsA[vertexIndex] - nearestPoint;
+		float distance = diff.GetLength();
+		if (distance < closestDistance && distance > 0.f)
+		{
+			closestDistance = distance;
+			outNormal = diff / distance;
+		}
+	}
+	for (int vertexIndex = 0; vertexIndex < countB; ++vertexIndex)
+	{
+		Vec2 nearestPoint = GetNearestPointOnPolygon2DEdge(pointsB[vertexIndex], pointsA, countA);
+		Vec2 diff = nearestPoint - pointsB[vertexIndex];
+		float distance = diff.GetLength();
+		if (distance < closestDistance && distance > 0.f)
+		{
+			closestDistance = distance;
+			outNormal = diff / distance;
+		}
+	}
+	return closestDistance;
+}
+
+//Distance from point to other, outNormal points from other towards point
+static float GetDistanceFromPointToCollider(Vec2 const& point, Collider2D const* other, Vec2& outNormal)
+{
+	if (other->m_type == COLLIDER2D_DISC)
+	{
+		DiscCollider2D const* disc = (DiscCollider2D const*)other;
+		Vec2 diff = point - disc->m_worldPosition;
+		float distance = diff.GetLength();
+		if (distance > 0.f)
+		{
+			outNormal = diff / distance;
+		}
+		return distance - disc->m_radius;
+	}
+	PolygonCollider2D const* polygon = (PolygonCollider2D const*)other;
+	return GetDistanceFromPointToPolygon(point, polygon->GetWorldPoints(), polygon->GetVertexCount(), outNormal);
+}
+
+//Gap between the shapes with collider moved to fraction t of the sweep, negative or zero once they overlap
+static float GetSweptDistance(Collider2D const* collider, ColliderSweep2D const& sweep, float t, Collider2D const* other,
+	std::vector<Vec2>& scratchPoints, Vec2& outNormal)
+{
+	Vec2 position = sweep.m_startPosition + sweep.m_translation * t;
+	if (collider->m_type == COLLIDER2D_DISC)
+	{
+		return GetDistanceFromPointToCollider(position, other, outNormal) - collider->GetRadius();
+	}
+
+	PolygonCollider2D const* polygon = (PolygonCollider2D const*)collider;
+	std::vector<Vec2> const& localPoints = polygon->m_polygon->GetPoints();
+	int numVertices = (int)localPoints.size();
+	float degrees = ConvertRadiansToDegrees(sweep.m_startRadians + sweep.m_rotationRadians * t);
+	scratchPoints.resize(numVertices);
+	for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+	{
+		scratchPoints[vertexIndex] = localPoints[vertexIndex].GetRotatedDegrees(degrees) + position;
+	}
+	if (other->m_type == COLLIDER2D_DISC)
+	{
+		DiscCollider2D const* disc = (DiscCollider2D const*)other;
+		//measured from the disc, so the normal comes back pointing at it
+		Vec2 normal = -outNormal;
+		float distance = GetDistanceFromPointToPolygon(disc->m_worldPosition, scratchPoints.data(), numVertices, normal) - disc->m_radius;
+		outNormal = -normal;
+		return distance;
+	}
+	PolygonCollider2D const* otherPolygon = (PolygonCollider2D const*)other;
+	return GetDistanceBetweenPolygons(scratchPoints.data(), numVertices, position,
+		otherPolygon->GetWorldPoints(), otherPolygon->GetVertexCount(), otherPolygon->m_worldPosition, outNormal);
+}
+
+ColliderSweep2D GetColliderSweep(Collider2D const* collider)
+{
+	ColliderSweep2D sweep;
+	if (collider->m_type == COLLIDER2D_DISC)
+	{
+		DiscCollider2D const* disc = (DiscCollider2D const*)collider;
+		sweep.m_startPosition = disc->m_worldPosition;
+		sweep.m_startRadians = disc->m_worldRotation;
+	}
+	else
+	{
+		PolygonCollider2D const* polygon = (PolygonCollider2D const*)collider;
+		sweep.m_startPosition = polygon->m_worldPosition;
+		sweep.m_startRadians = polygon->m_worldRotation;
+	}
+	return sweep;
+}
+
+TimeOfImpact2D GetTimeOfImpact(Collider2D const* collider, ColliderSweep2D const& sweep, Collider2D const* other,
+	float targetDistance, std::vector<Vec2>& scratchPoints)
+{
+	TimeOfImpact2D result;
+	//no point of the collider moves further than this over the whole sweep, discs turn in place
+	float rotationRadius = collider->m_type == COLLIDER2D_POLYGON ? collider->GetRadius() : 0.f;
+	float maxTravel = sweep.m_translation.GetLength() + fabsf(sweep.m_rotationRadians) * rotationRadius;
+	if (maxTravel <= 0.f)
+	{
+		return result;
+	}
+
+	float const arrivedDistance = targetDistance * (1.f + TIME_OF_IMPACT_TOLERANCE);
+	Vec2 normal = -sweep.m_translation.GetNormalized();
+	float distance = GetSweptDistance(collider, sweep, 0.f, other, scratchPoints, normal);
+	if (distance < arrivedDistance)
+	{
+		return result;
+	}
+	//every advance is one the shapes can not close the gap in, so the sweep never steps past the impact
+	float t = 0.f;
+	for (int iteration = 0; iteration < MAX_ADVANCEMENT_ITERATIONS; ++iteration)
+	{
+		t += (distance - targetDistance) / maxTravel;
+		if (t >= 1.f)
+		{
+			return result;
+		}
+		distance = GetSweptDistance(collider, sweep, t, other, scratchPoints, normal);
+		if (distance < arrivedDistance)
+		{
+			break;
+		}
+	}
+	result.m_fraction = t;
+	result.m_normal = normal;
+	return result;
+}
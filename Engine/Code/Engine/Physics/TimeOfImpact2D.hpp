@@ -0,0 +1,29 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+class Collider2D;
+
+//Motion of a collider's world pose over a step, rotation in radians
+struct ColliderSweep2D
+{
+	Vec2 m_startPosition = Vec2::ZERO;
+	float m_startRadians = 0.f;
+	Vec2 m_translation = Vec2::ZERO;
+	float m_rotationRadians = 0.f;
+};
+
+struct TimeOfImpact2D
+{
+	float m_fraction = 1.f;			//of the sweep, 1 when nothing was hit
+	Vec2 m_normal = Vec2::ZERO;		//points from the other collider towards the swept one
+};
+
+//A sweep that starts at the collider's current world pose and does not move yet
+ColliderSweep2D GetColliderSweep(Collider2D const* collider);
+
+//Conservative advancement of collider along sweep against other, which holds still at its current pose.
+//Stops once the shapes come within targetDistance, pairs already that close at the start are left to the
+//discrete pass. scratchPoints holds the swept polygon, it is reused between calls.
+TimeOfImpact2D GetTimeOfImpact(Collider2D const* collider, ColliderSweep2D const& sweep, Collider2D const* other,
+	float targetDistance, std::vector<Vec2>& scratchPoints);
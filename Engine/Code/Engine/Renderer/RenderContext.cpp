@@ -636,7 +636,7 @@ void RenderContext::DrawPolygon2(const Polygon2D& polygon, const Rgba8& tint)
 	Vec2 center = polygon.GetCenter();
 	int numPoints = polygon.GetVertexCount();
 
-	std::vector<Vec2> points = polygon.GetPoints();
+	std::vector<Vec2> const& points = polygon.GetPoints();
 	std::vector<Vertex_PCU> vertices;
 	for (int edgeIndex = 0; edgeIndex < numPoints - 1; ++edgeIndex)
 	{
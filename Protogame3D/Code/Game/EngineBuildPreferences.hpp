@@ -9,3 +9,4 @@
 //
 
 //#define ENGINE_DISABLE_AUDIO	// (If uncommented) Disables AudioSystem code and fmod linkage.
+//#define ENGINE_DISABLE_JOB_TRACE	// (If uncommented) Compiles out JobSystem tracing and DumpTrace.
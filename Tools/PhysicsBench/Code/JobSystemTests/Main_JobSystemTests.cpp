@@ -0,0 +1,226 @@
+#include "Engine/Core/JobSystem.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+//Each test gets this long before the watchdog assumes it hung, e.g. on a deadlocked wait
+static constexpr int TEST_TIMEOUT_SECONDS = 30;
+
+typedef bool(*JobSystemTestFunction)();
+
+struct JobSystemTest
+{
+	char const* m_name;
+	JobSystemTestFunction m_run;
+};
+
+static void SleepMilliseconds(int milliseconds)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+//The only worker is busy with a frame critical job and a slow background job is queued behind it.
+//The main thread waiting for the frame job must not pick up the background job in the meantime.
+static bool TestFrameWaitSkipsBackgroundJobs()
+{
+	JobSystem jobSystem;
+	jobSystem.CreateWorkerThreads(1);
+	std::thread::id const mainThreadID = std::this_thread::get_id();
+
+	std::atomic<bool> hasFrameJobStarted(false);
+	JobCounter frameCounter;
+	jobSystem.PostLambdaJob([&hasFrameJobStarted]()
+	{
+		hasFrameJobStarted.store(true);
+		SleepMilliseconds(50);
+	}, &frameCounter, JOB_PRIORITY_FRAME_CRITICAL);
+	while (!hasFrameJobStarted.load())
+	{
+		std::this_thread::yield();
+	}
+
+	std::atomic<bool> didMainThreadRunBackgroundJob(false);
+	JobHandle backgroundJob = jobSystem.PostLambdaJob([&didMainThreadRunBackgroundJob, mainThreadID]()
+	{
+		didMainThreadRunBackgroundJob.store(std::this_thread::get_id() == mainThreadID);
+		SleepMilliseconds(200);
+	}, JOB_PRIORITY_BACKGROUND);
+
+	jobSystem.WaitFor(frameCounter);
+	//the worker may have started it by now, but not finished it
+	bool isBackgroundJobUnfinished = jobSystem.GetStatus(backgroundJob) != JOB_STATUS_COMPLETED;
+	while (jobSystem.GetStatus(backgroundJob) != JOB_STATUS_COMPLETED)
+	{
+		SleepMilliseconds(1);
+	}
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	jobSystem.ShutDown();
+	return !didMainThreadRunBackgroundJob.load() && isBackgroundJobUnfinished;
+}
+
+//Nothing but the waiting thread can run the job, so it has to help with the job's lane even if it is less urgent
+static bool TestBackgroundWaitWithoutWorkersFinishes()
+{
+	JobSystem jobSystem;
+	std::atomic<int> numJobsRun(0);
+	JobHandle backgroundJob = jobSystem.PostLambdaJob([&numJobsRun]() { numJobsRun.fetch_add(1); }, JOB_PRIORITY_BACKGROUND);
+	jobSystem.WaitFor(backgroundJob);
+	JobCounter counter;
+	jobSystem.PostLambdaJob([&numJobsRun]() { numJobsRun.fetch_add(1); }, &counter, JOB_PRIORITY_BACKGROUND);
+	jobSystem.WaitFor(counter);
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	jobSystem.ShutDown();
+	return numJobsRun.load() == 2;
+}
+
+//Polls instead of WaitFor, so the main thread never runs a job and the workers have to sort the waits out themselves
+static void PollUntilZero(JobCounter const& counter)
+{
+	while (!counter.IsZero())
+	{
+		SleepMilliseconds(1);
+	}
+}
+
+//One worker: job A waits on a counter, and while it is suspended job B runs and waits on A.
+//Without fibers B would sit on top of A's stack, A could never return and both would wait forever.
+static bool TestNestedFiberWaitsFinish()
+{
+	JobSystem jobSystem;
+	jobSystem.EnableFibers();
+	jobSystem.CreateWorkerThreads(1);
+
+	JobCounter counterA;
+	JobCounter counterB;
+	JobCounter counterX;
+	std::atomic<int> numJobsRun(0);
+	jobSystem.PostLambdaJob([&]()
+	{
+		//B is more urgent, so the worker picks it up before X once A waits
+		jobSystem.PostLambdaJob([&]()
+		{
+			jobSystem.WaitFor(counterA);
+			numJobsRun.fetch_add(1);
+		}, &counterB, JOB_PRIORITY_FRAME_CRITICAL);
+		jobSystem.PostLambdaJob([&]()
+		{
+			numJobsRun.fetch_add(1);
+		}, &counterX);
+		jobSystem.WaitFor(counterX);
+		numJobsRun.fetch_add(1);
+	}, &counterA);
+
+	PollUntilZero(counterA);
+	PollUntilZero(counterB);
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	jobSystem.ShutDown();
+	return numJobsRun.load() == 3;
+}
+
+//Three levels of jobs waiting on the jobs they posted, more waits in flight than there are workers
+static bool TestDeepFiberWaitsFinish()
+{
+	static constexpr int NUM_ROOTS = 32;
+	static constexpr int NUM_CHILDREN = 8;
+	static constexpr int NUM_GRANDCHILDREN = 4;
+	JobSystem jobSystem;
+	jobSystem.EnableFibers();
+	jobSystem.CreateWorkerThreads(2);
+
+	JobCounter rootCounter;
+	std::atomic<int> numLeavesRun(0);
+	std::atomic<int> numLateWaits(0);
+	for (int rootIndex = 0; rootIndex < NUM_ROOTS; ++rootIndex)
+	{
+		jobSystem.PostLambdaJob([&]()
+		{
+			JobCounter childCounter;
+			for (int childIndex = 0; childIndex < NUM_CHILDREN; ++childIndex)
+			{
+				jobSystem.PostLambdaJob([&]()
+				{
+					JobCounter grandchildCounter;
+					for (int grandchildIndex = 0; grandchildIndex < NUM_GRANDCHILDREN; ++grandchildIndex)
+					{
+						jobSystem.PostLambdaJob([&]() { numLeavesRun.fetch_add(1); }, &grandchildCounter);
+					}
+					jobSystem.WaitFor(grandchildCounter);
+					numLateWaits.fetch_add(grandchildCounter.IsZero() ? 0 : 1);
+				}, &childCounter);
+			}
+			jobSystem.WaitFor(childCounter);
+			numLateWaits.fetch_add(childCounter.IsZero() ? 0 : 1);
+		}, &rootCounter);
+	}
+
+	PollUntilZero(rootCounter);
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	jobSystem.ShutDown();
+	return numLeavesRun.load() == NUM_ROOTS * NUM_CHILDREN * NUM_GRANDCHILDREN && numLateWaits.load() == 0;
+}
+
+//Every batch writes its bool partial at the same time, they used to share the words of a std::vector<bool>
+static bool TestParallelReduceBool()
+{
+	static constexpr int NUM_ELEMENTS = 1 << 20;
+	JobSystem jobSystem;
+	jobSystem.CreateWorkerThreads(4);
+	bool didPass = true;
+	for (int repeat = 0; repeat < 20 && didPass; ++repeat)
+	{
+		int const missingIndex = (repeat * 7919) % NUM_ELEMENTS;
+		bool areAllPresent = jobSystem.ParallelReduce(0, NUM_ELEMENTS, 64, true,
+			[missingIndex](int index) { return index != missingIndex; },
+			[](bool a, bool b) { return a && b; });
+		bool isAnyMissing = jobSystem.ParallelReduce(0, NUM_ELEMENTS, 64, false,
+			[missingIndex](int index) { return index == missingIndex; },
+			[](bool a, bool b) { return a || b; });
+		didPass = !areAllPresent && isAnyMissing;
+	}
+	jobSystem.ShutDown();
+	return didPass;
+}
+
+static JobSystemTest const s_tests[] =
+{
+	{ "frame_wait_skips_background_jobs", TestFrameWaitSkipsBackgroundJobs },
+	{ "background_wait_without_workers_finishes", TestBackgroundWaitWithoutWorkersFinishes },
+	{ "nested_fiber_waits_finish", TestNestedFiberWaitsFinish },
+	{ "deep_fiber_waits_finish", TestDeepFiberWaitsFinish },
+	{ "parallel_reduce_bool", TestParallelReduceBool },
+};
+static int const s_numTests = sizeof(s_tests) / sizeof(s_tests[0]);
+
+int main(int argc, char** argv)
+{
+	(void)argc;
+	(void)argv;
+	int numFailed = 0;
+	for (int testIndex = 0; testIndex < s_numTests; ++testIndex)
+	{
+		JobSystemTest const& test = s_tests[testIndex];
+		std::atomic<bool> isTestDone(false);
+		std::thread watchdog([&test, &isTestDone]()
+		{
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(TEST_TIMEOUT_SECONDS);
+			while (!isTestDone.load())
+			{
+				if (std::chrono::steady_clock::now() > deadline)
+				{
+					printf("FAIL %s (timed out after %d s)\n", test.m_name, TEST_TIMEOUT_SECONDS);
+					fflush(stdout);
+					std::_Exit(1);
+				}
+				SleepMilliseconds(10);
+			}
+		});
+		bool didPass = test.m_run();
+		isTestDone.store(true);
+		watchdog.join();
+		printf("%s %s\n", didPass ? "PASS" : "FAIL", test.m_name);
+		numFailed += didPass ? 0 : 1;
+	}
+	printf("%d of %d tests passed\n", s_numTests - numFailed, s_numTests);
+	return (numFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include <cstdlib>
+#include <new>
+
+//Replaces the global allocation functions so suites can check what a code path allocates. The count is per thread,
+//read it before and after the code being measured on the same thread.
+static thread_local size_t t_numHeapAllocations = 0;
+
+size_t GetThreadHeapAllocationCount()
+{
+	return t_numHeapAllocations;
+}
+
+void* operator new(size_t size)
+{
+	++t_numHeapAllocations;
+	void* block = malloc((size > 0) ? size : 1);
+	if (block == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete(void* block, size_t size) noexcept
+{
+	(void)size;
+	free(block);
+}
+
+void operator delete[](void* block, size_t size) noexcept
+{
+	(void)size;
+	free(block);
+}
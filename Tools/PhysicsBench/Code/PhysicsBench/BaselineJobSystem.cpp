@@ -0,0 +1,104 @@
+#include "PhysicsBench/BaselineJobSystem.hpp"
+#include <chrono>
+
+BaselineJob::BaselineJob()
+{
+	static int s_nextJobID = 1;
+	m_jobID = s_nextJobID++;
+}
+
+BaselineJobSystem::~BaselineJobSystem()
+{
+	ShutDown();
+}
+
+void BaselineJobSystem::CreateWorkerThreads(int numThreads)
+{
+	for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+	{
+		m_workerThreads.push_back(new std::thread(&BaselineJobSystem::WorkerThreadMain, this));
+	}
+}
+
+void BaselineJobSystem::WorkerThreadMain()
+{
+	while (!m_isQuitting)
+	{
+		m_jobsQueuedMutex.lock();
+		if (!m_jobsQueued.empty())
+		{
+			BaselineJob* jobAtFrontOfQueue = m_jobsQueued.front();
+			m_jobsQueued.pop_front();
+			m_jobsQueuedMutex.unlock();
+
+			m_jobsRunningMutex.lock();
+			m_jobsRunning.push_back(jobAtFrontOfQueue);
+			m_jobsRunningMutex.unlock();
+			jobAtFrontOfQueue->Execute();
+			BaselineJob* jobCompleted = PopJobFromRunningByIndex(jobAtFrontOfQueue->m_jobID);
+
+			m_jobsCompleteMutex.lock();
+			m_jobsCompleted.push_back(jobCompleted);
+			m_jobsCompleteMutex.unlock();
+		}
+		else
+		{
+			m_jobsQueuedMutex.unlock();
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+	}
+}
+
+void BaselineJobSystem::PostJob(BaselineJob* job)
+{
+	if (m_isQuitting)
+	{
+		return;
+	}
+	m_jobsQueuedMutex.lock();
+	m_jobsQueued.push_back(job);
+	m_jobsQueuedMutex.unlock();
+}
+
+void BaselineJobSystem::ClaimAndDeleteAllCompletedJobs()
+{
+	std::deque<BaselineJob*> claimedJobs;
+	m_jobsCompleteMutex.lock();
+	m_jobsCompleted.swap(claimedJobs);
+	m_jobsCompleteMutex.unlock();
+	for (auto iter = claimedJobs.begin(); iter != claimedJobs.end(); ++iter)
+	{
+		delete *iter;
+	}
+}
+
+BaselineJob* BaselineJobSystem::PopJobFromRunningByIndex(int id)
+{
+	std::lock_guard<std::mutex> lock(m_jobsRunningMutex);
+	for (auto iter = m_jobsRunning.begin(); iter != m_jobsRunning.end(); ++iter)
+	{
+		BaselineJob* job = *iter;
+		if (job->m_jobID == id)
+		{
+			m_jobsRunning.erase(iter);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void BaselineJobSystem::ShutDown()
+{
+	if (m_isQuitting)
+	{
+		return;
+	}
+	m_isQuitting = true;
+	for (int threadIndex = 0; threadIndex < (int)m_workerThreads.size(); ++threadIndex)
+	{
+		m_workerThreads[threadIndex]->join();
+		delete m_workerThreads[threadIndex];
+	}
+	m_workerThreads.clear();
+	ClaimAndDeleteAllCompletedJobs();
+}
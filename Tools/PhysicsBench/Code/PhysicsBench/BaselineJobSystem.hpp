@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BaselineJob
+{
+public:
+	BaselineJob();
+	virtual ~BaselineJob() {}
+	virtual void Execute() = 0;
+
+	int m_jobID = 0;
+};
+
+//The JobSystem as it was before the work-stealing scheduler: one mutex guarded deque that every worker
+//polls, sleeping 50us whenever it is empty, and a running list searched by id. Kept only so the
+//scheduler suite has the old numbers to compare against.
+class BaselineJobSystem
+{
+public:
+	BaselineJobSystem() = default;
+	~BaselineJobSystem();
+
+	void CreateWorkerThreads(int numThreads);
+	void PostJob(BaselineJob* job);
+	void ClaimAndDeleteAllCompletedJobs();
+	void ShutDown();
+
+private:
+	void WorkerThreadMain();
+	BaselineJob* PopJobFromRunningByIndex(int id);
+
+private:
+	std::deque<BaselineJob*>	m_jobsQueued;
+	std::deque<BaselineJob*>	m_jobsRunning;
+	std::deque<BaselineJob*>	m_jobsCompleted;
+	std::mutex					m_jobsQueuedMutex;
+	std::mutex					m_jobsRunningMutex;
+	std::mutex					m_jobsCompleteMutex;
+	std::atomic<bool>			m_isQuitting{ false };
+	std::vector<std::thread*>	m_workerThreads;
+};
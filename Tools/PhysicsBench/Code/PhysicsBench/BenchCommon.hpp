@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdio>
+#include <string>
+
+//Parsed from name=value arguments, see PrintUsage in Main_Console.cpp
+struct BenchOptions
+{
+	std::string m_suite = "scenes";
+	std::string m_scene;			//only this scene when set
+	std::string m_csvPath;			//stdout only when empty
+	int m_frames = 600;
+	int m_threads = 0;				//JobSystem workers, 0 steps without a job system
+	int m_count = 0;				//work items for the job and queue suites, 0 uses each suite's default
+};
+
+//Heap allocations made by the calling thread so far, counted by the bench's global operator new
+size_t GetThreadHeapAllocationCount();
+
+//Job and queue suites always need workers, threads=0 gives them one per hardware thread
+int GetBenchThreadCount(BenchOptions const& options);
+
+//Rows go to stdout and to the file, so a run in a terminal shows exactly what gets compared later
+class CSVWriter
+{
+public:
+	CSVWriter() = default;
+	CSVWriter(CSVWriter const& copy) = delete;
+	~CSVWriter();
+
+	CSVWriter& operator=(CSVWriter const& copy) = delete;
+
+	//An empty path writes to stdout only
+	bool Open(std::string const& path);
+	void WriteRow(std::string const& row);
+
+private:
+	FILE* m_file = nullptr;
+};
+
+typedef void (*BenchSuiteFunction)(BenchOptions const& options, CSVWriter& csv);
+
+//One row per scene: steps per second, per-phase milliseconds and peak memory from PhysicsStats2D
+void RunSceneSuite(BenchOptions const& options, CSVWriter& csv);
+//Tiny jobs through the work-stealing JobSystem and the old single queue scheduler: throughput and wake-up latency
+void RunSchedulerSuite(BenchOptions const& options, CSVWriter& csv);
+//ParallelFor and ParallelReduce over a float array at 1 to 16 workers, speedup against the calling thread alone
+void RunParallelSuite(BenchOptions const& options, CSVWriter& csv);
+//Lambda job submissions per second from the main thread and from inside workers, with heap allocations per submission
+void RunSubmitSuite(BenchOptions const& options, CSVWriter& csv);
+//Producers and consumers hammering SynchronizedNonblockingQueue and MPMCRingQueue, items per second
+void RunQueueSuite(BenchOptions const& options, CSVWriter& csv);
+//One producer thread and one consumer moving messages through SPSCRing and the general queues, messages per second
+void RunSPSCSuite(BenchOptions const& options, CSVWriter& csv);
+//The 10k body mixed_field scene with each broadphase, next to one pass of the old all-pairs test on the same bodies
+void RunBroadphaseSuite(BenchOptions const& options, CSVWriter& csv);
+//5000 persistent trigger and resting contacts with event callbacks, next to the old linear event list fed the same contacts
+void RunContactSuite(BenchOptions const& options, CSVWriter& csv);
+//100k bodies through ApplyEffectors and MoveRigidbodies, next to the old layout of one new'd object per body behind a pointer
+void RunIntegrateSuite(BenchOptions const& options, CSVWriter& csv);
+//100k rays through the mixed_field scene one Raycast at a time and with RaycastBatch, next to a loop over every collider
+void RunRaycastSuite(BenchOptions const& options, CSVWriter& csv);
+//16 bullets spawned and destroyed every other step next to 1k, 10k and 100k sleeping discs, the cost per bullet should not
+//grow with them
+void RunSpawnSuite(BenchOptions const& options, CSVWriter& csv);
@@ -0,0 +1,150 @@
+#include "PhysicsBench/BenchScenes.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Physics/DiscCollider2D.hpp"
+#include "Engine/Physics/Physics2D.hpp"
+#include "Engine/Physics/PolygonCollider2D.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+#include <vector>
+
+BenchScene const g_benchScenes[] =
+{
+	{ "disc_rain", BuildDiscRainScene },
+	{ "polygon_pyramid", BuildPolygonPyramidScene },
+	{ "static_field", BuildStaticFieldScene },
+	{ "trigger_field", BuildTriggerFieldScene },
+	{ "mixed_field", BuildMixedFieldScene },
+};
+int const g_numBenchScenes = sizeof(g_benchScenes) / sizeof(g_benchScenes[0]);
+
+static std::vector<Vec2> GetBoxPoints(float halfWidth, float halfHeight)
+{
+	std::vector<Vec2> points;
+	points.push_back(Vec2(-halfWidth, -halfHeight));
+	points.push_back(Vec2(halfWidth, -halfHeight));
+	points.push_back(Vec2(halfWidth, halfHeight));
+	points.push_back(Vec2(-halfWidth, halfHeight));
+	return points;
+}
+
+//The default material is perfectly elastic and frictionless, piles of it never come to rest
+static Rigidbody2D* AddBody(Physics2D& physics, Vec2 const& position, Collider2D* collider, eSimulationMode mode)
+{
+	collider->m_physicsMaterial.restitution = 0.1f;
+	collider->m_physicsMaterial.friction = 0.6f;
+	Rigidbody2D* rigidbody = physics.CreateRigidbody();
+	rigidbody->SetPosition(position);
+	rigidbody->TakeCollider(collider);
+	rigidbody->SetSimulationMode(mode);
+	return rigidbody;
+}
+
+//Top surface at y = 0
+static void AddFloor(Physics2D& physics, float halfWidth)
+{
+	AddBody(physics, Vec2(0.f, -1.f), physics.CreatePolygonCollider(Vec2::ZERO, GetBoxPoints(halfWidth, 1.f)), STATIC);
+}
+
+int BuildDiscRainScene(Physics2D& physics)
+{
+	constexpr int NUM_DISCS = 2000;
+	constexpr int NUM_COLUMNS = 100;
+	RandomNumberGenerator rng;
+	rng.Reset(7);
+	AddFloor(physics, 80.f);
+	for (int discIndex = 0; discIndex < NUM_DISCS; ++discIndex)
+	{
+		//jittered rows one disc apart, so nothing starts out overlapping
+		float jitter = rng.RollRandomFloatInRange(-0.3f, 0.3f);
+		Vec2 position((float)(discIndex % NUM_COLUMNS) * 1.5f - 74.f + jitter, 2.f + (float)(discIndex / NUM_COLUMNS));
+		AddBody(physics, position, physics.CreateDiscCollider(Vec2::ZERO, 0.4f), DYNAMIC);
+	}
+	return NUM_DISCS + 1;
+}
+
+int BuildPolygonPyramidScene(Physics2D& physics)
+{
+	constexpr int NUM_ROWS = 30;
+	AddFloor(physics, 40.f);
+	int numBodies = 1;
+	std::vector<Vec2> boxPoints = GetBoxPoints(0.5f, 0.5f);
+	for (int rowIndex = 0; rowIndex < NUM_ROWS; ++rowIndex)
+	{
+		int numBoxes = NUM_ROWS - rowIndex;
+		for (int boxIndex = 0; boxIndex < numBoxes; ++boxIndex)
+		{
+			Vec2 position(((float)boxIndex - (float)numBoxes * 0.5f) * 1.05f, 0.5f + (float)rowIndex);
+			AddBody(physics, position, physics.CreatePolygonCollider(Vec2::ZERO, boxPoints), DYNAMIC);
+			++numBodies;
+		}
+	}
+	return numBodies;
+}
+
+int BuildStaticFieldScene(Physics2D& physics)
+{
+	constexpr int NUM_COLUMNS = 100;
+	constexpr int NUM_ROWS = 50;
+	constexpr int NUM_MOVERS = 50;
+	for (int staticIndex = 0; staticIndex < NUM_COLUMNS * NUM_ROWS; ++staticIndex)
+	{
+		Vec2 position((float)(staticIndex % NUM_COLUMNS) * 2.f, (float)(staticIndex / NUM_COLUMNS) * 2.f);
+		AddBody(physics, position, physics.CreateDiscCollider(Vec2::ZERO, 0.5f), STATIC);
+	}
+	for (int moverIndex = 0; moverIndex < NUM_MOVERS; ++moverIndex)
+	{
+		//just off a column of static discs, so the movers rattle down through the grid instead of falling between it
+		Vec2 position(0.3f + (float)moverIndex * 4.f, (float)NUM_ROWS * 2.f + 1.f);
+		AddBody(physics, position, physics.CreateDiscCollider(Vec2::ZERO, 0.3f), DYNAMIC);
+	}
+	return NUM_COLUMNS * NUM_ROWS + NUM_MOVERS;
+}
+
+int BuildTriggerFieldScene(Physics2D& physics)
+{
+	constexpr int NUM_COLUMNS = 50;
+	constexpr int NUM_TRIGGERS = 1000;
+	constexpr int NUM_MOVERS = 500;
+	RandomNumberGenerator rng;
+	rng.Reset(11);
+	AddFloor(physics, 80.f);
+	for (int triggerIndex = 0; triggerIndex < NUM_TRIGGERS; ++triggerIndex)
+	{
+		Collider2D* trigger = physics.CreateDiscCollider(Vec2::ZERO, 1.5f);
+		trigger->m_isTrigger = true;
+		Vec2 position((float)(triggerIndex % NUM_COLUMNS) * 3.f - 75.f, (float)(triggerIndex / NUM_COLUMNS) * 3.f + 2.f);
+		AddBody(physics, position, trigger, STATIC);
+	}
+	for (int moverIndex = 0; moverIndex < NUM_MOVERS; ++moverIndex)
+	{
+		float jitter = rng.RollRandomFloatInRange(-0.5f, 0.5f);
+		Vec2 position((float)(moverIndex % NUM_COLUMNS) * 3.f - 75.f + jitter, 70.f + (float)(moverIndex / NUM_COLUMNS) * 1.5f);
+		AddBody(physics, position, physics.CreateDiscCollider(Vec2::ZERO, 0.4f), DYNAMIC);
+	}
+	return NUM_TRIGGERS + NUM_MOVERS + 1;
+}
+
+int BuildMixedFieldScene(Physics2D& physics)
+{
+	constexpr int NUM_COLUMNS = 200;
+	constexpr int NUM_BODIES = 10000;
+	AddFloor(physics, 160.f);
+	std::vector<Vec2> boxPoints = GetBoxPoints(0.4f, 0.4f);
+	for (int bodyIndex = 0; bodyIndex < NUM_BODIES; ++bodyIndex)
+	{
+		int column = bodyIndex % NUM_COLUMNS;
+		int row = bodyIndex / NUM_COLUMNS;
+		Vec2 position((float)column * 1.5f - 150.f, 1.f + (float)row * 1.5f);
+		Collider2D* collider = nullptr;
+		if (((column + row) & 1) == 0)
+		{
+			collider = physics.CreateDiscCollider(Vec2::ZERO, 0.5f);
+		}
+		else
+		{
+			collider = physics.CreatePolygonCollider(Vec2::ZERO, boxPoints);
+		}
+		AddBody(physics, position, collider, DYNAMIC);
+	}
+	return NUM_BODIES + 1;
+}
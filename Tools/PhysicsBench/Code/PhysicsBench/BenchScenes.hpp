@@ -0,0 +1,25 @@
+#pragma once
+class Physics2D;
+
+//Fills an empty Physics2D the same way on every run and returns the number of bodies it created
+typedef int (*BenchSceneBuilder)(Physics2D& physics);
+
+struct BenchScene
+{
+	char const* m_name = "";
+	BenchSceneBuilder m_build = nullptr;
+};
+
+//Discs dropped in a column onto a wide floor, mostly resting contacts by the end
+int BuildDiscRainScene(Physics2D& physics);
+//Boxes stacked into a pyramid, deep stacks stress the solver
+int BuildPolygonPyramidScene(Physics2D& physics);
+//A large grid of static discs with a few discs falling through it, broadphase work with little solving
+int BuildStaticFieldScene(Physics2D& physics);
+//10k discs and boxes dropped from a wide, low grid onto a floor, the broadphase scene
+int BuildMixedFieldScene(Physics2D& physics);
+//Static trigger discs overlapped by falling bodies, event bookkeeping without contact resolution
+int BuildTriggerFieldScene(Physics2D& physics);
+
+extern BenchScene const g_benchScenes[];
+extern int const g_numBenchScenes;
@@ -0,0 +1,52 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "PhysicsBench/BenchScenes.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Physics/Physics2D.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+
+static char const* const s_broadphaseNames[NUM_BROADPHASE_TYPES] = { "aabb_tree", "sweep_and_prune" };
+
+//The narrow phase loop DetectCollisions ran before there was a broadphase: every pair with a moving body is tested.
+//Returns milliseconds for one pass over the scene as it is now.
+static double TimeAllPairsPass(Physics2D const& physics, int& outNumTouching)
+{
+	std::vector<Collider2D*> const& colliders = physics.m_colliders;
+	outNumTouching = 0;
+	double startTime = GetCurrentTimeSeconds();
+	for (int colliderIndex = 0; colliderIndex < (int)colliders.size(); ++colliderIndex)
+	{
+		Collider2D* me = colliders[colliderIndex];
+		for (int colliderIndexJ = colliderIndex + 1; colliderIndexJ < (int)colliders.size(); ++colliderIndexJ)
+		{
+			Collider2D* them = colliders[colliderIndexJ];
+			if ((me->m_rigidbody->GetSimulationMode() != STATIC || them->m_rigidbody->GetSimulationMode() != STATIC) && me->Intersects(them))
+			{
+				++outNumTouching;
+			}
+		}
+	}
+	return (GetCurrentTimeSeconds() - startTime) * 1000.0;
+}
+
+void RunBroadphaseSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	csv.WriteRow("broadphase,bodies,frames," + PhysicsStats2D::GetCSVHeader() + ",all_pairs_ms,all_pairs_touching");
+	for (int broadphaseIndex = 0; broadphaseIndex < NUM_BROADPHASE_TYPES; ++broadphaseIndex)
+	{
+		Physics2D physics((eBroadphaseType)broadphaseIndex);
+		physics.SetSceneGravity(Vec2(0.f, -9.8f));
+		int numBodies = BuildMixedFieldScene(physics);
+		physics.Step();
+		physics.ResetStats();
+		for (int frameIndex = 0; frameIndex < options.m_frames; ++frameIndex)
+		{
+			physics.Step();
+		}
+		//the old cost of finding the same contacts, measured on the final positions
+		int numTouching = 0;
+		double allPairsMilliseconds = TimeAllPairsPass(physics, numTouching);
+		csv.WriteRow(Stringf("%s,%d,%d,", s_broadphaseNames[broadphaseIndex], numBodies, options.m_frames) + physics.GetStats().GetCSVRow()
+			+ Stringf(",%.1f,%d", allPairsMilliseconds, numTouching));
+	}
+}
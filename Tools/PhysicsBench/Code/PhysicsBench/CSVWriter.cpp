@@ -0,0 +1,35 @@
+#include "PhysicsBench/BenchCommon.hpp"
+
+CSVWriter::~CSVWriter()
+{
+	if (m_file != nullptr)
+	{
+		fclose(m_file);
+		m_file = nullptr;
+	}
+}
+
+bool CSVWriter::Open(std::string const& path)
+{
+	if (path.empty())
+	{
+		return true;
+	}
+#if defined( _WIN32 )
+	fopen_s(&m_file, path.c_str(), "w");
+#else
+	m_file = fopen(path.c_str(), "w");
+#endif
+	return m_file != nullptr;
+}
+
+void CSVWriter::WriteRow(std::string const& row)
+{
+	printf("%s\n", row.c_str());
+	fflush(stdout);
+	if (m_file != nullptr)
+	{
+		fprintf(m_file, "%s\n", row.c_str());
+		fflush(m_file);
+	}
+}
@@ -0,0 +1,187 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Physics/Physics2D.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+#include <vector>
+
+static constexpr int NUM_CONTACTS = 5000;
+static constexpr int NUM_COLUMNS = 100;
+static constexpr int NUM_SETTLE_STEPS = 10;
+
+struct ContactEventCounter
+{
+	void OnBegin(Collision2D const& collision) { (void)collision; ++m_numBegins; }
+	void OnStay(Collision2D const& collision) { (void)collision; ++m_numStays; }
+	void OnEnd(Collision2D const& collision) { (void)collision; ++m_numEnds; }
+
+	int m_numBegins = 0;
+	int m_numStays = 0;
+	int m_numEnds = 0;
+};
+
+//The bookkeeping DetectCollisions did before the contact cache: a linear search of the last step's list for every
+//touching pair, then a sweep that erases the stale ones from the middle. Fed the same contacts Physics2D found.
+class LinearEventList
+{
+public:
+	void Update(Physics2D const& physics)
+	{
+		AddOrRefresh(physics.m_beginContacts, physics.m_frameId);
+		AddOrRefresh(physics.m_stayContacts, physics.m_frameId);
+		for (int i = 0; i < (int)m_collisionsForEvents.size(); ++i)
+		{
+			if (m_collisionsForEvents[i].m_frameId < physics.m_frameId)
+			{
+				m_collisionsForEvents.erase(m_collisionsForEvents.begin() + i);
+			}
+		}
+	}
+
+private:
+	void AddOrRefresh(std::vector<Collision2D> const& collisions, int frameId)
+	{
+		for (Collision2D const& collision : collisions)
+		{
+			bool wasInLastFrame = false;
+			for (int i = 0; i < (int)m_collisionsForEvents.size(); ++i)
+			{
+				if (m_collisionsForEvents[i].m_colliderID == collision.m_colliderID)
+				{
+					m_collisionsForEvents[i].m_frameId = frameId;
+					wasInLastFrame = true;
+					break;
+				}
+			}
+			if (!wasInLastFrame)
+			{
+				m_collisionsForEvents.push_back(collision);
+				m_collisionsForEvents.back().m_frameId = frameId;
+			}
+		}
+	}
+
+	std::vector<Collision2D> m_collisionsForEvents;
+};
+
+static Rigidbody2D* AddCountedBody(Physics2D& physics, ContactEventCounter& counter, Vec2 const& position, Collider2D* collider, eSimulationMode mode)
+{
+	Rigidbody2D* rigidbody = physics.CreateRigidbody();
+	rigidbody->SetPosition(position);
+	rigidbody->TakeCollider(collider);
+	rigidbody->SetSimulationMode(mode);
+	rigidbody->OnOverlapBegin.subscribe_method(&counter, &ContactEventCounter::OnBegin);
+	rigidbody->OnOverlapStay.subscribe_method(&counter, &ContactEventCounter::OnStay);
+	rigidbody->OnOverlapEnd.subscribe_method(&counter, &ContactEventCounter::OnEnd);
+	rigidbody->OnTriggerBegin.subscribe_method(&counter, &ContactEventCounter::OnBegin);
+	rigidbody->OnTriggerStay.subscribe_method(&counter, &ContactEventCounter::OnStay);
+	rigidbody->OnTriggerEnd.subscribe_method(&counter, &ContactEventCounter::OnEnd);
+	return rigidbody;
+}
+
+//Overlapping pairs of kinematic trigger discs, returns the bodies that get moved away at the end
+static std::vector<Rigidbody2D*> BuildTriggerPairs(Physics2D& physics, ContactEventCounter& counter)
+{
+	std::vector<Rigidbody2D*> bodiesToRelease;
+	for (int pairIndex = 0; pairIndex < NUM_CONTACTS; ++pairIndex)
+	{
+		Vec2 position((float)(pairIndex % NUM_COLUMNS) * 10.f, (float)(pairIndex / NUM_COLUMNS) * 10.f);
+		for (int bodyIndex = 0; bodyIndex < 2; ++bodyIndex)
+		{
+			Collider2D* trigger = physics.CreateDiscCollider(Vec2::ZERO, 1.f);
+			trigger->m_isTrigger = true;
+			Rigidbody2D* rigidbody = AddCountedBody(physics, counter, position + Vec2((float)bodyIndex, 0.f), trigger, KINEMATIC);
+			if (bodyIndex == 0)
+			{
+				bodiesToRelease.push_back(rigidbody);
+			}
+		}
+	}
+	return bodiesToRelease;
+}
+
+//Discs resting apart from each other on one long floor, sleeping is turned off so every contact stays active
+static std::vector<Rigidbody2D*> BuildRestingDiscs(Physics2D& physics, ContactEventCounter& counter)
+{
+	std::vector<Rigidbody2D*> bodiesToRelease;
+	float floorHalfWidth = (float)NUM_CONTACTS + 2.f;
+	std::vector<Vec2> floorPoints;
+	floorPoints.push_back(Vec2(-floorHalfWidth, -1.f));
+	floorPoints.push_back(Vec2(floorHalfWidth, -1.f));
+	floorPoints.push_back(Vec2(floorHalfWidth, 1.f));
+	floorPoints.push_back(Vec2(-floorHalfWidth, 1.f));
+	Collider2D* floor = physics.CreatePolygonCollider(Vec2::ZERO, floorPoints);
+	AddCountedBody(physics, counter, Vec2(0.f, -1.f), floor, STATIC);
+	for (int discIndex = 0; discIndex < NUM_CONTACTS; ++discIndex)
+	{
+		Collider2D* disc = physics.CreateDiscCollider(Vec2::ZERO, 0.5f);
+		disc->m_physicsMaterial.restitution = 0.f;
+		disc->m_physicsMaterial.friction = 0.6f;
+		Vec2 position((float)discIndex * 2.f - (float)NUM_CONTACTS, 0.49f);
+		bodiesToRelease.push_back(AddCountedBody(physics, counter, position, disc, DYNAMIC));
+	}
+	physics.SetSleepEnabled(false);
+	return bodiesToRelease;
+}
+
+typedef std::vector<Rigidbody2D*> (*ContactSceneBuilder)(Physics2D& physics, ContactEventCounter& counter);
+
+struct ContactScene
+{
+	char const* m_name;
+	ContactSceneBuilder m_build;
+};
+
+static ContactScene const s_contactScenes[] =
+{
+	{ "trigger_pairs", BuildTriggerPairs },
+	{ "resting_discs", BuildRestingDiscs },
+};
+
+void RunContactSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	csv.WriteRow("scene,contacts,frames," + PhysicsStats2D::GetCSVHeader() + ",begin_callbacks,stay_callbacks,end_callbacks,release_ms,linear_list_ms,linear_list_release_ms");
+	int numScenes = sizeof(s_contactScenes) / sizeof(s_contactScenes[0]);
+	for (int sceneIndex = 0; sceneIndex < numScenes; ++sceneIndex)
+	{
+		ContactScene const& scene = s_contactScenes[sceneIndex];
+		Physics2D physics(BROADPHASE_AABB_TREE);
+		physics.SetSceneGravity(Vec2(0.f, -9.8f));
+		ContactEventCounter counter;
+		LinearEventList linearList;
+		std::vector<Rigidbody2D*> bodiesToRelease = scene.m_build(physics, counter);
+		for (int stepIndex = 0; stepIndex < NUM_SETTLE_STEPS; ++stepIndex)
+		{
+			physics.Step();
+			linearList.Update(physics);
+		}
+		int numContacts = (int)physics.m_stayContacts.size();
+
+		physics.ResetStats();
+		double linearListSeconds = 0.0;
+		for (int frameIndex = 0; frameIndex < options.m_frames; ++frameIndex)
+		{
+			physics.Step();
+			double startTime = GetCurrentTimeSeconds();
+			linearList.Update(physics);
+			linearListSeconds += GetCurrentTimeSeconds() - startTime;
+		}
+		PhysicsStats2D stats = physics.GetStats();
+
+		//pull every pair apart, one step then ends all of the contacts at once
+		for (Rigidbody2D* rigidbody : bodiesToRelease)
+		{
+			rigidbody->SetPosition(rigidbody->GetPosition() + Vec2(0.f, 5.f));
+		}
+		double releaseStartTime = GetCurrentTimeSeconds();
+		physics.Step();
+		double releaseSeconds = GetCurrentTimeSeconds() - releaseStartTime;
+		releaseStartTime = GetCurrentTimeSeconds();
+		linearList.Update(physics);
+		double linearListReleaseSeconds = GetCurrentTimeSeconds() - releaseStartTime;
+
+		csv.WriteRow(Stringf("%s,%d,%d,", scene.m_name, numContacts, options.m_frames) + stats.GetCSVRow()
+			+ Stringf(",%d,%d,%d,%.3f,%.3f,%.3f", counter.m_numBegins, counter.m_numStays, counter.m_numEnds, releaseSeconds * 1000.0,
+				linearListSeconds * 1000.0 / (double)options.m_frames, linearListReleaseSeconds * 1000.0));
+	}
+}
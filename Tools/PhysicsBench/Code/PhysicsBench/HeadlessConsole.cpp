@@ -0,0 +1,13 @@
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <cstdio>
+
+//DevConsole.cpp and EngineCommon.cpp pull in the renderer, so the bench defines the console itself and
+//sends engine messages to stderr, which keeps stdout plain CSV
+DevConsole* g_theConsole = new DevConsole();
+
+void DevConsole::PrintString(const Rgba8& textColor, std::string devConsolePrintString)
+{
+	UNUSED(textColor);
+	fprintf(stderr, "%s\n", devConsolePrintString.c_str());
+}
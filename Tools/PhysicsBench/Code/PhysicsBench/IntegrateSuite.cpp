@@ -0,0 +1,190 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "Engine/Core/Delegate.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/Physics/Physics2D.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+#include <vector>
+
+static constexpr int DEFAULT_NUM_BODIES = 100000;
+static constexpr float STEP_SECONDS = 1.f / 120.f;
+
+//The fields of Rigidbody2D before its state moved into RigidbodyStorage2D, in the same order, so every body is
+//as large and as far from its neighbours as the old objects were
+struct LegacyRigidbody
+{
+	Delegate<Collision2D const&> OnOverlapBegin;
+	Delegate<Collision2D const&> OnOverlapStay;
+	Delegate<Collision2D const&> OnOverlapEnd;
+	Delegate<Collision2D const&> OnTriggerBegin;
+	Delegate<Collision2D const&> OnTriggerStay;
+	Delegate<Collision2D const&> OnTriggerEnd;
+
+	Physics2D* m_system = nullptr;
+	Collider2D* m_collider = nullptr;
+	Vec2 m_worldPosition = Vec2::ZERO;
+	bool m_isDestroyed = false;
+	bool m_physicsEnabled = true;
+	float m_mass = 1.0f;
+	float m_drag = 0.f;
+	Vec2 m_velocity;
+	Vec2 m_nonGravityForces;
+	Vec2 m_startPosition;
+	float m_RotationInRadians = 0.f;
+	float m_angularVelocity = 0.f;
+	float m_frameTorque = 0.f;
+	float m_moment = 0.f;
+	unsigned int m_layer = 0;
+	eSimulationMode m_mode = DYNAMIC;
+	void* m_userData = nullptr;
+	eUserType m_userType = USERTYPE_GAMEOJECT;
+};
+
+//ApplyEffectors and MoveRigidbodies as they were, one new'd body per pointer in creation order
+static void StepLegacyBodies(std::vector<LegacyRigidbody*> const& rigidbodies, Vec2 const& gravity, float deltaSeconds)
+{
+	Vec2 frameGravityAcceleration = gravity * deltaSeconds;
+	for (int rigidbodyIndex = 0; rigidbodyIndex < (int)rigidbodies.size(); ++rigidbodyIndex)
+	{
+		LegacyRigidbody* rigidbody = rigidbodies[rigidbodyIndex];
+		rigidbody->m_startPosition = rigidbody->m_worldPosition;
+		if (rigidbody->m_physicsEnabled)
+		{
+			if (rigidbody->m_mode == DYNAMIC)
+			{
+				rigidbody->m_nonGravityForces = -rigidbody->m_velocity * rigidbody->m_drag;
+				Vec2 frameOtherAcceleration = (rigidbody->m_nonGravityForces / rigidbody->m_mass) * deltaSeconds;
+				rigidbody->m_velocity = rigidbody->m_velocity + frameGravityAcceleration + frameOtherAcceleration;
+			}
+			else if (rigidbody->m_mode == STATIC)
+			{
+				rigidbody->m_velocity = Vec2::ZERO;
+			}
+		}
+		else
+		{
+			rigidbody->m_velocity = Vec2::ZERO;
+		}
+	}
+	for (int rigidbodyIndex = 0; rigidbodyIndex < (int)rigidbodies.size(); ++rigidbodyIndex)
+	{
+		LegacyRigidbody* rigidbody = rigidbodies[rigidbodyIndex];
+		if (rigidbody->m_mode == STATIC || !rigidbody->m_physicsEnabled)
+		{
+			continue;
+		}
+		rigidbody->m_worldPosition = rigidbody->m_worldPosition + rigidbody->m_velocity * deltaSeconds;
+		rigidbody->m_RotationInRadians = rigidbody->m_RotationInRadians + rigidbody->m_angularVelocity * deltaSeconds;
+		while (rigidbody->m_RotationInRadians < 0.f)
+		{
+			rigidbody->m_RotationInRadians += 2 * 3.14159f;
+		}
+		while (rigidbody->m_RotationInRadians > 2 * 3.14159f)
+		{
+			rigidbody->m_RotationInRadians -= 2 * 3.14159f;
+		}
+	}
+}
+
+//Both layouts get the same bodies: a scatter of positions and velocities, some drag and spin,
+//every 10th body static and every 7th kinematic
+struct IntegrateBodySetup
+{
+	Vec2 m_position;
+	Vec2 m_velocity;
+	eSimulationMode m_mode = DYNAMIC;
+};
+
+static std::vector<IntegrateBodySetup> MakeBodySetups(int numBodies)
+{
+	RandomNumberGenerator rng;
+	rng.Reset(3);
+	std::vector<IntegrateBodySetup> setups(numBodies);
+	for (int bodyIndex = 0; bodyIndex < numBodies; ++bodyIndex)
+	{
+		IntegrateBodySetup& setup = setups[bodyIndex];
+		setup.m_position = Vec2(rng.RollRandomFloatInRange(0.f, 1000.f), rng.RollRandomFloatInRange(0.f, 1000.f));
+		setup.m_velocity = Vec2(rng.RollRandomFloatInRange(-10.f, 10.f), rng.RollRandomFloatInRange(-10.f, 10.f));
+		if (bodyIndex % 10 == 0)
+		{
+			setup.m_mode = STATIC;
+		}
+		else if (bodyIndex % 7 == 0)
+		{
+			setup.m_mode = KINEMATIC;
+		}
+	}
+	return setups;
+}
+
+static void WriteIntegrateRow(CSVWriter& csv, char const* layout, int numBodies, int numSteps, double seconds, double checksum)
+{
+	double bodyStepsPerSecond = (double)numBodies * (double)numSteps / seconds;
+	csv.WriteRow(Stringf("%s,%d,%d,%.4f,%.2f,%.3f", layout, numBodies, numSteps, seconds * 1000.0 / (double)numSteps,
+		bodyStepsPerSecond / 1000000.0, checksum));
+}
+
+void RunIntegrateSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	int numBodies = (options.m_count > 0) ? options.m_count : DEFAULT_NUM_BODIES;
+	int numSteps = options.m_frames;
+	Vec2 const gravity(0.f, -9.8f);
+	std::vector<IntegrateBodySetup> setups = MakeBodySetups(numBodies);
+	csv.WriteRow("layout,bodies,steps,ms_per_step,mbody_steps_per_s,checksum");
+
+	//no colliders, so both sides time only ApplyEffectors and MoveRigidbodies
+	std::vector<LegacyRigidbody*> legacyBodies;
+	legacyBodies.reserve(numBodies);
+	for (IntegrateBodySetup const& setup : setups)
+	{
+		LegacyRigidbody* rigidbody = new LegacyRigidbody();
+		rigidbody->m_worldPosition = setup.m_position;
+		rigidbody->m_velocity = setup.m_velocity;
+		rigidbody->m_drag = 0.1f;
+		rigidbody->m_angularVelocity = 1.f;
+		rigidbody->m_mode = setup.m_mode;
+		legacyBodies.push_back(rigidbody);
+	}
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int stepIndex = 0; stepIndex < numSteps; ++stepIndex)
+	{
+		StepLegacyBodies(legacyBodies, gravity, STEP_SECONDS);
+	}
+	double legacySeconds = GetCurrentTimeSeconds() - startSeconds;
+	double legacyChecksum = 0.0;
+	for (LegacyRigidbody* rigidbody : legacyBodies)
+	{
+		legacyChecksum += (double)rigidbody->m_worldPosition.y;
+		delete rigidbody;
+	}
+	WriteIntegrateRow(csv, "pointer_objects", numBodies, numSteps, legacySeconds, legacyChecksum);
+
+	Physics2D physics(BROADPHASE_AABB_TREE, nullptr);
+	physics.SetSceneGravity(gravity);
+	std::vector<Rigidbody2D*> rigidbodies;
+	rigidbodies.reserve(numBodies);
+	for (IntegrateBodySetup const& setup : setups)
+	{
+		Rigidbody2D* rigidbody = physics.CreateRigidbody();
+		rigidbody->SetPosition(setup.m_position);
+		rigidbody->SetVelocity(setup.m_velocity);
+		rigidbody->ChangeDrag(0.1f);
+		rigidbody->SetAngularVelocity(1.f);
+		rigidbody->SetSimulationMode(setup.m_mode);
+		rigidbodies.push_back(rigidbody);
+	}
+	startSeconds = GetCurrentTimeSeconds();
+	for (int stepIndex = 0; stepIndex < numSteps; ++stepIndex)
+	{
+		physics.ApplyEffectors(STEP_SECONDS);
+		physics.MoveRigidbodies(STEP_SECONDS);
+	}
+	double storageSeconds = GetCurrentTimeSeconds() - startSeconds;
+	double storageChecksum = 0.0;
+	for (Rigidbody2D* rigidbody : rigidbodies)
+	{
+		storageChecksum += (double)rigidbody->GetPosition().y;
+	}
+	WriteIntegrateRow(csv, "body_storage", numBodies, numSteps, storageSeconds, storageChecksum);
+}
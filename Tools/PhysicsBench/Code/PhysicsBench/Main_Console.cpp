@@ -0,0 +1,122 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+struct BenchSuite
+{
+	char const* m_name;
+	BenchSuiteFunction m_run;
+};
+
+static BenchSuite const s_suites[] =
+{
+	{ "scenes", RunSceneSuite },
+	{ "scheduler", RunSchedulerSuite },
+	{ "parallel", RunParallelSuite },
+	{ "submit", RunSubmitSuite },
+	{ "queues", RunQueueSuite },
+	{ "spsc", RunSPSCSuite },
+	{ "broadphase", RunBroadphaseSuite },
+	{ "contacts", RunContactSuite },
+	{ "integrate", RunIntegrateSuite },
+	{ "raycasts", RunRaycastSuite },
+	{ "spawns", RunSpawnSuite },
+};
+static int const s_numSuites = sizeof(s_suites) / sizeof(s_suites[0]);
+
+static void PrintUsage()
+{
+	fprintf(stderr, "usage: PhysicsBench [suite=<name>|all] [scene=<name>] [frames=<n>] [threads=<n>] [count=<n>] [csv=<path>]\n");
+	fprintf(stderr, "suites:");
+	for (int suiteIndex = 0; suiteIndex < s_numSuites; ++suiteIndex)
+	{
+		fprintf(stderr, " %s", s_suites[suiteIndex].m_name);
+	}
+	fprintf(stderr, "\n");
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& outOptions)
+{
+	for (int argIndex = 1; argIndex < argc; ++argIndex)
+	{
+		char const* separator = strchr(argv[argIndex], '=');
+		if (separator == nullptr)
+		{
+			return false;
+		}
+		std::string name(argv[argIndex], separator - argv[argIndex]);
+		char const* value = separator + 1;
+		if (name == "suite")
+		{
+			outOptions.m_suite = value;
+		}
+		else if (name == "scene")
+		{
+			outOptions.m_scene = value;
+		}
+		else if (name == "csv")
+		{
+			outOptions.m_csvPath = value;
+		}
+		else if (name == "frames")
+		{
+			outOptions.m_frames = atoi(value);
+		}
+		else if (name == "threads")
+		{
+			outOptions.m_threads = atoi(value);
+		}
+		else if (name == "count")
+		{
+			outOptions.m_count = atoi(value);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return outOptions.m_frames > 0 && outOptions.m_threads >= 0 && outOptions.m_count >= 0;
+}
+
+int GetBenchThreadCount(BenchOptions const& options)
+{
+	if (options.m_threads > 0)
+	{
+		return options.m_threads;
+	}
+	int numHardwareThreads = (int)std::thread::hardware_concurrency();
+	return (numHardwareThreads > 0) ? numHardwareThreads : 1;
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+	CSVWriter csv;
+	if (!csv.Open(options.m_csvPath))
+	{
+		fprintf(stderr, "could not open %s\n", options.m_csvPath.c_str());
+		return 1;
+	}
+
+	int numSuitesRun = 0;
+	for (int suiteIndex = 0; suiteIndex < s_numSuites; ++suiteIndex)
+	{
+		if (options.m_suite == "all" || options.m_suite == s_suites[suiteIndex].m_name)
+		{
+			s_suites[suiteIndex].m_run(options, csv);
+			++numSuitesRun;
+		}
+	}
+	if (numSuitesRun == 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <cmath>
+#include <vector>
+
+static constexpr int DEFAULT_NUM_ELEMENTS = 4000000;
+static constexpr int GRAIN_SIZE = 16384;
+static constexpr int NUM_REPEATS = 10;		//best of, the first run also faults the pages in
+static int const s_threadCounts[] = { 1, 2, 4, 8, 16 };
+
+struct ParallelTimes
+{
+	double m_forSeconds = 0.0;
+	double m_reduceSeconds = 0.0;
+	double m_checksum = 0.0;
+};
+
+//Without workers the same batches all run on the calling thread, which is the reference for the speedups
+static ParallelTimes TimeParallelLoops(JobSystem& jobSystem, std::vector<float> const& inputs, std::vector<float>& outputs)
+{
+	int numElements = (int)inputs.size();
+	auto transform = [&inputs, &outputs](int index)
+	{
+		outputs[index] = sqrtf(inputs[index]) * 0.5f + sinf(inputs[index]);
+	};
+	auto map = [&outputs](int index) { return (double)outputs[index] * (double)outputs[index]; };
+	auto reduce = [](double a, double b) { return a + b; };
+
+	ParallelTimes times;
+	times.m_forSeconds = 1e30;
+	times.m_reduceSeconds = 1e30;
+	for (int repeatIndex = 0; repeatIndex < NUM_REPEATS; ++repeatIndex)
+	{
+		double startTime = GetCurrentTimeSeconds();
+		jobSystem.ParallelFor(0, numElements, GRAIN_SIZE, transform);
+		double forTime = GetCurrentTimeSeconds();
+		double sum = jobSystem.ParallelReduce(0, numElements, GRAIN_SIZE, 0.0, map, reduce);
+		double reduceTime = GetCurrentTimeSeconds();
+		times.m_forSeconds = std::min(times.m_forSeconds, forTime - startTime);
+		times.m_reduceSeconds = std::min(times.m_reduceSeconds, reduceTime - forTime);
+		times.m_checksum = sum;
+	}
+	return times;
+}
+
+static void WriteParallelRow(CSVWriter& csv, int numThreads, int numElements, ParallelTimes const& times, ParallelTimes const& serialTimes)
+{
+	csv.WriteRow(Stringf("%d,%d,%d,%.3f,%.2f,%.3f,%.2f,%.6e", numThreads, numElements, GRAIN_SIZE,
+		times.m_forSeconds * 1000.0, serialTimes.m_forSeconds / times.m_forSeconds,
+		times.m_reduceSeconds * 1000.0, serialTimes.m_reduceSeconds / times.m_reduceSeconds, times.m_checksum));
+}
+
+void RunParallelSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	int numElements = (options.m_count > 0) ? options.m_count : DEFAULT_NUM_ELEMENTS;
+	std::vector<float> inputs(numElements);
+	std::vector<float> outputs(numElements, 0.f);
+	for (int index = 0; index < numElements; ++index)
+	{
+		inputs[index] = (float)(index % 1000) * 0.01f;
+	}
+
+	csv.WriteRow("threads,elements,grain,for_ms,for_speedup,reduce_ms,reduce_speedup,checksum");
+	JobSystem callerOnly;
+	ParallelTimes serialTimes = TimeParallelLoops(callerOnly, inputs, outputs);
+	WriteParallelRow(csv, 0, numElements, serialTimes, serialTimes);
+
+	//threads= picks one worker count, otherwise sweep them all
+	int numThreadCounts = sizeof(s_threadCounts) / sizeof(s_threadCounts[0]);
+	for (int countIndex = 0; countIndex < numThreadCounts; ++countIndex)
+	{
+		int numThreads = s_threadCounts[countIndex];
+		if (options.m_threads > 0)
+		{
+			if (countIndex > 0)
+			{
+				break;
+			}
+			numThreads = options.m_threads;
+		}
+		JobSystem jobSystem;
+		jobSystem.CreateWorkerThreads(numThreads);
+		ParallelTimes times = TimeParallelLoops(jobSystem, inputs, outputs);
+		jobSystem.ShutDown();
+		WriteParallelRow(csv, numThreads, numElements, times, serialTimes);
+	}
+}
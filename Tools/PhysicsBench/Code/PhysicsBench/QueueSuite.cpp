@@ -0,0 +1,153 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "Engine/Core/MPMCRingQueue.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/SynchronizedNonblockingQueue.hpp"
+#include "Engine/Core/Time.hpp"
+#include <thread>
+#include <vector>
+
+static constexpr int DEFAULT_NUM_ITEMS = 2000000;
+static constexpr size_t MPMC_CAPACITY = 1024;
+static constexpr size_t POP_BATCH_SIZE = 32;
+static int const s_threadCounts[] = { 1, 2, 4 };		//producers, with as many consumers
+
+//Items are 1..numItems, both queues hand out 0 when empty
+typedef unsigned long long QueueItem;
+
+struct QueueResult
+{
+	double m_seconds = 0.0;
+	bool m_isChecksumCorrect = false;
+};
+
+//Every consumer keeps popping until all items are taken, the sum of what they took must match what was pushed
+template<typename PUSH_FUNC, typename POP_FUNC>
+static QueueResult RunContention(int numProducers, int numConsumers, int numItems, PUSH_FUNC const& push, POP_FUNC const& popSome)
+{
+	std::atomic<int> numItemsTaken(0);
+	std::atomic<QueueItem> totalTaken(0);
+	std::atomic<bool> isStarted(false);
+	std::vector<std::thread> threads;
+	int itemsPerProducer = numItems / numProducers;
+	for (int producerIndex = 0; producerIndex < numProducers; ++producerIndex)
+	{
+		threads.emplace_back([&, producerIndex]()
+		{
+			while (!isStarted.load())
+			{
+				std::this_thread::yield();
+			}
+			QueueItem firstItem = (QueueItem)producerIndex * itemsPerProducer + 1;
+			for (QueueItem item = firstItem; item < firstItem + itemsPerProducer; ++item)
+			{
+				push(item);
+			}
+		});
+	}
+	for (int consumerIndex = 0; consumerIndex < numConsumers; ++consumerIndex)
+	{
+		threads.emplace_back([&]()
+		{
+			while (!isStarted.load())
+			{
+				std::this_thread::yield();
+			}
+			QueueItem sum = 0;
+			while (numItemsTaken.load(std::memory_order_relaxed) < numItems)
+			{
+				int numTaken = popSome(sum);
+				if (numTaken == 0)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				numItemsTaken.fetch_add(numTaken, std::memory_order_relaxed);
+			}
+			totalTaken.fetch_add(sum);
+		});
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	isStarted.store(true);
+	for (int threadIndex = 0; threadIndex < (int)threads.size(); ++threadIndex)
+	{
+		threads[threadIndex].join();
+	}
+	QueueResult result;
+	result.m_seconds = GetCurrentTimeSeconds() - startTime;
+	result.m_isChecksumCorrect = totalTaken.load() == (QueueItem)numItems * (QueueItem)(numItems + 1) / 2;
+	return result;
+}
+
+static void WriteQueueRow(CSVWriter& csv, char const* queueName, int numProducers, int numItems, QueueResult const& result)
+{
+	csv.WriteRow(Stringf("%s,%d,%d,%d,%.4f,%.0f,%d", queueName, numProducers, numProducers, numItems, result.m_seconds,
+		(double)numItems / result.m_seconds, result.m_isChecksumCorrect ? 1 : 0));
+}
+
+void RunQueueSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	csv.WriteRow("queue,producers,consumers,items,seconds,items_per_second,checksum_ok");
+	int numThreadCounts = sizeof(s_threadCounts) / sizeof(s_threadCounts[0]);
+	for (int countIndex = 0; countIndex < numThreadCounts; ++countIndex)
+	{
+		int numProducers = s_threadCounts[countIndex];
+		if (options.m_threads > 0)
+		{
+			if (countIndex > 0)
+			{
+				break;
+			}
+			numProducers = options.m_threads;
+		}
+		int numItems = (options.m_count > 0) ? options.m_count : DEFAULT_NUM_ITEMS;
+		numItems -= numItems % numProducers;
+
+		SynchronizedNonblockingQueue<QueueItem>* lockedQueue = new SynchronizedNonblockingQueue<QueueItem>();
+		QueueResult lockedResult = RunContention(numProducers, numProducers, numItems,
+			[lockedQueue](QueueItem item) { lockedQueue->push(item); },
+			[lockedQueue](QueueItem& sum)
+			{
+				QueueItem item = lockedQueue->pop();
+				sum += item;
+				return (item != 0) ? 1 : 0;
+			});
+		delete lockedQueue;
+		WriteQueueRow(csv, "synchronized_nonblocking", numProducers, numItems, lockedResult);
+
+		MPMCRingQueue<QueueItem, MPMC_CAPACITY>* ringQueue = new MPMCRingQueue<QueueItem, MPMC_CAPACITY>();
+		auto pushToRing = [ringQueue](QueueItem item)
+		{
+			while (!ringQueue->try_push(item))
+			{
+				std::this_thread::yield();
+			}
+		};
+		QueueResult ringResult = RunContention(numProducers, numProducers, numItems, pushToRing,
+			[ringQueue](QueueItem& sum)
+			{
+				QueueItem item = 0;
+				if (!ringQueue->try_pop(item))
+				{
+					return 0;
+				}
+				sum += item;
+				return 1;
+			});
+		WriteQueueRow(csv, "mpmc_ring", numProducers, numItems, ringResult);
+
+		QueueResult batchResult = RunContention(numProducers, numProducers, numItems, pushToRing,
+			[ringQueue](QueueItem& sum)
+			{
+				QueueItem items[POP_BATCH_SIZE];
+				size_t numTaken = ringQueue->pop_n(items, POP_BATCH_SIZE);
+				for (size_t itemIndex = 0; itemIndex < numTaken; ++itemIndex)
+				{
+					sum += items[itemIndex];
+				}
+				return (int)numTaken;
+			});
+		delete ringQueue;
+		WriteQueueRow(csv, "mpmc_ring_pop_n", numProducers, numItems, batchResult);
+	}
+}
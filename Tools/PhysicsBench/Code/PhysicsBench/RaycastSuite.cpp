@@ -0,0 +1,150 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "PhysicsBench/BenchScenes.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/Physics/Collider2D.hpp"
+#include "Engine/Physics/Physics2D.hpp"
+#include <cmath>
+#include <vector>
+
+static constexpr int DEFAULT_NUM_RAYS = 100000;
+static constexpr int NUM_COLLIDER_LOOP_RAYS = 2000;
+static constexpr float RAY_LENGTH = 50.f;
+
+//What game code had to do before the queries existed: test every collider for every ray and keep the closest
+static void RaycastAllColliders(Physics2D const& physics, Raycast2D const& ray, RaycastHit2D& outHit)
+{
+	outHit = RaycastHit2D();
+	Vec2 direction = ray.m_direction.GetNormalized();
+	float closestDistance = ray.m_maxDistance;
+	for (Collider2D* collider : physics.m_colliders)
+	{
+		float distance = 0.f;
+		Vec2 normal;
+		if (collider->m_isTrigger || !collider->CastDisc(ray.m_start, 0.f, direction, closestDistance, distance, normal))
+		{
+			continue;
+		}
+		closestDistance = distance;
+		outHit.m_collider = collider;
+		outHit.m_distance = distance;
+		outHit.m_normal = normal;
+	}
+}
+
+//Starts scattered over the mixed_field pile and a little above it, pointing every which way
+static std::vector<Raycast2D> MakeRays(int numRays)
+{
+	RandomNumberGenerator rng;
+	rng.Reset(5);
+	std::vector<Raycast2D> rays(numRays);
+	for (Raycast2D& ray : rays)
+	{
+		ray.m_start = Vec2(rng.RollRandomFloatInRange(-155.f, 155.f), rng.RollRandomFloatInRange(0.f, 90.f));
+		ray.m_direction = Vec2(rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f));
+		ray.m_maxDistance = RAY_LENGTH;
+	}
+	return rays;
+}
+
+static int CountHits(std::vector<RaycastHit2D> const& hits, int numRays)
+{
+	int numHits = 0;
+	for (int rayIndex = 0; rayIndex < numRays; ++rayIndex)
+	{
+		numHits += (hits[rayIndex].m_collider != nullptr) ? 1 : 0;
+	}
+	return numHits;
+}
+
+//Two colliders the same distance along a ray can come back in either order, only a different distance is a mismatch
+static int CountMismatches(std::vector<RaycastHit2D> const& hits, std::vector<RaycastHit2D> const& referenceHits, int numRays)
+{
+	int numMismatches = 0;
+	for (int rayIndex = 0; rayIndex < numRays; ++rayIndex)
+	{
+		RaycastHit2D const& hit = hits[rayIndex];
+		RaycastHit2D const& referenceHit = referenceHits[rayIndex];
+		bool isSameHit = (hit.m_collider == referenceHit.m_collider) ||
+			(hit.m_collider != nullptr && referenceHit.m_collider != nullptr && fabsf(hit.m_distance - referenceHit.m_distance) < 1e-4f);
+		numMismatches += isSameHit ? 0 : 1;
+	}
+	return numMismatches;
+}
+
+static void WriteRaycastRow(CSVWriter& csv, char const* method, char const* broadphase, int numThreads, int numRays, double seconds,
+	int numHits, int numMismatches)
+{
+	csv.WriteRow(Stringf("%s,%s,%d,%d,%.3f,%.3f,%d,%d", method, broadphase, numThreads, numRays, seconds * 1000.0,
+		(double)numRays / seconds / 1000000.0, numHits, numMismatches));
+}
+
+static void RunRaycastScene(BenchOptions const& options, CSVWriter& csv, eBroadphaseType broadphaseType, char const* broadphaseName,
+	std::vector<Raycast2D> const& rays)
+{
+	int numRays = (int)rays.size();
+	std::vector<RaycastHit2D> hits(numRays);
+	std::vector<RaycastHit2D> referenceHits(numRays);
+
+	Physics2D physics(broadphaseType, nullptr);
+	physics.SetSceneGravity(Vec2(0.f, -9.8f));
+	BuildMixedFieldScene(physics);
+	physics.Step();
+
+	//single queries first, they are also the reference every other row is checked against
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < numRays; ++rayIndex)
+	{
+		physics.Raycast(rays[rayIndex].m_start, rays[rayIndex].m_direction, rays[rayIndex].m_maxDistance, referenceHits[rayIndex]);
+	}
+	double seconds = GetCurrentTimeSeconds() - startSeconds;
+	int numReferenceHits = CountHits(referenceHits, numRays);
+	WriteRaycastRow(csv, "raycast", broadphaseName, 0, numRays, seconds, numReferenceHits, 0);
+
+	startSeconds = GetCurrentTimeSeconds();
+	physics.RaycastBatch(rays.data(), numRays, hits.data());
+	seconds = GetCurrentTimeSeconds() - startSeconds;
+	WriteRaycastRow(csv, "raycast_batch", broadphaseName, 0, numRays, seconds, CountHits(hits, numRays),
+		CountMismatches(hits, referenceHits, numRays));
+
+	int const threadCounts[] = { 1, 2, 4 };
+	for (int numThreads : threadCounts)
+	{
+		if (options.m_threads > 0 && numThreads != options.m_threads)
+		{
+			continue;
+		}
+		JobSystem jobSystem;
+		jobSystem.CreateWorkerThreads(numThreads);
+		physics.SetJobSystem(&jobSystem);
+		startSeconds = GetCurrentTimeSeconds();
+		physics.RaycastBatch(rays.data(), numRays, hits.data());
+		seconds = GetCurrentTimeSeconds() - startSeconds;
+		physics.SetJobSystem(nullptr);
+		jobSystem.ShutDown();
+		WriteRaycastRow(csv, "raycast_batch", broadphaseName, numThreads, numRays, seconds, CountHits(hits, numRays),
+			CountMismatches(hits, referenceHits, numRays));
+	}
+
+	//every collider for every ray is too slow for the full set, so only the first rays
+	int numLoopRays = (numRays < NUM_COLLIDER_LOOP_RAYS) ? numRays : NUM_COLLIDER_LOOP_RAYS;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < numLoopRays; ++rayIndex)
+	{
+		RaycastAllColliders(physics, rays[rayIndex], hits[rayIndex]);
+	}
+	seconds = GetCurrentTimeSeconds() - startSeconds;
+	WriteRaycastRow(csv, "collider_loop", broadphaseName, 0, numLoopRays, seconds, CountHits(hits, numLoopRays),
+		CountMismatches(hits, referenceHits, numLoopRays));
+}
+
+void RunRaycastSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	int numRays = (options.m_count > 0) ? options.m_count : DEFAULT_NUM_RAYS;
+	std::vector<Raycast2D> rays = MakeRays(numRays);
+	csv.WriteRow("method,broadphase,threads,rays,ms,mrays_per_s,hits,mismatches");
+	RunRaycastScene(options, csv, BROADPHASE_AABB_TREE, "aabb_tree", rays);
+	RunRaycastScene(options, csv, BROADPHASE_SWEEP_AND_PRUNE, "sweep_and_prune", rays);
+}
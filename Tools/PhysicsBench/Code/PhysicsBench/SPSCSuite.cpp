@@ -0,0 +1,104 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "Engine/Core/MPMCRingQueue.hpp"
+#include "Engine/Core/SPSCRing.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/SynchronizedNonblockingQueue.hpp"
+#include "Engine/Core/Time.hpp"
+#include <thread>
+
+static constexpr int DEFAULT_NUM_MESSAGES = 100000000;
+static constexpr size_t RING_CAPACITY = 1024;
+static constexpr size_t POP_BATCH_SIZE = 64;
+
+//Messages are 1..numMessages, 0 means the queue was empty
+typedef unsigned long long ChannelMessage;
+
+struct ChannelResult
+{
+	double m_seconds = 0.0;
+	bool m_isInOrder = true;
+};
+
+//A producer thread pushes every message once, the calling thread is the consumer and checks they arrive in order
+template<typename PUSH_FUNC, typename POP_FUNC>
+static ChannelResult RunChannel(int numMessages, PUSH_FUNC const& push, POP_FUNC const& popSome)
+{
+	ChannelResult result;
+	double startTime = GetCurrentTimeSeconds();
+	std::thread producer([&]()
+	{
+		for (ChannelMessage message = 1; message <= (ChannelMessage)numMessages; ++message)
+		{
+			push(message);
+		}
+	});
+	ChannelMessage nextMessage = 1;
+	ChannelMessage messages[POP_BATCH_SIZE];
+	while (nextMessage <= (ChannelMessage)numMessages)
+	{
+		size_t numPopped = popSome(messages);
+		if (numPopped == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		for (size_t messageIndex = 0; messageIndex < numPopped; ++messageIndex)
+		{
+			result.m_isInOrder &= (messages[messageIndex] == nextMessage);
+			++nextMessage;
+		}
+	}
+	producer.join();
+	result.m_seconds = GetCurrentTimeSeconds() - startTime;
+	return result;
+}
+
+//Full rings make the producer yield, so on a single core the consumer gets to run
+template<typename QUEUE>
+static void PushUntilAccepted(QUEUE& queue, ChannelMessage message)
+{
+	while (!queue.try_push(message))
+	{
+		std::this_thread::yield();
+	}
+}
+
+static void WriteChannelRow(CSVWriter& csv, char const* channelName, int numMessages, ChannelResult const& result)
+{
+	csv.WriteRow(Stringf("%s,%d,%.4f,%.0f,%d", channelName, numMessages, result.m_seconds, (double)numMessages / result.m_seconds, result.m_isInOrder ? 1 : 0));
+}
+
+void RunSPSCSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	int numMessages = (options.m_count > 0) ? options.m_count : DEFAULT_NUM_MESSAGES;
+	csv.WriteRow("channel,messages,seconds,messages_per_second,in_order");
+
+	SPSCRing<ChannelMessage, RING_CAPACITY>* spscRing = new SPSCRing<ChannelMessage, RING_CAPACITY>();
+	ChannelResult result = RunChannel(numMessages,
+		[spscRing](ChannelMessage message) { PushUntilAccepted(*spscRing, message); },
+		[spscRing](ChannelMessage* outMessages) { return spscRing->try_pop(outMessages[0]) ? (size_t)1 : (size_t)0; });
+	WriteChannelRow(csv, "spsc_ring", numMessages, result);
+	result = RunChannel(numMessages,
+		[spscRing](ChannelMessage message) { PushUntilAccepted(*spscRing, message); },
+		[spscRing](ChannelMessage* outMessages) { return spscRing->pop_n(outMessages, POP_BATCH_SIZE); });
+	WriteChannelRow(csv, "spsc_ring_pop_n", numMessages, result);
+	delete spscRing;
+
+	MPMCRingQueue<ChannelMessage, RING_CAPACITY>* mpmcRing = new MPMCRingQueue<ChannelMessage, RING_CAPACITY>();
+	result = RunChannel(numMessages,
+		[mpmcRing](ChannelMessage message) { PushUntilAccepted(*mpmcRing, message); },
+		[mpmcRing](ChannelMessage* outMessages) { return mpmcRing->pop_n(outMessages, POP_BATCH_SIZE); });
+	WriteChannelRow(csv, "mpmc_ring_pop_n", numMessages, result);
+	delete mpmcRing;
+
+	SynchronizedNonblockingQueue<ChannelMessage>* lockedQueue = new SynchronizedNonblockingQueue<ChannelMessage>();
+	result = RunChannel(numMessages,
+		[lockedQueue](ChannelMessage message) { lockedQueue->push(message); },
+		[lockedQueue](ChannelMessage* outMessages)
+		{
+			outMessages[0] = lockedQueue->pop();
+			return (outMessages[0] != 0) ? (size_t)1 : (size_t)0;
+		});
+	WriteChannelRow(csv, "synchronized_nonblocking", numMessages, result);
+	delete lockedQueue;
+}
@@ -0,0 +1,42 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "PhysicsBench/BenchScenes.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Physics/Physics2D.hpp"
+
+void RunSceneSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	JobSystem* jobSystem = nullptr;
+	if (options.m_threads > 0)
+	{
+		jobSystem = new JobSystem();
+		jobSystem->CreateWorkerThreads(options.m_threads);
+	}
+
+	csv.WriteRow("scene,bodies,threads,frames," + PhysicsStats2D::GetCSVHeader());
+	for (int sceneIndex = 0; sceneIndex < g_numBenchScenes; ++sceneIndex)
+	{
+		BenchScene const& scene = g_benchScenes[sceneIndex];
+		if (!options.m_scene.empty() && options.m_scene != scene.m_name)
+		{
+			continue;
+		}
+		Physics2D physics(BROADPHASE_AABB_TREE, jobSystem);
+		physics.SetSceneGravity(Vec2(0.f, -9.8f));
+		int numBodies = scene.m_build(physics);
+		//one step outside the measurement, so the first growth of the per-step buffers is not counted
+		physics.Step();
+		physics.ResetStats();
+		for (int frameIndex = 0; frameIndex < options.m_frames; ++frameIndex)
+		{
+			physics.Step();
+		}
+		csv.WriteRow(Stringf("%s,%d,%d,%d,", scene.m_name, numBodies, options.m_threads, options.m_frames) + physics.GetStats().GetCSVRow());
+	}
+
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ShutDown();
+		delete jobSystem;
+	}
+}
@@ -0,0 +1,132 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "PhysicsBench/BaselineJobSystem.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <chrono>
+
+static constexpr int DEFAULT_NUM_JOBS = 1000000;
+static constexpr int JOBS_PER_CLAIM = 1024;		//completed jobs are claimed as they would be once per frame
+static constexpr int NUM_WAKE_SAMPLES = 200;
+
+struct WakeLatency
+{
+	double m_averageSeconds = 0.0;
+	double m_maxSeconds = 0.0;
+};
+
+class CountingBaselineJob : public BaselineJob
+{
+public:
+	explicit CountingBaselineJob(std::atomic<int>* counter) : m_counter(counter) {}
+	virtual void Execute() override { m_counter->fetch_add(1, std::memory_order_relaxed); }
+
+	std::atomic<int>* m_counter = nullptr;
+};
+
+class TimingBaselineJob : public BaselineJob
+{
+public:
+	explicit TimingBaselineJob(std::atomic<double>* startTime) : m_startTime(startTime) {}
+	virtual void Execute() override { m_startTime->store(GetCurrentTimeSeconds()); }
+
+	std::atomic<double>* m_startTime = nullptr;
+};
+
+static void WaitForCount(std::atomic<int> const& counter, int count)
+{
+	while (counter.load() < count)
+	{
+		std::this_thread::yield();
+	}
+}
+
+//Every sample posts one job to idle workers and measures how long it takes to start
+template<typename POST_FUNC>
+static WakeLatency MeasureWakeLatency(POST_FUNC const& postTimingJob)
+{
+	WakeLatency latency;
+	for (int sampleIndex = 0; sampleIndex < NUM_WAKE_SAMPLES; ++sampleIndex)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		std::atomic<double> startTime(0.0);
+		double postTime = GetCurrentTimeSeconds();
+		postTimingJob(&startTime);
+		while (startTime.load() == 0.0)
+		{
+			std::this_thread::yield();
+		}
+		double seconds = startTime.load() - postTime;
+		latency.m_averageSeconds += seconds / (double)NUM_WAKE_SAMPLES;
+		latency.m_maxSeconds = std::max(latency.m_maxSeconds, seconds);
+	}
+	return latency;
+}
+
+static void WriteSchedulerRow(CSVWriter& csv, char const* scheduler, int numThreads, int numJobs, double seconds, WakeLatency const& latency)
+{
+	csv.WriteRow(Stringf("%s,%d,%d,%.4f,%.0f,%d,%.1f,%.1f", scheduler, numThreads, numJobs, seconds, (double)numJobs / seconds,
+		NUM_WAKE_SAMPLES, latency.m_averageSeconds * 1000000.0, latency.m_maxSeconds * 1000000.0));
+}
+
+static void RunBaselineScheduler(CSVWriter& csv, int numThreads, int numJobs)
+{
+	BaselineJobSystem jobSystem;
+	jobSystem.CreateWorkerThreads(numThreads);
+	std::atomic<int> numJobsRun(0);
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		jobSystem.PostJob(new CountingBaselineJob(&numJobsRun));
+		if ((jobIndex % JOBS_PER_CLAIM) == 0)
+		{
+			jobSystem.ClaimAndDeleteAllCompletedJobs();
+		}
+	}
+	WaitForCount(numJobsRun, numJobs);
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	double seconds = GetCurrentTimeSeconds() - startTime;
+
+	WakeLatency latency = MeasureWakeLatency([&jobSystem](std::atomic<double>* jobStartTime)
+	{
+		jobSystem.PostJob(new TimingBaselineJob(jobStartTime));
+	});
+	jobSystem.ShutDown();
+	WriteSchedulerRow(csv, "single_queue", numThreads, numJobs, seconds, latency);
+}
+
+static void RunWorkStealingScheduler(CSVWriter& csv, int numThreads, int numJobs)
+{
+	JobSystem jobSystem;
+	jobSystem.CreateWorkerThreads(numThreads);
+	std::atomic<int> numJobsRun(0);
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		jobSystem.PostLambdaJob([&numJobsRun]() { numJobsRun.fetch_add(1, std::memory_order_relaxed); });
+		if ((jobIndex % JOBS_PER_CLAIM) == 0)
+		{
+			jobSystem.ClaimAndDeleteAllCompletedJobs();
+		}
+	}
+	WaitForCount(numJobsRun, numJobs);
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	double seconds = GetCurrentTimeSeconds() - startTime;
+
+	WakeLatency latency = MeasureWakeLatency([&jobSystem](std::atomic<double>* jobStartTime)
+	{
+		jobSystem.PostLambdaJob([jobStartTime]() { jobStartTime->store(GetCurrentTimeSeconds()); });
+	});
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	jobSystem.ShutDown();
+	WriteSchedulerRow(csv, "work_stealing", numThreads, numJobs, seconds, latency);
+}
+
+void RunSchedulerSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	int numThreads = GetBenchThreadCount(options);
+	int numJobs = (options.m_count > 0) ? options.m_count : DEFAULT_NUM_JOBS;
+	csv.WriteRow("scheduler,threads,jobs,seconds,jobs_per_second,wake_samples,wake_avg_us,wake_max_us");
+	RunBaselineScheduler(csv, numThreads, numJobs);
+	RunWorkStealingScheduler(csv, numThreads, numJobs);
+}
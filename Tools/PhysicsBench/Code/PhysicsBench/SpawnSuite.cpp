@@ -0,0 +1,138 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Physics/DiscCollider2D.hpp"
+#include "Engine/Physics/Physics2D.hpp"
+#include "Engine/Physics/PolygonCollider2D.hpp"
+#include "Engine/Physics/Rigidbody2D.hpp"
+#include <vector>
+
+static constexpr int DISCS_PER_SHELF = 10;
+static constexpr int SHELVES_PER_ROW = 100;
+static constexpr float SHELF_SPACING = 20.f;
+static constexpr int BULLET_PAIRS_PER_STEP = 8;
+static constexpr int SETTLE_STEPS = 120;
+static char const* const s_broadphaseNames[NUM_BROADPHASE_TYPES] = { "aabb_tree", "sweep_and_prune" };
+
+static Rigidbody2D* AddSpawnBody(Physics2D& physics, Vec2 const& position, Collider2D* collider, eSimulationMode mode)
+{
+	collider->m_physicsMaterial.restitution = 0.f;
+	collider->m_physicsMaterial.friction = 0.6f;
+	Rigidbody2D* rigidbody = physics.CreateRigidbody();
+	rigidbody->SetPosition(position);
+	rigidbody->TakeCollider(collider);
+	rigidbody->SetSimulationMode(mode);
+	return rigidbody;
+}
+
+static Vec2 GetShelfPosition(int shelfIndex)
+{
+	return Vec2((float)(shelfIndex % SHELVES_PER_ROW), (float)(shelfIndex / SHELVES_PER_ROW)) * SHELF_SPACING;
+}
+
+//A grid of short shelves, each with a row of discs resting on it, so every live disc has a cached contact and sleeps.
+//Polygon bounds come from the shape's bounding disc, the spacing keeps shelves out of each other's bounds.
+//Returns the number of bodies.
+static int BuildShelves(Physics2D& physics, int numDiscs)
+{
+	std::vector<Vec2> shelfPoints;
+	float const shelfHalfWidth = (float)DISCS_PER_SHELF * 0.75f;
+	shelfPoints.push_back(Vec2(-shelfHalfWidth, -0.5f));
+	shelfPoints.push_back(Vec2(shelfHalfWidth, -0.5f));
+	shelfPoints.push_back(Vec2(shelfHalfWidth, 0.5f));
+	shelfPoints.push_back(Vec2(-shelfHalfWidth, 0.5f));
+	int numShelves = (numDiscs + DISCS_PER_SHELF - 1) / DISCS_PER_SHELF;
+	for (int shelfIndex = 0; shelfIndex < numShelves; ++shelfIndex)
+	{
+		AddSpawnBody(physics, GetShelfPosition(shelfIndex), physics.CreatePolygonCollider(Vec2::ZERO, shelfPoints), STATIC);
+	}
+	for (int discIndex = 0; discIndex < numDiscs; ++discIndex)
+	{
+		Vec2 offset(((float)(discIndex % DISCS_PER_SHELF) + 0.5f) * 1.5f - shelfHalfWidth, 1.f);
+		AddSpawnBody(physics, GetShelfPosition(discIndex / DISCS_PER_SHELF) + offset, physics.CreateDiscCollider(Vec2::ZERO, 0.5f), DYNAMIC);
+	}
+	return numShelves + numDiscs;
+}
+
+//Bullets come in touching pairs off to the side of the shelves, so each one has a broadphase pair and a cached
+//contact by the time it is destroyed, without waking anything that lives on
+static void SpawnBullets(Physics2D& physics, std::vector<Rigidbody2D*>& outBullets)
+{
+	for (int pairIndex = 0; pairIndex < BULLET_PAIRS_PER_STEP; ++pairIndex)
+	{
+		Vec2 position(-3.f * SHELF_SPACING, (float)pairIndex * 4.f);
+		for (int sideIndex = 0; sideIndex < 2; ++sideIndex)
+		{
+			Rigidbody2D* bullet = AddSpawnBody(physics, position + Vec2((float)sideIndex * 0.4f, 0.f),
+				physics.CreateDiscCollider(Vec2::ZERO, 0.25f), DYNAMIC);
+			bullet->SetVelocity(Vec2(0.f, -20.f));
+			outBullets.push_back(bullet);
+		}
+	}
+}
+
+static void RunSpawnScene(BenchOptions const& options, CSVWriter& csv, eBroadphaseType broadphaseType, int numLiveDiscs)
+{
+	Physics2D physics(broadphaseType);
+	physics.SetSceneGravity(Vec2(0.f, -9.8f));
+	int numBodies = BuildShelves(physics, numLiveDiscs);
+	for (int stepIndex = 0; stepIndex < SETTLE_STEPS; ++stepIndex)
+	{
+		physics.Step();
+	}
+
+	//churn steps destroy the last bullets and spawn new ones, the quiet steps between them only step the same world,
+	//so the difference is what spawning and destroying costs even when the whole step is much slower than that
+	std::vector<Rigidbody2D*> bullets;
+	double churnSeconds = 0.0;
+	double quietSeconds = 0.0;
+	int numChurnSteps = 0;
+	int numQuietSteps = 0;
+	for (int frameIndex = 0; frameIndex < options.m_frames; ++frameIndex)
+	{
+		bool isChurnStep = (frameIndex % 2) == 0;
+		double startSeconds = GetCurrentTimeSeconds();
+		if (isChurnStep)
+		{
+			for (Rigidbody2D* bullet : bullets)
+			{
+				bullet->Destroy();
+			}
+			bullets.clear();
+			SpawnBullets(physics, bullets);
+		}
+		physics.Step();
+		double seconds = GetCurrentTimeSeconds() - startSeconds;
+		//the first churn step only spawns
+		if (frameIndex < 2)
+		{
+			continue;
+		}
+		(isChurnStep ? churnSeconds : quietSeconds) += seconds;
+		(isChurnStep ? numChurnSteps : numQuietSteps) += 1;
+	}
+
+	double churnMilliseconds = (numChurnSteps > 0) ? churnSeconds * 1000.0 / (double)numChurnSteps : 0.0;
+	double quietMilliseconds = (numQuietSteps > 0) ? quietSeconds * 1000.0 / (double)numQuietSteps : 0.0;
+	int numBulletsPerStep = BULLET_PAIRS_PER_STEP * 2;
+	csv.WriteRow(Stringf("%s,%d,%d,%d,%.4f,%.4f,%.2f", s_broadphaseNames[broadphaseType], numBodies, numBulletsPerStep, options.m_frames,
+		quietMilliseconds, churnMilliseconds, (churnMilliseconds - quietMilliseconds) * 1000.0 / (double)numBulletsPerStep));
+}
+
+void RunSpawnSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	csv.WriteRow("broadphase,bodies,bullets_per_churn_step,frames,quiet_ms,churn_ms,us_per_bullet");
+	int const liveDiscCounts[] = { 1000, 10000, 100000 };
+	for (int broadphaseIndex = 0; broadphaseIndex < NUM_BROADPHASE_TYPES; ++broadphaseIndex)
+	{
+		if (options.m_count > 0)
+		{
+			RunSpawnScene(options, csv, (eBroadphaseType)broadphaseIndex, options.m_count);
+			continue;
+		}
+		for (int numLiveDiscs : liveDiscCounts)
+		{
+			RunSpawnScene(options, csv, (eBroadphaseType)broadphaseIndex, numLiveDiscs);
+		}
+	}
+}
@@ -0,0 +1,164 @@
+#include "PhysicsBench/BenchCommon.hpp"
+#include "PhysicsBench/BaselineJobSystem.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+
+static constexpr int DEFAULT_NUM_SUBMISSIONS = 10000000;
+static constexpr int JOBS_PER_CLAIM = 1024;
+static constexpr int MAX_JOBS_IN_FLIGHT = 32768;	//posters wait above this, as a frame loop would, so the backlog stays bounded
+static constexpr int NUM_WARM_UP_JOBS = 65536;	//fills the job block free lists before anything is counted
+
+struct SubmitResult
+{
+	double m_postSeconds = 0.0;		//time spent posting, the jobs may still be running afterwards
+	size_t m_numHeapAllocations = 0;
+};
+
+class EmptyBaselineJob : public BaselineJob
+{
+public:
+	explicit EmptyBaselineJob(std::atomic<int>* counter) : m_counter(counter) {}
+	virtual void Execute() override { m_counter->fetch_add(1, std::memory_order_relaxed); }
+
+	std::atomic<int>* m_counter = nullptr;
+};
+
+static void WaitAndClaim(JobSystem& jobSystem, std::atomic<int> const& numJobsRun, int numJobs)
+{
+	while (numJobsRun.load() < numJobs)
+	{
+		jobSystem.ClaimAndDeleteAllCompletedJobs();
+		std::this_thread::yield();
+	}
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+}
+
+//Lambda jobs posted by the main thread, so every one goes through the shared queue
+static SubmitResult SubmitFromMainThread(JobSystem& jobSystem, int numJobs)
+{
+	std::atomic<int> numJobsRun(0);
+	auto tinyJob = [&numJobsRun]() { numJobsRun.fetch_add(1, std::memory_order_relaxed); };
+	SubmitResult result;
+	size_t startAllocations = GetThreadHeapAllocationCount();
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		jobSystem.PostLambdaJob(tinyJob);
+		if ((jobIndex % JOBS_PER_CLAIM) == 0)
+		{
+			jobSystem.ClaimAndDeleteAllCompletedJobs();
+			while (jobIndex - numJobsRun.load() > MAX_JOBS_IN_FLIGHT)
+			{
+				std::this_thread::yield();
+				jobSystem.ClaimAndDeleteAllCompletedJobs();
+			}
+		}
+	}
+	result.m_postSeconds = GetCurrentTimeSeconds() - startTime;
+	result.m_numHeapAllocations = GetThreadHeapAllocationCount() - startAllocations;
+	WaitAndClaim(jobSystem, numJobsRun, numJobs);
+	return result;
+}
+
+//One root job per worker posts its share from inside the system, so posts go to the worker's own deque.
+//Roots run queued jobs themselves while too many are in flight.
+static SubmitResult SubmitFromWorkers(JobSystem& jobSystem, int numThreads, int numJobs)
+{
+	std::atomic<int> numJobsRun(0);
+	std::atomic<int> numJobsPosted(0);
+	std::atomic<int> numRootsDone(0);
+	std::atomic<size_t> numHeapAllocations(0);
+	auto tinyJob = [&numJobsRun]() { numJobsRun.fetch_add(1, std::memory_order_relaxed); };
+	int jobsPerRoot = numJobs / numThreads;
+	auto rootJob = [&, jobsPerRoot]()
+	{
+		size_t startAllocations = GetThreadHeapAllocationCount();
+		for (int jobIndex = 0; jobIndex < jobsPerRoot; ++jobIndex)
+		{
+			jobSystem.PostLambdaJob(tinyJob);
+			if ((jobIndex % JOBS_PER_CLAIM) == 0)
+			{
+				int numPosted = numJobsPosted.fetch_add(JOBS_PER_CLAIM) + JOBS_PER_CLAIM;
+				while (numPosted - numJobsRun.load() > MAX_JOBS_IN_FLIGHT && jobSystem.TryExecuteOneJob())
+				{
+				}
+			}
+		}
+		numHeapAllocations.fetch_add(GetThreadHeapAllocationCount() - startAllocations);
+		numRootsDone.fetch_add(1);
+	};
+
+	SubmitResult result;
+	double startTime = GetCurrentTimeSeconds();
+	for (int rootIndex = 0; rootIndex < numThreads; ++rootIndex)
+	{
+		jobSystem.PostLambdaJob(rootJob);
+	}
+	while (numRootsDone.load() < numThreads)
+	{
+		jobSystem.ClaimAndDeleteAllCompletedJobs();
+		std::this_thread::yield();
+	}
+	result.m_postSeconds = GetCurrentTimeSeconds() - startTime;
+	result.m_numHeapAllocations = numHeapAllocations.load();
+	WaitAndClaim(jobSystem, numJobsRun, jobsPerRoot * numThreads);
+	return result;
+}
+
+static SubmitResult SubmitToBaseline(BaselineJobSystem& jobSystem, int numJobs)
+{
+	std::atomic<int> numJobsRun(0);
+	SubmitResult result;
+	size_t startAllocations = GetThreadHeapAllocationCount();
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		jobSystem.PostJob(new EmptyBaselineJob(&numJobsRun));
+		if ((jobIndex % JOBS_PER_CLAIM) == 0)
+		{
+			jobSystem.ClaimAndDeleteAllCompletedJobs();
+			while (jobIndex - numJobsRun.load() > MAX_JOBS_IN_FLIGHT)
+			{
+				std::this_thread::yield();
+				jobSystem.ClaimAndDeleteAllCompletedJobs();
+			}
+		}
+	}
+	result.m_postSeconds = GetCurrentTimeSeconds() - startTime;
+	result.m_numHeapAllocations = GetThreadHeapAllocationCount() - startAllocations;
+	while (numJobsRun.load() < numJobs)
+	{
+		std::this_thread::yield();
+	}
+	jobSystem.ClaimAndDeleteAllCompletedJobs();
+	return result;
+}
+
+static void WriteSubmitRow(CSVWriter& csv, char const* scheduler, char const* poster, int numThreads, int numJobs, SubmitResult const& result)
+{
+	csv.WriteRow(Stringf("%s,%s,%d,%d,%.4f,%.0f,%zu,%.4f", scheduler, poster, numThreads, numJobs, result.m_postSeconds,
+		(double)numJobs / result.m_postSeconds, result.m_numHeapAllocations, (double)result.m_numHeapAllocations / (double)numJobs));
+}
+
+void RunSubmitSuite(BenchOptions const& options, CSVWriter& csv)
+{
+	int numThreads = GetBenchThreadCount(options);
+	int numJobs = (options.m_count > 0) ? options.m_count : DEFAULT_NUM_SUBMISSIONS;
+	numJobs -= numJobs % numThreads;
+	csv.WriteRow("scheduler,poster,threads,submissions,post_seconds,submissions_per_second,heap_allocs,heap_allocs_per_submission");
+
+	BaselineJobSystem baseline;
+	baseline.CreateWorkerThreads(numThreads);
+	SubmitToBaseline(baseline, NUM_WARM_UP_JOBS);
+	WriteSubmitRow(csv, "single_queue", "main", numThreads, numJobs, SubmitToBaseline(baseline, numJobs));
+	baseline.ShutDown();
+
+	JobSystem jobSystem;
+	jobSystem.CreateWorkerThreads(numThreads);
+	SubmitFromMainThread(jobSystem, NUM_WARM_UP_JOBS);
+	WriteSubmitRow(csv, "work_stealing", "main", numThreads, numJobs, SubmitFromMainThread(jobSystem, numJobs));
+	SubmitFromWorkers(jobSystem, numThreads, NUM_WARM_UP_JOBS - NUM_WARM_UP_JOBS % numThreads);
+	WriteSubmitRow(csv, "work_stealing", "workers", numThreads, numJobs, SubmitFromWorkers(jobSystem, numThreads, numJobs));
+	jobSystem.ShutDown();
+}